@@ -47,6 +47,7 @@
 
 #include <fiff/fiff_info.h>
 #include <fiff/fiff_stream.h>
+#include <fiff/fiff_raw_recorder.h>
 
 #include <scShared/Interfaces/ISensor.h>
 #include <utils/generics/circularmatrixbuffer.h>
@@ -60,7 +61,6 @@
 #include <QtWidgets>
 #include <QVector>
 #include <QTimer>
-#include <QMutex>
 
 
 //*************************************************************************************************************
@@ -335,12 +335,6 @@ protected:
     */
     void showSqdCtrlDialog();
 
-    //=========================================================================================================
-    /**
-    * Determines current file. And starts a new one.
-    */
-    void splitRecordingFile();
-
     //=========================================================================================================
     /**
     * Starts or stops a file recording depending on the current recording state.
@@ -417,11 +411,10 @@ protected:
     QList<int>                              m_lTriggerChannelIndices;       /**< List of all trigger channel indices. */
 
     FIFFLIB::FiffInfo::SPtr                 m_pFiffInfo;                    /**< Fiff measurement info.*/
-    FIFFLIB::FiffStream::SPtr               m_pOutfid;                      /**< FiffStream to write to.*/
+    FIFFLIB::FiffRawRecorder::SPtr          m_pRawRecorder;                 /**< Writes the recorded data to file in its own thread.*/
 
     qint16                                  m_iBlinkStatus;                 /**< The blink status of the recording button.*/
     qint32                                  m_iBufferSize;                  /**< The raw data buffer size.*/
-    qint32                                  m_iSplitCount;                  /**< File split count */
     int                                     m_iRecordingMSeconds;           /**< Recording length in mseconds.*/
 
     bool                                    m_bWriteToFile;                 /**< Flag for for writing the received samples to a file. Defined by the user via the GUI.*/
@@ -437,8 +430,6 @@ protected:
     QString                                 m_sFiffCompensators;            /**< Fiff compensator information */
     QString                                 m_sBadChannels;                 /**< Filename which contains a list of bad channels */
 
-    QFile                                   m_qFileOut;                     /**< QFile for writing to fif file.*/
-    QMutex                                  m_mutex;                        /**< Mutex to guarantee thread safety.*/
     QTime                                   m_recordingStartedTime;         /**< The time when the recording started.*/
 
     Eigen::RowVectorXd                      m_cals;                         /**< Calibration vector.*/
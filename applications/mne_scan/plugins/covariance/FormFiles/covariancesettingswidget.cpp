@@ -42,5 +42,30 @@ CovarianceSettingsWidget::CovarianceSettingsWidget(Covariance *toolbox, QWidget
             m_pCovarianceToolbox, &Covariance::changeSamples);
     t_pGridLayout->addWidget(m_pSpinBoxNumSamples,0,1,1,1);
 //    }
+
+    //Online estimation with exponentially decaying sample weights
+    m_pCheckBoxOnline = new QCheckBox("Online estimation");
+    m_pCheckBoxOnline->setChecked(toolbox->m_bOnlineEstimation);
+    connect(m_pCheckBoxOnline, &QCheckBox::toggled,
+            m_pCovarianceToolbox, &Covariance::changeOnlineEstimation);
+    t_pGridLayout->addWidget(m_pCheckBoxOnline,1,0,1,2);
+
+    QLabel* t_pLabelForgettingFactor = new QLabel;
+    t_pLabelForgettingFactor->setText("Forgetting Factor");
+    t_pGridLayout->addWidget(t_pLabelForgettingFactor,2,0,1,1);
+
+    m_pDoubleSpinBoxForgettingFactor = new QDoubleSpinBox;
+    m_pDoubleSpinBoxForgettingFactor->setDecimals(5);
+    m_pDoubleSpinBoxForgettingFactor->setMinimum(0.9);
+    m_pDoubleSpinBoxForgettingFactor->setMaximum(1.0);
+    m_pDoubleSpinBoxForgettingFactor->setSingleStep(0.0001);
+    m_pDoubleSpinBoxForgettingFactor->setValue(toolbox->m_dForgettingFactor);
+    m_pDoubleSpinBoxForgettingFactor->setEnabled(toolbox->m_bOnlineEstimation);
+    connect(m_pDoubleSpinBoxForgettingFactor, static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged),
+            m_pCovarianceToolbox, &Covariance::changeForgettingFactor);
+    connect(m_pCheckBoxOnline, &QCheckBox::toggled,
+            m_pDoubleSpinBoxForgettingFactor, &QDoubleSpinBox::setEnabled);
+    t_pGridLayout->addWidget(m_pDoubleSpinBoxForgettingFactor,2,1,1,1);
+
     this->setLayout(t_pGridLayout);
 }
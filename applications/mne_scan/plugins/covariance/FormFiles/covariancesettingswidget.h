@@ -55,6 +55,8 @@ public slots:
 private:
     Covariance* m_pCovarianceToolbox;
     QSpinBox* m_pSpinBoxNumSamples;
+    QCheckBox* m_pCheckBoxOnline;
+    QDoubleSpinBox* m_pDoubleSpinBoxForgettingFactor;
 };
 
 } // NAMESPACE
@@ -93,6 +93,9 @@ Covariance::Covariance()
 , m_pCovarianceInput(NULL)
 , m_pCovarianceOutput(NULL)
 , m_iEstimationSamples(5000)
+, m_bOnlineEstimation(false)
+, m_dForgettingFactor(1.0)
+, m_bUpdateOnlineSettings(false)
 {
     m_pActionShowAdjustment = new QAction(QIcon(":/images/covadjustments.png"), tr("Covariance Adjustments"),this);
 //    m_pActionSetupProject->setShortcut(tr("F12"));
@@ -133,6 +136,8 @@ void Covariance::init()
     //
     QSettings settings;
     m_iEstimationSamples = settings.value(QString("Plugin/%1/estimationSamples").arg(this->getName()), 5000).toInt();
+    m_bOnlineEstimation = settings.value(QString("Plugin/%1/onlineEstimation").arg(this->getName()), false).toBool();
+    m_dForgettingFactor = settings.value(QString("Plugin/%1/forgettingFactor").arg(this->getName()), 1.0).toDouble();
 
     // Input
     m_pCovarianceInput = PluginInputData<RealTimeMultiSampleArray>::create(this, "CovarianceIn", "Covariance input data");
@@ -154,6 +159,8 @@ void Covariance::unload()
     //
     QSettings settings;
     settings.setValue(QString("Plugin/%1/estimationSamples").arg(this->getName()), m_iEstimationSamples);
+    settings.setValue(QString("Plugin/%1/onlineEstimation").arg(this->getName()), m_bOnlineEstimation);
+    settings.setValue(QString("Plugin/%1/forgettingFactor").arg(this->getName()), m_dForgettingFactor);
 }
 
 
@@ -237,7 +244,18 @@ void Covariance::update(SCMEASLIB::Measurement::SPtr pMeasurement)
             m_pRtCov = RtCov::SPtr(new RtCov(m_iEstimationSamples, m_pFiffInfo));
             connect(m_pRtCov.data(), &RtCov::covCalculated,
                     this, &Covariance::appendCovariance);
+
+            m_bUpdateOnlineSettings = true;
+        }
+
+        //Pass changed online settings in the thread which appends the data, since they reset the accumulated sums
+        mutex.lock();
+        if(m_bUpdateOnlineSettings) {
+            m_pRtCov->setForgettingFactor(m_dForgettingFactor);
+            m_pRtCov->setOnlineEstimation(m_bOnlineEstimation);
+            m_bUpdateOnlineSettings = false;
         }
+        mutex.unlock();
 
 
         if(m_bProcessData)
@@ -274,6 +292,26 @@ void Covariance::changeSamples(qint32 samples)
 }
 
 
+//*************************************************************************************************************
+
+void Covariance::changeOnlineEstimation(bool bOnline)
+{
+    QMutexLocker locker(&mutex);
+    m_bOnlineEstimation = bOnline;
+    m_bUpdateOnlineSettings = true;
+}
+
+
+//*************************************************************************************************************
+
+void Covariance::changeForgettingFactor(double dForgettingFactor)
+{
+    QMutexLocker locker(&mutex);
+    m_dForgettingFactor = dForgettingFactor;
+    m_bUpdateOnlineSettings = true;
+}
+
+
 //*************************************************************************************************************
 
 void Covariance::run()
@@ -160,6 +160,10 @@ public:
 
     void changeSamples(qint32 samples);
 
+    void changeOnlineEstimation(bool bOnline);
+
+    void changeForgettingFactor(double dForgettingFactor);
+
 protected:
     virtual void run();
 
@@ -170,6 +174,9 @@ private:
     bool        m_bProcessData;                     /**< If data should be received for processing */
 
     qint32      m_iEstimationSamples;
+    bool        m_bOnlineEstimation;                /**< If the covariance is estimated from exponentially weighted running sums */
+    double      m_dForgettingFactor;                /**< Per sample forgetting factor of the online estimation */
+    bool        m_bUpdateOnlineSettings;            /**< If the online settings need to be passed to the RtCov, guarded by mutex */
 
     QVector<FIFFLIB::FiffCov>   m_qVecCovData;      /**< Covariance data set */
 
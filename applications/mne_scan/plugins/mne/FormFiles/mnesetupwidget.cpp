@@ -65,6 +65,8 @@
 
 using namespace MNEPLUGIN;
 using namespace MNELIB;
+using namespace FSLIB;
+using namespace Eigen;
 
 
 //*************************************************************************************************************
@@ -92,11 +94,15 @@ MNESetupWidget::MNESetupWidget(MNE* toolbox, QWidget *parent)
     else
         ui.m_qLabel_surfaceStat->setText("loaded");
 
+    ui.m_qCheckBox_SinglePrecision->setChecked(m_pMNE->m_bSinglePrecision);
+
     connect(ui.m_qPushButton_About, &QPushButton::released, this, &MNESetupWidget::showAboutDialog);
     connect(ui.m_qPushButton_FwdFileDialog, &QPushButton::released, this, &MNESetupWidget::showFwdFileDialog);
     connect(ui.m_qPushButton_AtlasDirDialog, &QPushButton::released, this, &MNESetupWidget::showAtlasDirDialog);
     connect(ui.m_qPushButton_SurfaceDirDialog, &QPushButton::released, this, &MNESetupWidget::showSurfaceDirDialog);
     connect(ui.m_qPushButonStartClustering, &QPushButton::released, this, &MNESetupWidget::clusteringTriggered);
+    connect(ui.m_qCheckBox_SinglePrecision, &QCheckBox::toggled, this, &MNESetupWidget::onSinglePrecisionChanged);
+    connect(ui.m_qLineEdit_Labels, &QLineEdit::editingFinished, this, &MNESetupWidget::onLabelsChanged);
 }
 
 
@@ -223,3 +229,44 @@ void MNESetupWidget::showSurfaceDirDialog()
         ui.m_qLabel_surfaceStat->setText("not loaded");
     }
 }
+
+
+//*************************************************************************************************************
+
+void MNESetupWidget::onSinglePrecisionChanged(bool bChecked)
+{
+    m_pMNE->setSinglePrecision(bChecked);
+}
+
+
+//*************************************************************************************************************
+
+void MNESetupWidget::onLabelsChanged()
+{
+    QStringList t_qListNames;
+    foreach(const QString &sName, ui.m_qLineEdit_Labels->text().split(",", QString::SkipEmptyParts))
+        t_qListNames << sName.trimmed();
+
+    QList<Label> t_qListSelectedLabels;
+
+    if(!t_qListNames.isEmpty())
+    {
+        QList<Label> t_qListLabels;
+        QList<RowVector4i> t_qListLabelRGBAs;
+
+        if(m_pMNE->m_pAnnotationSet->isEmpty() || m_pMNE->m_pSurfaceSet->isEmpty()
+           || !m_pMNE->m_pAnnotationSet->toLabels(*m_pMNE->m_pSurfaceSet, t_qListLabels, t_qListLabelRGBAs))
+        {
+            qWarning() << "MNESetupWidget::onLabelsChanged - Brain atlas or surfaces not loaded, estimating all sources.";
+        }
+
+        for(qint32 i = 0; i < t_qListLabels.size(); ++i)
+            if(t_qListNames.contains(t_qListLabels[i].name))
+                t_qListSelectedLabels << t_qListLabels[i];
+
+        if(t_qListSelectedLabels.size() != t_qListNames.size())
+            qWarning() << "MNESetupWidget::onLabelsChanged - Selected" << t_qListSelectedLabels.size() << "of" << t_qListNames.size() << "labels.";
+    }
+
+    m_pMNE->setSourceSelection(t_qListSelectedLabels);
+}
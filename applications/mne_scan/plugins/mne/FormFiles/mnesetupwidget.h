@@ -149,6 +149,20 @@ private:
     */
     void showSurfaceDirDialog();
 
+    //=========================================================================================================
+    /**
+    * Switches the source estimation between the single and the double precision kernel
+    *
+    * @param[in] bChecked   Whether to use the single precision kernel
+    */
+    void onSinglePrecisionChanged(bool bChecked);
+
+    //=========================================================================================================
+    /**
+    * Restricts the source estimation to the labels of the brain atlas entered in the label line edit
+    */
+    void onLabelsChanged();
+
 
     MNE* m_pMNE;            /**< Holds a pointer to corresponding DummyToolbox.*/
 
@@ -55,6 +55,7 @@
 #include <inverse/minimumNorm/minimumnorm.h>
 
 #include <rtprocessing/rtinvop.h>
+#include <rtprocessing/rtresample.h>
 
 #include <scMeas/realtimesourceestimate.h>
 #include <scMeas/realtimemultisamplearray.h>
@@ -70,6 +71,7 @@
 #include <QtCore/QtPlugin>
 #include <QtConcurrent>
 #include <QDebug>
+#include <QSettings>
 
 
 //*************************************************************************************************************
@@ -97,6 +99,7 @@ MNE::MNE()
 , m_bReceiveData(false)
 , m_bProcessData(false)
 , m_bFinishedClustering(false)
+, m_bSinglePrecision(false)
 , m_qFileFwdSolution(QCoreApplication::applicationDirPath() + "/MNE-sample-data/MEG/sample/sample_audvis-meg-eeg-oct-6-fwd.fif")
 , m_sAtlasDir(QCoreApplication::applicationDirPath() + "/MNE-sample-data/subjects/sample/label")
 , m_sSurfaceDir(QCoreApplication::applicationDirPath() + "/MNE-sample-data/subjects/sample/surf")
@@ -134,6 +137,10 @@ QSharedPointer<IPlugin> MNE::clone() const
 
 void MNE::init()
 {
+    // Load Settings
+    QSettings settings;
+    m_bSinglePrecision = settings.value(QString("Plugin/%1/SinglePrecision").arg(this->getName()), false).toBool();
+
     // Inits
     m_pFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(m_qFileFwdSolution));
     m_pAnnotationSet = AnnotationSet::SPtr(new AnnotationSet(m_sAtlasDir+"/lh.aparc.a2009s.annot", m_sAtlasDir+"/rh.aparc.a2009s.annot"));
@@ -184,7 +191,9 @@ void MNE::init()
 
 void MNE::unload()
 {
-
+    // Store Settings
+    QSettings settings;
+    settings.setValue(QString("Plugin/%1/SinglePrecision").arg(this->getName()), m_bSinglePrecision);
 }
 
 
@@ -502,6 +511,9 @@ void MNE::updateInvOp(const MNEInverseOperator& invOp)
     double lambda2 = 1.0 / pow(snr, 2); //ToDo estimate lambda using covariance
 
     m_pMinimumNorm = MinimumNorm::SPtr(new MinimumNorm(m_invOp, lambda2, m_sMethod));
+    m_pMinimumNorm->setSinglePrecision(m_bSinglePrecision);
+    if(!m_qListSelectedLabels.isEmpty())
+        m_pMinimumNorm->setSourceSelection(m_qListSelectedLabels);
 
     //Set up the inverse according to the parameters
     // Use 1 nave here because in case of evoked data as input the minimum norm will always be updated when the source estimate is calculated (see run method).
@@ -509,6 +521,36 @@ void MNE::updateInvOp(const MNEInverseOperator& invOp)
 }
 
 
+//*************************************************************************************************************
+
+void MNE::setSourceSelection(const QList<FSLIB::Label>& qListLabels)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_qListSelectedLabels = qListLabels;
+
+    if(m_pMinimumNorm) {
+        if(m_qListSelectedLabels.isEmpty())
+            m_pMinimumNorm->setSourceSelection(VectorXi());
+        else
+            m_pMinimumNorm->setSourceSelection(m_qListSelectedLabels);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MNE::setSinglePrecision(bool bSinglePrecision)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_bSinglePrecision = bSinglePrecision;
+
+    if(m_pMinimumNorm)
+        m_pMinimumNorm->setSinglePrecision(m_bSinglePrecision);
+}
+
+
 //*************************************************************************************************************
 
 void MNE::onMethodChanged(const QString& method)
@@ -519,6 +561,9 @@ void MNE::onMethodChanged(const QString& method)
         double snr = 3.0;
         double lambda2 = 1.0 / pow(snr, 2); //ToDo estimate lambda using covariance
         m_pMinimumNorm = MinimumNorm::SPtr(new MinimumNorm(m_invOp, lambda2, m_sMethod));
+        m_pMinimumNorm->setSinglePrecision(m_bSinglePrecision);
+        if(!m_qListSelectedLabels.isEmpty())
+            m_pMinimumNorm->setSourceSelection(m_qListSelectedLabels);
 
         // Set up the inverse according to the parameters.
         // Use 1 nave here because in case of evoked data as input the minimum norm will always be updated when the source estimate is calculated (see run method).
@@ -596,7 +641,6 @@ void MNE::run()
     // Init parameters
     m_bProcessData = true;
 
-    qint32 skip_count = 0;
     qint32 t_evokedSize;
     MatrixXd rawSegment;
     MatrixXd data;
@@ -605,6 +649,9 @@ void MNE::run()
     MNESourceEstimate sourceEstimate;
     FiffEvoked t_fiffEvoked;
 
+    //Anti-alias filter and decimate the raw data instead of skipping blocks, the state is kept across blocks
+    RtResample rtResample(1, m_iDownSample);
+
     // Start processing data
     while(m_bIsRunning) {
         m_qMutex.lock();
@@ -615,9 +662,14 @@ void MNE::run()
         if(m_pMatrixDataBuffer) {
             //qDebug()<<"MNE::run - Processing RTMSA data";
 
-            if(m_pMinimumNorm && ((skip_count % m_iDownSample) == 0)) {
+            if(m_pMinimumNorm) {
                 rawSegment = m_pMatrixDataBuffer->pop();
 
+                //Redesign the anti-aliasing filter if the down sample factor changed, this resets the filter state
+                if(rtResample.getDown() != m_iDownSample) {
+                    rtResample.setRatio(1, m_iDownSample);
+                }
+
                 //Pick the same channels as in the inverse operator
                 data.resize(m_invOp.noise_cov->names.size(), rawSegment.cols());
 
@@ -625,32 +677,43 @@ void MNE::run()
                     data.row(j) = rawSegment.row(m_pFiffInfoInput->ch_names.indexOf(m_invOp.noise_cov->names.at(j)));
                 }
 
-                tmin = 0.0f;
-                tstep = 1.0f / m_pFiffInfoInput->sfreq;
+                //Reduce the sampling rate of the picked channels before the source estimation, a short block may yield no sample
+                rtResample.resample(data, data);
 
-                //TODO: Add picking here. See evoked part as input.
-                m_qMutex.lock();
-                sourceEstimate = m_pMinimumNorm->calculateInverse(data,
-                                                                  tmin,
-                                                                  tstep);
+                if(data.cols() > 0) {
+                    tmin = 0.0f;
+                    tstep = (float)m_iDownSample / m_pFiffInfoInput->sfreq;
 
-                m_qMutex.unlock();
+                    //TODO: Add picking here. See evoked part as input.
+                    m_qMutex.lock();
 
-                if(!sourceEstimate.isEmpty()) {
-                    m_pRTSEOutput->data()->setValue(sourceEstimate);
+                    //Reuse the source estimate across blocks, it is only recreated when the block size or the vertices change
+                    if(sourceEstimate.data.cols() != data.cols()
+                       || sourceEstimate.tstep != tstep
+                       || sourceEstimate.vertices.size() != m_pMinimumNorm->getSelectedVertices().size()
+                       || sourceEstimate.vertices != m_pMinimumNorm->getSelectedVertices()) {
+                        sourceEstimate = MNESourceEstimate(MatrixXd(m_pMinimumNorm->getSelectedVertices().size(), data.cols()),
+                                                           m_pMinimumNorm->getSelectedVertices(),
+                                                           tmin,
+                                                           tstep);
+                    }
+
+                    bool bApplied = m_pMinimumNorm->applyInverse(data,
+                                                                 sourceEstimate.data);
+
+                    m_qMutex.unlock();
+
+                    if(bApplied && !sourceEstimate.isEmpty()) {
+                        m_pRTSEOutput->data()->setValue(sourceEstimate);
+                    }
                 }
-            } else {
-                m_qMutex.lock();
-                m_qVecFiffEvoked.pop_front();
-                m_qMutex.unlock();
             }
-            ++skip_count;
         }
 
-        //Process data from averaging input
+        //Process data from averaging input, every evoked response is used since the down sample factor only applies to raw data
         if(t_evokedSize > 0) {
             //qDebug() << "MNE::run - Processing RTE data - t_evokedSize" << t_evokedSize;
-            if(m_pMinimumNorm && ((skip_count % m_iDownSample) == 0)) {
+            if(m_pMinimumNorm) {
                 m_qMutex.lock();
                 t_fiffEvoked = m_qVecFiffEvoked.takeFirst();
                 //qDebug()<<"MNE::run - t_fiffEvoked.data.rows()"<<t_fiffEvoked.data.rows();
@@ -674,7 +737,6 @@ void MNE::run()
                 m_qVecFiffEvoked.pop_front();
                 m_qMutex.unlock();
             }
-            ++skip_count;
         }
     }
 }
@@ -52,6 +52,8 @@
 
 #include <mne/mne_inverse_operator.h>
 
+#include <fs/label.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -205,6 +207,23 @@ public:
     */
     void updateInvOp(const MNELIB::MNEInverseOperator& invOp);
 
+    //=========================================================================================================
+    /**
+    * Restricts the source estimation of raw data to the source points covered by the labels, e.g. the labels
+    * which are visualized or fed into the connectivity estimation. An empty list estimates all sources.
+    *
+    * @param[in] qListLabels    The labels to estimate
+    */
+    void setSourceSelection(const QList<FSLIB::Label>& qListLabels);
+
+    //=========================================================================================================
+    /**
+    * Sets whether the source estimation of raw data uses a single precision kernel.
+    *
+    * @param[in] bSinglePrecision   Whether to use the single precision kernel
+    */
+    void setSinglePrecision(bool bSinglePrecision);
+
 protected:
     //=========================================================================================================
     /**
@@ -247,12 +266,13 @@ protected:
     QVector<FIFFLIB::FiffEvoked>    m_qVecFiffEvoked;           /**< The list of stored averages. */
 
     qint32                          m_iNumAverages;             /**< The number of trials/averages to store. */
-    qint32                          m_iDownSample;              /**< Down sample factor. */
+    qint32                          m_iDownSample;              /**< Down sample factor, raw data is decimated with an anti-aliasing filter (RtResample). */
 
     bool                            m_bIsRunning;               /**< If source lab is running. */
     bool                            m_bReceiveData;             /**< If thread is ready to receive data. */
     bool                            m_bProcessData;             /**< If data should be received for processing. */
     bool                            m_bFinishedClustering;      /**< If clustered forward solution is available. */
+    bool                            m_bSinglePrecision;         /**< If the raw data is estimated with a single precision kernel. */
 
     QFile                           m_qFileFwdSolution;         /**< File to forward solution. */
 
@@ -264,6 +284,8 @@ protected:
     QStringList                     m_qListCovChNames;          /**< Covariance channel names. */
     QStringList                     m_qListPickChannels;        /**< Channels to pick. */
 
+    QList<FSLIB::Label>             m_qListSelectedLabels;      /**< The labels to which the source estimation of raw data is restricted. */
+
     MNELIB::MNEInverseOperator      m_invOp;                    /**< The inverse operator. */
 
 signals:
@@ -757,7 +757,9 @@ void NoiseReduction::run()
 
         //Do temporal filtering here
         if(m_bFilterActivated) {
-            t_mat = m_pRtFilter->filterChannelsConcurrently(t_mat, m_iMaxFilterLength, m_lFilterChannelList, m_filterData);
+            if(!m_pRtFilter->filterChannelsConcurrently(t_mat, m_lFilterChannelList, m_filterData)) {
+                qWarning() << "NoiseReduction::run - Could not filter the data block, passing it on unfiltered.";
+            }
         }
 
 //        qDebug()<<"t_mat dim:"<<t_mat.rows()<<"x"<<t_mat.cols();
@@ -74,6 +74,9 @@ RtHpiSetupWidget::RtHpiSetupWidget(RtHpi* toolbox, QWidget *parent)
     ui.setupUi(this);
 
     connect(ui.m_qPushButton_About, SIGNAL(released()), this, SLOT(showAboutDialog()));
+
+    ui.m_qSpinBox_DemodulationWindow->setValue(m_pRtHpi->getDemodulationWindow());
+    connect(ui.m_qSpinBox_DemodulationWindow, SIGNAL(valueChanged(int)), this, SLOT(onDemodulationWindowChanged(int)));
 //    connect(ui.bn_PolhemusLoadFile, SIGNAL(released()), this, SLOT(bnLoadPolhemusFile()));
 
 }
@@ -96,5 +99,13 @@ void RtHpiSetupWidget::showAboutDialog()
 }
 
 
+//*************************************************************************************************************
+
+void RtHpiSetupWidget::onDemodulationWindowChanged(int iNumBlocks)
+{
+    m_pRtHpi->setDemodulationWindow(iNumBlocks);
+}
+
+
 
 
@@ -127,6 +127,14 @@ private slots:
     *
     */
     void showAboutDialog();
+
+    //=========================================================================================================
+    /**
+    * Forwards the new demodulation window to the RtHpi
+    *
+    * @param[in] iNumBlocks     The number of blocks.
+    */
+    void onDemodulationWindowChanged(int iNumBlocks);
 //    //=========================================================================================================
 //    /**
 //    * Load a Polhemus file
@@ -55,6 +55,7 @@
 
 #include <QtCore/QtPlugin>
 #include <QDebug>
+#include <QSettings>
 
 
 //*************************************************************************************************************
@@ -75,6 +76,7 @@ using namespace Eigen;
 RtHpi::RtHpi()
 : m_bIsRunning(false)
 , m_bProcessData(false)
+, m_iDemodWindow(1)
 , m_pRTMSAInput(NULL)
 , m_pRTMSAOutput(NULL)
 , m_pRtHpiBuffer(CircularMatrixBuffer<double>::SPtr())
@@ -88,6 +90,10 @@ RtHpi::~RtHpi()
 {
     if(this->isRunning())
         stop();
+
+    //Store settings for next use
+    QSettings settings;
+    settings.setValue(QString("RTHPI/demodulationWindow"), m_iDemodWindow);
 }
 
 
@@ -126,6 +132,9 @@ void RtHpi::init()
     //Delete Buffer - will be initailzed with first incoming data
     if(!m_pRtHpiBuffer.isNull())
         m_pRtHpiBuffer = CircularMatrixBuffer<double>::SPtr();
+
+    QSettings settings;
+    m_iDemodWindow = settings.value(QString("RTHPI/demodulationWindow"), 1).toInt();
 }
 
 
@@ -250,6 +259,28 @@ void RtHpi::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 
 
 
+//*************************************************************************************************************
+
+void RtHpi::setDemodulationWindow(int iNumBlocks)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_iDemodWindow = iNumBlocks;
+
+    if(m_pRtHPIS) {
+        m_pRtHPIS->setDemodulationWindow(iNumBlocks);
+    }
+}
+
+
+//*************************************************************************************************************
+
+int RtHpi::getDemodulationWindow() const
+{
+    return m_iDemodWindow;
+}
+
+
 //*************************************************************************************************************
 
 void RtHpi::run()
@@ -274,7 +305,10 @@ void RtHpi::run()
 
     qDebug()<<"+++++++++++ Start Real time HPI thread +++++++++++++++++++";
 
+    m_qMutex.lock();
     m_pRtHPIS = RtHPIS::SPtr(new RtHPIS(m_pFiffInfo));
+    m_pRtHPIS->setDemodulationWindow(m_iDemodWindow);
+    m_qMutex.unlock();
 
     while (m_bIsRunning) {
         if(m_bProcessData) {
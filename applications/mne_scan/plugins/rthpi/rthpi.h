@@ -141,6 +141,21 @@ public:
 
     void update(SCMEASLIB::Measurement::SPtr pMeasurement);
 
+    //=========================================================================================================
+    /**
+    * Sets the number of blocks the coil amplitudes are demodulated over.
+    *
+    * @param[in] iNumBlocks     The number of blocks.
+    */
+    void setDemodulationWindow(int iNumBlocks);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of blocks the coil amplitudes are demodulated over.
+    *
+    * @return The number of blocks.
+    */
+    int getDemodulationWindow() const;
 
 
 signals:
@@ -170,6 +185,7 @@ private:
 
     bool m_bIsRunning;      /**< If source lab is running */
     bool m_bProcessData;    /**< If data should be received for processing */
+    int m_iDemodWindow;     /**< The number of blocks the coil amplitudes are demodulated over */
     QMutex m_qMutex;       /**< mutex for hpi */
 
     RtHPIS::SPtr m_pRtHPIS;                       /**< Real-time HPI Estimation. */
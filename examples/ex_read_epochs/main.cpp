@@ -169,15 +169,15 @@ int main(int argc, char *argv[])
                      t_fileRawName,
                      events);
 
-    // Read the epochs and reject epochs with EOG higher than 250e-06
-    MNEEpochDataList data = MNEEpochDataList::readEpochs(raw,
-                                                         events,
-                                                         fTMin,
-                                                         fTMax,
-                                                         event,
-                                                         250.0*0.0000010,
-                                                         "eog",
-                                                         picks);
+    // Read the epochs in merged chunks and reject epochs with EOG higher than 250e-06
+    MNEEpochDataList data = MNEEpochDataList::readEpochsBatched(raw,
+                                                                events,
+                                                                fTMin,
+                                                                fTMax,
+                                                                event,
+                                                                250.0*0.0000010,
+                                                                "eog",
+                                                                picks);
 
     // Drop rejected epochs
     data.dropRejected();
@@ -91,6 +91,9 @@ FilterView::FilterView(QWidget *parent,
 , ui(new Ui::FilterViewWidget)
 , m_iWindowSize(4016)
 , m_iFilterTaps(512)
+, m_iMaxFilterTaps(256)
+, m_iFilterOrder(4)
+, m_bIIRDesign(false)
 , m_dSFreq(600)
 {
     ui->setupUi(this);
@@ -166,8 +169,13 @@ void FilterView::setMaxFilterTaps(int iMaxNumberFilterTaps)
     if(iMaxNumberFilterTaps>512)
         iMaxNumberFilterTaps = 512;
 
-    ui->m_spinBox_filterTaps->setMaximum(iMaxNumberFilterTaps);
-    ui->m_spinBox_filterTaps->setMinimum(16);
+    m_iMaxFilterTaps = iMaxNumberFilterTaps;
+
+    //The spin box holds the filter order while an IIR design method is selected
+    if(!m_bIIRDesign) {
+        ui->m_spinBox_filterTaps->setMaximum(iMaxNumberFilterTaps);
+        ui->m_spinBox_filterTaps->setMinimum(16);
+    }
 
     //Update filter depending on new window size
     filterParametersChanged();
@@ -196,7 +204,6 @@ void FilterView::setFilterParameters(double hp, double lp, int order, int type,
 {
     ui->m_doubleSpinBox_highpass->setValue(lp);
     ui->m_doubleSpinBox_lowpass->setValue(hp);
-    ui->m_spinBox_filterTaps->setValue(order);
 
     if(type == 0)
         ui->m_comboBox_filterType->setCurrentText("Lowpass");
@@ -211,6 +218,13 @@ void FilterView::setFilterParameters(double hp, double lp, int order, int type,
         ui->m_comboBox_designMethod->setCurrentText("Tschebyscheff");
     if(designMethod == 1)
         ui->m_comboBox_designMethod->setCurrentText("Cosine");
+    if(designMethod == 3)
+        ui->m_comboBox_designMethod->setCurrentText("Butterworth");
+    if(designMethod == 4)
+        ui->m_comboBox_designMethod->setCurrentText("Chebyshev");
+
+    //Set the order after the design method, which determines whether it is the number of taps or the IIR order
+    ui->m_spinBox_filterTaps->setValue(order);
 
     ui->m_doubleSpinBox_transitionband->setValue(transition);
 
@@ -279,6 +293,8 @@ bool FilterView::userDesignedFiltersIsActive()
 
 void FilterView::initCheckBoxes()
 {
+    connect(ui->m_checkBox_minimumPhase,&QCheckBox::toggled,
+                this,&FilterView::filterParametersChanged);
 }
 
 
@@ -572,8 +588,41 @@ void FilterView::changeStateSpinBoxes(int currentIndex)
             ui->m_spinBox_filterTaps->setVisible(true);
             ui->m_label_filterTaps->setVisible(true);
             break;
+
+        case 2: //Butterworth
+        case 3: //Chebyshev
+            ui->m_spinBox_filterTaps->setVisible(true);
+            ui->m_label_filterTaps->setVisible(true);
+            break;
+    }
+
+    //IIR filters are parametrized by their order instead of the number of taps
+    bool bIIRDesign = ui->m_comboBox_designMethod->currentIndex() >= 2;
+
+    if(bIIRDesign != m_bIIRDesign) {
+        ui->m_spinBox_filterTaps->blockSignals(true);
+
+        if(bIIRDesign) {
+            m_iFilterTaps = ui->m_spinBox_filterTaps->value();
+            ui->m_label_filterTaps->setText("Filter order:");
+            ui->m_spinBox_filterTaps->setRange(1, 10);
+            ui->m_spinBox_filterTaps->setSingleStep(1);
+            ui->m_spinBox_filterTaps->setValue(m_iFilterOrder);
+        } else {
+            m_iFilterOrder = ui->m_spinBox_filterTaps->value();
+            ui->m_label_filterTaps->setText("Filter taps:");
+            ui->m_spinBox_filterTaps->setRange(16, m_iMaxFilterTaps);
+            ui->m_spinBox_filterTaps->setSingleStep(2);
+            ui->m_spinBox_filterTaps->setValue(m_iFilterTaps);
+        }
+
+        ui->m_spinBox_filterTaps->blockSignals(false);
+        m_bIIRDesign = bIIRDesign;
     }
 
+    //IIR filters are not linear phase in the first place
+    ui->m_checkBox_minimumPhase->setEnabled(!bIIRDesign);
+
     //Change visibility of spin boxes depending on filter type
     switch(ui->m_comboBox_filterType->currentIndex()) {
         case 0: //Bandpass
@@ -630,11 +679,20 @@ void FilterView::filterParametersChanged()
     double nyquistFrequency = samplingFrequency/2;
 
     //Calculate the needed fft length
-    m_iFilterTaps = ui->m_spinBox_filterTaps->value();
-    if(ui->m_spinBox_filterTaps->value()%2 != 0)
-        m_iFilterTaps--;
+    int fftLength;
+
+    if(m_bIIRDesign) {
+        //The impulse response of IIR filters is truncated to a quarter of the fft length, see FilterData::designFilter
+        m_iFilterOrder = ui->m_spinBox_filterTaps->value();
+        fftLength = 2 * m_iWindowSize;
+    } else {
+        m_iFilterTaps = ui->m_spinBox_filterTaps->value();
+        if(ui->m_spinBox_filterTaps->value()%2 != 0)
+            m_iFilterTaps--;
+
+        fftLength = m_iWindowSize + ui->m_spinBox_filterTaps->value() * 4; // *2 to take into account the overlap in front and back after the convolution. Another *2 to take into account the appended and prepended data.
+    }
 
-    int fftLength = m_iWindowSize + ui->m_spinBox_filterTaps->value() * 4; // *2 to take into account the overlap in front and back after the convolution. Another *2 to take into account the appended and prepended data.
     int exp = ceil(MNEMath::log2(fftLength));
     fftLength = pow(2, exp) <512 ? 512 : pow(2, exp);
 
@@ -664,6 +722,14 @@ void FilterView::filterParametersChanged()
     if(ui->m_comboBox_designMethod->currentText() == "Cosine")
         dMethod = FilterData::Cosine;
 
+    if(ui->m_comboBox_designMethod->currentText() == "Butterworth")
+        dMethod = FilterData::Butterworth;
+
+    if(ui->m_comboBox_designMethod->currentText() == "Chebyshev")
+        dMethod = FilterData::Chebyshev;
+
+    int iOrder = m_bIIRDesign ? m_iFilterOrder : m_iFilterTaps;
+
     //Generate filters
     QSharedPointer<FilterData> userDefinedFilterOperator;
 
@@ -673,39 +739,42 @@ void FilterView::filterParametersChanged()
         userDefinedFilterOperator = QSharedPointer<FilterData>(
                                                 new FilterData("User Design",
                                                                FilterData::LPF,
-                                                               m_iFilterTaps,
+                                                               iOrder,
                                                                lowpassHz/nyquistFrequency,
                                                                0.2,
                                                                (double)trans_width/nyquistFrequency,
                                                                samplingFrequency,
                                                                fftLength,
-                                                               dMethod));
+                                                               dMethod,
+                                                               ui->m_checkBox_minimumPhase->isChecked()));
     }
 
     if(ui->m_comboBox_filterType->currentText() == "Highpass") {
         userDefinedFilterOperator = QSharedPointer<FilterData>(
                                         new FilterData("User Design",
                                                         FilterData::HPF,
-                                                        m_iFilterTaps,
+                                                        iOrder,
                                                         highpassHz/nyquistFrequency,
                                                         0.2,
                                                         (double)trans_width/nyquistFrequency,
                                                         samplingFrequency,
                                                         fftLength,
-                                                        dMethod));
+                                                        dMethod,
+                                                        ui->m_checkBox_minimumPhase->isChecked()));
     }
 
     if(ui->m_comboBox_filterType->currentText() == "Bandpass") {
         userDefinedFilterOperator = QSharedPointer<FilterData>(
                    new FilterData("User Design",
                                   FilterData::BPF,
-                                  m_iFilterTaps,
+                                  iOrder,
                                   (double)center/nyquistFrequency,
                                   (double)bw/nyquistFrequency,
                                   (double)trans_width/nyquistFrequency,
                                   samplingFrequency,
                                   fftLength,
-                                  dMethod));
+                                  dMethod,
+                                  ui->m_checkBox_minimumPhase->isChecked()));
     }
 
     //Replace old with new filter operator
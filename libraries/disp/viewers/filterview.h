@@ -351,6 +351,9 @@ protected:
 
     int                         m_iWindowSize;              /**< The current window size of the loaded fiff data in the DataWindow class.*/
     int                         m_iFilterTaps;              /**< The current number of filter taps.*/
+    int                         m_iMaxFilterTaps;           /**< The maximal number of filter taps.*/
+    int                         m_iFilterOrder;             /**< The current order of IIR filters.*/
+    bool                        m_bIIRDesign;               /**< Whether an IIR design method is selected, the filter taps spin box then holds the filter order.*/
     double                      m_dSFreq;                   /**< The current sampling frequency.*/   
 
 signals:
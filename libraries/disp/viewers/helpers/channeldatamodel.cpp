@@ -107,6 +107,8 @@ ChannelDataModel::ChannelDataModel(QObject *parent)
 , m_iCurrentTriggerChIndex(0)
 , m_pFiffInfo(FiffInfo::SPtr::create())
 {
+    //The channels which are not filtered are copied from the raw block, so the filter does not need to delay them
+    m_filterOverlapAdd.setDelayPassThrough(false);
 }
 
 //*************************************************************************************************************
@@ -340,7 +342,7 @@ void ChannelDataModel::setFiffInfo(QSharedPointer<FIFFLIB::FiffInfo> &p_pFiffInf
         m_vecLastBlockFirstValuesRaw.conservativeResize(m_pFiffInfo->chs.size());
         m_vecLastBlockFirstValuesRaw.setZero();
 
-        m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
+        m_filterOverlapAdd.reset();
 
         m_matSparseProjMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
         m_matSparseCompMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
@@ -533,13 +535,16 @@ void ChannelDataModel::addData(const QList<MatrixXd> &data)
 
             //Perform SPHARA on filtered data after actual filtering - SPHARA should be applied on the best possible data
             if(doSphara) {
-                if(m_iCurrentSample-m_iMaxFilterLength/2 >= 0) {
-                    m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol);
+                //The filtered block was written filter delay samples before the current sample, the delay is zero for minimum-phase and IIR filters
+                int iFilterDelay = m_filterOverlapAdd.getDelay();
+
+                if(m_iCurrentSample-iFilterDelay >= 0) {
+                    m_matDataFiltered.block(0, m_iCurrentSample-iFilterDelay, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-iFilterDelay, nRow, nCol);
                 }
                 else {
-                    if(m_iCurrentSample-m_iMaxFilterLength/2 < 0) {
+                    if(m_iCurrentSample-iFilterDelay < 0) {
                         m_matDataFiltered.block(0, 0, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, 0, nRow, nCol);
-                        int iResidual = m_iResidual+m_iMaxFilterLength/2;
+                        int iResidual = m_iResidual+iFilterDelay;
                         m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual);
                     }
                 }
@@ -927,8 +932,11 @@ void ChannelDataModel::filterChanged(QList<FilterData> filterData)
         }
     }
 
-    m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
-    m_matOverlap.setZero();
+    //The filter engine composes the whole chain, its overlap spans all filters
+    if(m_filterOverlapAdd.setFilters(m_filterData)) {
+        m_iMaxFilterLength = qMax(m_iMaxFilterLength, m_filterOverlapAdd.getFilterLength());
+    }
+    m_filterOverlapAdd.reset();
 
     m_bDrawFilterFront = false;
 
@@ -984,6 +992,8 @@ void ChannelDataModel::setFilterChannelType(QString channelType)
 
 //    m_bDrawFilterFront = false;
 
+    updateFilterChannels();
+
     //Filter all visible data channels at once
     //filterChannelsConcurrently();
 }
@@ -1026,6 +1036,8 @@ void ChannelDataModel::createFilterChannelList(QStringList channelNames)
 //    for(int i = 0; i<m_filterChannelList.size(); ++i)
 //        std::cout<<m_filterChannelList.at(i).toStdString()<<std::endl;
 
+    updateFilterChannels();
+
     //Filter all visible data channels at once
     //filterChannelsConcurrently();
 }
@@ -1137,7 +1149,8 @@ void doFilterPerChannelRTMSA(QPair<QList<FilterData>,QPair<int,RowVectorXd> > &c
 {
     for(int i = 0; i < channelDataTime.first.size(); ++i) {
         //channelDataTime.second.second = channelDataTime.first.at(i).applyConvFilter(channelDataTime.second.second, true, FilterData::ZeroPad);
-        channelDataTime.second.second = channelDataTime.first.at(i).applyFFTFilter(channelDataTime.second.second, true, FilterData::ZeroPad); //FFT Convolution for rt is not suitable. FFT make the signal filtering non causal.
+        //Without overhead each filter compensates its own delay and keeps the length, so the data is filtered in place
+        channelDataTime.first.at(i).applyFFTFilter(channelDataTime.second.second, channelDataTime.second.second, false, FilterData::ZeroPad); //FFT Convolution for rt is not suitable. FFT make the signal filtering non causal.
     }
 }
 
@@ -1168,7 +1181,8 @@ void ChannelDataModel::filterChannelsConcurrently()
                               m_filterData.at(i).m_dParksWidth,
                               m_filterData.at(i).m_sFreq,
                               fftLength,
-                              m_filterData.at(i).m_designMethod);
+                              m_filterData.at(i).m_designMethod,
+                              m_filterData.at(i).m_bMinimumPhase);
 
         tempFilterList.append(tempFilter);
     }
@@ -1179,7 +1193,7 @@ void ChannelDataModel::filterChannelsConcurrently()
 
     //Also append mirrored data in front and back to get rid of edge effects
     for(qint32 i=0; i<m_matDataRaw.rows(); ++i) {
-        if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name)) {
+        if(m_filterOverlapAdd.isFilterChannel(i)) {
             RowVectorXd datTemp(m_matDataRaw.row(i).cols() + 2 * m_iMaxFilterLength);
             datTemp << m_matDataRaw.row(i).head(m_iMaxFilterLength).reverse(), m_matDataRaw.row(i), m_matDataRaw.row(i).tail(m_iMaxFilterLength).reverse();
             timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(tempFilterList,QPair<int,RowVectorXd>(i,datTemp)));
@@ -1196,8 +1210,7 @@ void ChannelDataModel::filterChannelsConcurrently()
         future.waitForFinished();
 
         for(int r = 0; r < timeData.size(); ++r) {
-            m_matDataFiltered.row(timeData.at(r).second.first) = timeData.at(r).second.second.segment(m_iMaxFilterLength+m_iMaxFilterLength/2, m_matDataRaw.cols());
-            m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
+            m_matDataFiltered.row(timeData.at(r).second.first) = timeData.at(r).second.second.segment(m_iMaxFilterLength, m_matDataRaw.cols());
         }
     }
 
@@ -1224,110 +1237,68 @@ void ChannelDataModel::filterChannelsConcurrently(const MatrixXd &data, int iDat
         return;
     }
 
-    //Generate QList structure which can be handled by the QConcurrent framework
-    QList<QPair<QList<FilterData>,QPair<int,RowVectorXd> > > timeData;
-    QList<int> notFilterChannelIndex;
-
-    for(qint32 i = 0; i < data.rows(); ++i) {
-        if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name)) {
-            timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(m_filterData,QPair<int,RowVectorXd>(i,data.row(i))));
-        } else {
-            notFilterChannelIndex.append(i);
-            }
+    //Filter all channels of the block at once. The filtered channels are delayed by the filter delay, the rows of the
+    //remaining channels are left untouched and are copied from the raw block below.
+    if(!m_filterOverlapAdd.filterData(data, m_matFilterBlock)) {
+        return;
     }
 
-    //Do the concurrent filtering
-    if(!timeData.isEmpty()) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                             doFilterPerChannelRTMSA);
-
-        future.waitForFinished();
-
-        //Do the overlap add method and store in m_matDataFiltered
-        int iFilterDelay = m_iMaxFilterLength/2;
-        int iFilteredNumberCols = timeData.at(0).second.second.cols();
+    int iFilterDelay = m_filterOverlapAdd.getDelay();
+    int iFilterLength = m_filterOverlapAdd.getFilterLength();
+    int iNumSamples = data.cols();
+    int iStart = iDataIndex-iFilterDelay;
+    const QVector<int>& vecFilterChannels = m_filterOverlapAdd.getFilterChannels();
 
-        for(int r = 0; r<timeData.size(); ++r) {
-            if(iDataIndex+2*data.cols() > m_matDataRaw.cols()) {
-                //Handle last data block
-                //std::cout<<"Handle last data block"<<std::endl;
-
-                if(m_bDrawFilterFront) {
-                    //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
-
-                    //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
-
-                    //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-                    int start = iDataIndex-iFilterDelay < 0 ? 0 : iDataIndex-iFilterDelay;
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(start,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
-                } else {
-                    //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex-iFilterDelay,m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
-                }
+    for(int s = 0; s < vecFilterChannels.size(); ++s) {
+        int ch = vecFilterChannels.at(s);
+        if(ch >= data.rows()) {
+            continue;
+        }
 
-                //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
-            } else if(iDataIndex == 0) {
-                //Handle first data block
-                //std::cout<<"Handle first data block"<<std::endl;
+        //Perform this everytime the filter was changed. Do not plot the front because the impulse response and the overlap do not match with the new filter anymore.
+        if(!m_bDrawFilterFront) {
+            m_matFilterBlock.row(ch).head(qMin(iFilterLength, iNumSamples)).setZero();
+        }
 
-                if(m_bDrawFilterFront) {
-                    //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
+        //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
+        if(iStart >= 0) {
+            m_matDataFiltered.row(ch).segment(iStart, iNumSamples) = m_matFilterBlock.row(ch);
+        } else {
+            //The front of the first block belongs to the tail of the filter data matrix
+            m_matDataFiltered.row(ch).segment(m_matDataFiltered.cols()-m_iResidual+iStart, -iStart) = m_matFilterBlock.row(ch).head(-iStart);
+            m_matDataFiltered.row(ch).head(iNumSamples+iStart) = m_matFilterBlock.row(ch).tail(iNumSamples+iStart);
 
-                    //Add newly calculate data to the tail of the current filter data matrix
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(m_matDataFiltered.cols()-iFilterDelay-m_iResidual, iFilterDelay) = tempData.head(iFilterDelay) + m_matOverlap.row(timeData.at(r).second.first).head(iFilterDelay);
+            //Copy residual data from the front to the back. The residual is != 0 if the chosen block size cannot be evenly fit into the matrix size
+            m_matDataFiltered.row(ch).tail(m_iResidual) = m_matDataFiltered.row(ch).head(m_iResidual);
+        }
+    }
 
-                    //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
-                    m_matDataFiltered.row(timeData.at(r).second.first).head(iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay) = tempData.segment(iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay);
+    m_bDrawFilterFront = true;
 
-                    //Copy residual data from the front to the back. The residual is != 0 if the chosen block size cannot be evenly fit into the matrix size
-                    m_matDataFiltered.row(timeData.at(r).second.first).tail(m_iResidual) = m_matDataFiltered.row(timeData.at(r).second.first).head(m_iResidual);
-                } else {
-                    //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).head(m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
-                }
+    //Fill filtered data with raw data if the channel was not filtered
+    for(int i = 0; i < data.rows(); ++i) {
+        if(!m_filterOverlapAdd.isFilterChannel(i)) {
+            m_matDataFiltered.row(i).segment(iDataIndex,iNumSamples) = data.row(i);
+        }
+    }
 
-                //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
-            } else {
-                //Handle middle data blocks
-                //std::cout<<"Handle middle data block"<<std::endl;
+    //std::cout<<"END ChannelDataModel::filterChannelsConcurrently"<<std::endl;
+}
 
-                if(m_bDrawFilterFront) {
-                    //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
 
-                    //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
+//*************************************************************************************************************
 
-                    //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex-iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
-                } else {
-                    //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex-iFilterDelay,m_iMaxFilterLength).setZero();// = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
-                }
+void ChannelDataModel::updateFilterChannels()
+{
+    QVector<int> vecFilterChannels;
 
-                //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
-            }
+    for(int i = 0; i < m_pFiffInfo->chs.size(); ++i) {
+        if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name)) {
+            vecFilterChannels.append(i);
         }
     }
 
-    m_bDrawFilterFront = true;
-
-    //Fill filtered data with raw data if the channel was not filtered
-    for(int i = 0; i < notFilterChannelIndex.size(); ++i) {
-        m_matDataFiltered.row(notFilterChannelIndex.at(i)).segment(iDataIndex,data.row(notFilterChannelIndex.at(i)).cols()) = data.row(notFilterChannelIndex.at(i));
-    }
-
-    //std::cout<<"END ChannelDataModel::filterChannelsConcurrently"<<std::endl;
+    m_filterOverlapAdd.setFilterChannels(vecFilterChannels);
 }
 
 
@@ -1343,7 +1314,7 @@ void ChannelDataModel::clearModel()
     m_matDataFilteredFreeze.setZero();
     m_vecLastBlockFirstValuesFiltered.setZero();
     m_vecLastBlockFirstValuesRaw.setZero();
-    m_matOverlap.setZero();
+    m_filterOverlapAdd.reset();
 
     endResetModel();
 
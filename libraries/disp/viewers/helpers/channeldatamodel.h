@@ -46,6 +46,7 @@
 
 #include <fiff/fiff_types.h>
 #include <utils/filterTools/filterdata.h>
+#include <utils/filterTools/filteroverlapadd.h>
 
 
 //*************************************************************************************************************
@@ -521,6 +522,12 @@ private:
     */
     void filterChannelsConcurrently();
 
+    //=========================================================================================================
+    /**
+    * Hands the indices of the channels in m_filterChannelList to the filter engine.
+    */
+    void updateFilterChannels();
+
     //=========================================================================================================
     /**
     * Calculates the filtered version of the raw input data
@@ -569,7 +576,7 @@ private:
     MatrixXdR                           m_matDataFiltered;                          /**< The filtered data */
     MatrixXdR                           m_matDataRawFreeze;                         /**< The raw data in freeze mode */
     MatrixXdR                           m_matDataFilteredFreeze;                    /**< The raw filtered data in freeze mode */
-    Eigen::MatrixXd                     m_matOverlap;                               /**< Last overlap block for the back */
+    Eigen::MatrixXd                     m_matFilterBlock;                           /**< The last filtered block, delayed by the filter delay */
 
     Eigen::VectorXi                     m_vecIndicesFirstVV;                        /**< The indices of the channels to pick for the first SPHARA operator in case of a VectorView system.*/
     Eigen::VectorXi                     m_vecIndicesSecondVV;                       /**< The indices of the channels to pick for the second SPHARA operator in case of a VectorView system.*/
@@ -600,6 +607,7 @@ private:
     QMap<qint32,float>                  m_qMapChScaling;                            /**< Channel scaling map. */
     QList<UTILSLIB::FilterData>         m_filterData;                               /**< List of currently active filters. */
     QStringList                         m_filterChannelList;                        /**< List of channels which are to be filtered.*/
+    UTILSLIB::FilterOverlapAdd          m_filterOverlapAdd;                         /**< The overlap-add filter engine, keeps the overlap state between blocks. */
     QStringList                         m_visibleChannelList;                       /**< List of currently visible channels in the view.*/
     QMap<qint32,qint32>                 m_qMapIdxRowSelection;                      /**< Selection mapping.*/
 
@@ -38,7 +38,7 @@ include(../../mne-cpp.pri)
 
 TEMPLATE = lib
 
-QT += network
+QT += network concurrent
 QT -= gui
 
 DEFINES += FIFF_LIBRARY
@@ -89,6 +89,8 @@ SOURCES += fiff.cpp \
     fiff_io.cpp \
     fiff_dig_point_set.cpp \
     fiff_dir_node.cpp \
+    fiff_raw_recorder.cpp \
+    fiff_split_raw_data.cpp \
     c/fiff_coord_trans_old.cpp \
     c/fiff_sparse_matrix.cpp \
     c/fiff_digitizer_data.cpp \
@@ -121,6 +123,8 @@ HEADERS += fiff.h \
     fiff_io.h \
     fiff_dig_point_set.h \
     fiff_dir_node.h \
+    fiff_raw_recorder.h \
+    fiff_split_raw_data.h \
     c/fiff_coord_trans_old.h \
     c/fiff_sparse_matrix.h \
     c/fiff_types_mne-c.h \
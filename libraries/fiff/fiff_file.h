@@ -255,6 +255,12 @@ namespace FIFFLIB
 #define FIFFT_STREAM_SEGMENT_STRUCT 37
 #define FIFFT_DATA_REF_STRUCT       38
 /*
+* MNE-CPP extension: raw data buffer stored as delta coded, zlib compressed chunk.
+* The payload holds the number of samples and the type of the uncompressed buffer
+* (both int) followed by the qCompress'ed, per channel delta coded samples.
+*/
+#define FIFFT_DELTA_ZLIB           60
+/*
 * These are for matrices of any of the above 
 */
 #define FIFFC_MATRIX_MAX_DIM  9
@@ -42,6 +42,17 @@
 #include "fiff_tag.h"
 #include "fiff_stream.h"
 #include "cstdlib"
+#include <cstring>
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+#include <QtConcurrent>
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -59,6 +70,7 @@ using namespace FIFFLIB;
 FiffRawData::FiffRawData()
 : first_samp(-1)
 , last_samp(-1)
+, m_bOperatorCached(false)
 {
 
 }
@@ -69,6 +81,7 @@ FiffRawData::FiffRawData()
 FiffRawData::FiffRawData(QIODevice &p_IODevice)
 : first_samp(-1)
 , last_samp(-1)
+, m_bOperatorCached(false)
 {
     //setup FiffRawData object
     if(!FiffStream::setup_read_raw(p_IODevice, *this))
@@ -91,11 +104,34 @@ FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
 , rawdir(p_FiffRawData.rawdir)
 , proj(p_FiffRawData.proj)
 , comp(p_FiffRawData.comp)
+, m_vecRawDirLast(p_FiffRawData.m_vecRawDirLast)
+, m_bOperatorCached(false)
 {
 
 }
 
 
+//*************************************************************************************************************
+
+FiffRawData& FiffRawData::operator= (const FiffRawData &p_FiffRawData)
+{
+    if(this != &p_FiffRawData)
+    {
+        file = p_FiffRawData.file;
+        info = p_FiffRawData.info;
+        first_samp = p_FiffRawData.first_samp;
+        last_samp = p_FiffRawData.last_samp;
+        cals = p_FiffRawData.cals;
+        rawdir = p_FiffRawData.rawdir;
+        proj = p_FiffRawData.proj;
+        comp = p_FiffRawData.comp;
+        m_vecRawDirLast = p_FiffRawData.m_vecRawDirLast;
+        clear_operator_cache();
+    }
+    return *this;
+}
+
+
 //*************************************************************************************************************
 
 FiffRawData::~FiffRawData()
@@ -113,8 +149,22 @@ void FiffRawData::clear()
     last_samp = -1;
     cals = RowVectorXd();
     rawdir.clear();
+    m_vecRawDirLast.clear();
     proj = MatrixXd();
     comp.clear();
+    clear_operator_cache();
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawData::clear_operator_cache()
+{
+    QMutexLocker locker(&m_mutexOperatorCache);
+    m_bOperatorCached = false;
+    m_matCachedOperator = MatrixXd();
+    m_matCachedCal = SparseMatrix<double>();
+    m_matCachedMult = SparseMatrix<double>();
 }
 
 
@@ -127,13 +177,21 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                                    const RowVectorXi& sel,
                                    bool do_debug) const
 {
-    bool projAvailable = true;
+    SparseMatrix<double> multSegment;
+    return read_raw_segment(data, times, multSegment, from, to, sel, do_debug);
+}
 
-    if (this->proj.size() == 0) {
-        qDebug() << "FiffRawData::read_raw_segment - No projectors set";
-        projAvailable = false;
-    }
 
+//*************************************************************************************************************
+
+bool FiffRawData::read_raw_segment(MatrixXd& data,
+                                   MatrixXd& times,
+                                   SparseMatrix<double>& multSegment,
+                                   fiff_int_t from,
+                                   fiff_int_t to,
+                                   const RowVectorXi& sel,
+                                   bool do_debug) const
+{
     if(from == -1)
         from = this->first_samp;
     if(to == -1)
@@ -159,131 +217,207 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
     qint32 dest  = 0;//1;
     qint32 i, k, r;
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nchan);
-    for(i = 0; i < nchan; ++i)
-        tripletList.push_back(T(i, i, this->cals[i]));
+    //
+    //  The calibration, projection and compensation operator is composed once and reused by subsequent reads
+    //
+    SparseMatrix<double> cal, mult;
+    update_operator_cache(sel, cal, mult);
 
-    SparseMatrix<double> cal(nchan, nchan);
-    cal.setFromTriplets(tripletList.begin(), tripletList.end());
-//    cal.makeCompressed();
+    data = MatrixXd(sel.size() == 0 ? nchan : sel.size(), to-from+1);
 
-    MatrixXd mult_full;
-    //
-    if (sel.size() == 0)
+    FiffStream::SPtr fid;
+    if (!this->file->device()->isOpen())
     {
-        data = MatrixXd(nchan, to-from+1);
-//            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
+        if (!this->file->device()->open(QIODevice::ReadOnly))
         {
-            if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
-            else
-                mult_full = this->proj*this->comp.data->data*cal;
+            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
         }
+        fid = this->file;
     }
     else
     {
-        data = MatrixXd(sel.size(),to-from+1);
-//            data->setZero();
-
-        MatrixXd selVect(sel.size(), nchan);
-
-        selVect.setZero();
-
-        if (!projAvailable && this->comp.kind == -1)
-        {
-            tripletList.clear();
-            tripletList.reserve(sel.size());
-            for(i = 0; i < sel.size(); ++i)
-                tripletList.push_back(T(i, i, this->cals[sel[i]]));
-            cal = SparseMatrix<double>(sel.size(), sel.size());
-            cal.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-        else
-        {
-            if (!projAvailable)
-            {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*cal;
-            }
-            else
-            {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*this->comp.data->data*cal;
-            }
-        }
+        fid = this->file;
     }
 
     //
-    // Make mult sparse
-    //
-    tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
-
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
-    if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
-
+    //  Compressed buffers of the segment are read first and decompressed on the thread pool
     //
-
-    FiffStream::SPtr fid;
-    if (!this->file->device()->isOpen())
+    struct CompressedBuffer {
+        FiffTag::SPtr tag;
+        const uchar* payload;
+        fiff_int_t size;
+        fiff_int_t type;
+        QByteArray buffer;
+        bool ok;
+    };
+    fiff_int_t kFirst = find_rawdir_entry(from);
+    fiff_int_t kLast = qMin(find_rawdir_entry(to), (fiff_int_t)this->rawdir.size() - 1);
+    QVector<CompressedBuffer> compressed;
+    QVector<qint32> compressedIdx(qMax(kLast - kFirst + 1, 0), -1);
+    for(k = kFirst; k <= kLast; ++k)
     {
-        if (!this->file->device()->open(QIODevice::ReadOnly))
+        const FiffRawDir& thisRawDir = this->rawdir[k];
+        if (!thisRawDir.ent || thisRawDir.ent->kind == -1 || thisRawDir.ent->type != FIFFT_DELTA_ZLIB)
+            continue;
+
+        CompressedBuffer chunk;
+        chunk.payload = NULL;
+        chunk.ok = false;
+        fiff_int_t kind;
+        if (fid->is_mapped())
         {
-            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
+            fid->read_tag_view(thisRawDir.ent->pos, kind, chunk.type, chunk.size, chunk.payload);
         }
-        fid = this->file;
+        else if (fid->read_tag(chunk.tag, thisRawDir.ent->pos))
+        {
+            chunk.payload = (const uchar*)chunk.tag->constData();
+            chunk.size = chunk.tag->size();
+        }
+        if (!chunk.payload)
+        {
+            printf("Cannot access data buffer at %d\n", thisRawDir.ent->pos);
+            return false;
+        }
+        compressedIdx[k - kFirst] = compressed.size();
+        compressed.append(chunk);
     }
-    else
+    if (compressed.size() > 0)
     {
-        fid = this->file;
+        QtConcurrent::blockingMap(compressed, [nchan](CompressedBuffer& chunk) {
+            chunk.ok = decompress_raw_buffer(chunk.payload, chunk.size, nchan, chunk.type, chunk.buffer);
+            chunk.tag.clear();
+        });
     }
 
     MatrixXd one;
     fiff_int_t first_pick, last_pick, picksamp;
-    for(k = 0; k < this->rawdir.size(); ++k)
+    //
+    //  Skip all buffers before the first one we need
+    //
+    for(k = find_rawdir_entry(from); k < this->rawdir.size(); ++k)
     {
-        FiffRawDir thisRawDir = this->rawdir[k];
+        const FiffRawDir& thisRawDir = this->rawdir[k];
         //
         //  Do we need this buffer
         //
-        if (thisRawDir.last > from)
+        if (thisRawDir.last >= from)
         {
-            if (thisRawDir.ent->kind == -1)
+            //
+            //  The picking logic is a bit complicated
+            //
+            if (to >= thisRawDir.last && from <= thisRawDir.first)
+            {
+                //
+                //  We need the whole buffer
+                //
+                first_pick = 0;//1;
+                last_pick  = thisRawDir.nsamp - 1;
+                if (do_debug)
+                    printf("W");
+            }
+            else if (from > thisRawDir.first)
+            {
+                first_pick = from - thisRawDir.first;// + 1;
+                if(to < thisRawDir.last)
+                {
+                    //
+                    //  Something from the middle
+                    //
+//                    qDebug() << "This needs to be debugged!";
+                    last_pick = thisRawDir.nsamp + to - thisRawDir.last - 1;//is this alright?
+                    if (do_debug)
+                        printf("M");
+                }
+                else
+                {
+                    //
+                    //  From the middle to the end
+                    //
+                    last_pick = thisRawDir.nsamp - 1;
+                    if (do_debug)
+                        printf("E");
+                }
+            }
+            else
+            {
+                //
+                //  From the beginning to the middle
+                //
+                first_pick = 0;//1;
+                last_pick  = to - thisRawDir.first;// + 1;
+                if (do_debug)
+                    printf("B");
+            }
+            //
+            //  Now we are ready to pick
+            //
+            picksamp = last_pick - first_pick + 1;
+
+            if(do_debug)
+            {
+                qDebug() << "first_pick: " << first_pick;
+                qDebug() << "last_pick: " << last_pick;
+                qDebug() << "picksamp: " << picksamp;
+            }
+
+            if (!thisRawDir.ent || thisRawDir.ent->kind == -1)
             {
                 //
                 //  Take the easy route: skip is translated to zeros
                 //
                 if(do_debug)
                     printf("S");
-                if (sel.cols() <= 0)
-                    one.resize(nchan,thisRawDir.nsamp);
-                else
-                    one.resize(sel.cols(),thisRawDir.nsamp);
+                if (picksamp > 0)
+                    data.block(0,dest,data.rows(),picksamp).setZero();
+            }
+            else if (thisRawDir.ent->type == FIFFT_DELTA_ZLIB || fid->is_mapped())
+            {
+                //
+                //  Decode the decompressed buffer or the buffer straight from the mapped file into the destination
+                //
+                fiff_int_t kind, type, size;
+                const uchar* payload;
+                if (thisRawDir.ent->type == FIFFT_DELTA_ZLIB)
+                {
+                    const CompressedBuffer& chunk = compressed[compressedIdx[k - kFirst]];
+                    if (!chunk.ok)
+                    {
+                        printf("Cannot decompress data buffer at %d\n", thisRawDir.ent->pos);
+                        return false;
+                    }
+                    type = chunk.type;
+                    size = chunk.buffer.size();
+                    payload = (const uchar*)chunk.buffer.constData();
+                }
+                else if (!fid->read_tag_view(thisRawDir.ent->pos, kind, type, size, payload))
+                {
+                    printf("Cannot access data buffer at %d\n", thisRawDir.ent->pos);
+                    return false;
+                }
 
-                one.setZero();
+                if (picksamp > 0)
+                {
+                    //
+                    //  The payload is not copied, a truncated or damaged buffer must not be read beyond its end
+                    //
+                    bool ok;
+                    if (mult.cols() == 0)
+                    {
+                        ok = decode_raw_buffer(payload, size, type, nchan, first_pick, picksamp, sel, this->cals.data(), data, dest);
+                    }
+                    else
+                    {
+                        one.resize(nchan, picksamp);
+                        ok = decode_raw_buffer(payload, size, type, nchan, first_pick, picksamp, defaultRowVectorXi, NULL, one, 0);
+                        if (ok)
+                            data.block(0,dest,data.rows(),picksamp) = mult*one;
+                    }
+                    if (!ok)
+                    {
+                        printf("Cannot decode data buffer at %d (type %d, %d bytes for %d channels x %d samples)\n", thisRawDir.ent->pos, type, size, nchan, thisRawDir.nsamp);
+                        return false;
+                    }
+                }
             }
             else
             {
@@ -358,77 +492,18 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                         one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
                     else if(t_pTag->type == FIFFT_FLOAT)
                         one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+                    else if(t_pTag->type == FIFFT_SHORT)
+                        one = mult*(Map< MatrixShort >( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
                     else
                         printf("Data Storage Format not known jet [3]!! Type: %d\n", t_pTag->type);
                 }
-            }
-            //
-            //  The picking logic is a bit complicated
-            //
-            if (to >= thisRawDir.last && from <= thisRawDir.first)
-            {
-                //
-                //  We need the whole buffer
-                //
-                first_pick = 0;//1;
-                last_pick  = thisRawDir.nsamp - 1;
-                if (do_debug)
-                    printf("W");
-            }
-            else if (from > thisRawDir.first)
-            {
-                first_pick = from - thisRawDir.first;// + 1;
-                if(to < thisRawDir.last)
-                {
-                    //
-                    //  Something from the middle
-                    //
-//                    qDebug() << "This needs to be debugged!";
-                    last_pick = thisRawDir.nsamp + to - thisRawDir.last - 1;//is this alright?
-                    if (do_debug)
-                        printf("M");
-                }
-                else
-                {
-                    //
-                    //  From the middle to the end
-                    //
-                    last_pick = thisRawDir.nsamp - 1;
-                    if (do_debug)
-                        printf("E");
-                }
-            }
-            else
-            {
-                //
-                //  From the beginning to the middle
-                //
-                first_pick = 0;//1;
-                last_pick  = to - thisRawDir.first;// + 1;
-                if (do_debug)
-                    printf("B");
-            }
-            //
-            //  Now we are ready to pick
-            //
-            picksamp = last_pick - first_pick + 1;
 
-            if(do_debug)
-            {
-                qDebug() << "first_pick: " << first_pick;
-                qDebug() << "last_pick: " << last_pick;
-                qDebug() << "picksamp: " << picksamp;
+                if (picksamp > 0)
+                    data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
             }
 
             if (picksamp > 0)
-            {
-//                    for(r = 0; r < data->rows(); ++r)
-//                        for(c = 0; c < picksamp; ++c)
-//                            (*data)(r,dest + c) = one(r,first_pick + c);
-                data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
-
                 dest += picksamp;
-            }
         }
         //
         //  Done?
@@ -440,6 +515,10 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
         }
     }
 
+    if(mult.cols()==0)
+        multSegment = cal;
+    else
+        multSegment = mult;
 //        fclose(fid);
 
     times = MatrixXd(1, to-from+1);
@@ -453,357 +532,332 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
 
 //*************************************************************************************************************
 
-bool FiffRawData::read_raw_segment(MatrixXd& data,
-                                   MatrixXd& times,
-                                   SparseMatrix<double>& multSegment,
-                                   fiff_int_t from,
-                                   fiff_int_t to,
-                                   const RowVectorXi& sel,
-                                   bool do_debug) const
+bool FiffRawData::read_raw_segment_times(MatrixXd& data,
+                                         MatrixXd& times,
+                                         float from,
+                                         float to,
+                                         const RowVectorXi& sel) const
 {
-    bool projAvailable = true;
-
-    if (this->proj.size() == 0) {
-        qDebug() << "FiffRawData::read_raw_segment - No projectors set";
-        projAvailable = false;
-    }
-
-    if(from == -1)
-        from = this->first_samp;
-    if(to == -1)
-        to = this->last_samp;
     //
-    //  Initial checks
+    //   Convert to samples
     //
-    if(from < this->first_samp)
-        from = this->first_samp;
-    if(to > this->last_samp)
-        to = this->last_samp;
+    from = floor(from*this->info.sfreq);
+    to   = ceil(to*this->info.sfreq);
     //
-    if(from > to)
-    {
-        printf("No data in this range\n");
-        return false;
-    }
-    printf("Reading %d ... %d  =  %9.3f ... %9.3f secs...", from, to, ((float)from)/this->info.sfreq, ((float)to)/this->info.sfreq);
-    //
-    //  Initialize the data and calibration vector
+    //   Read it
     //
-    qint32 nchan = this->info.nchan;
-    qint32 dest  = 0;//1;
-    qint32 i, k, r;
+    return this->read_raw_segment(data, times, (qint32)from, (qint32)to, sel);
+}
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nchan);
-    for(i = 0; i < nchan; ++i)
-        tripletList.push_back(T(i, i, this->cals[i]));
 
-    SparseMatrix<double> cal(nchan, nchan);
-    cal.setFromTriplets(tripletList.begin(), tripletList.end());
-//    cal.makeCompressed();
+//*************************************************************************************************************
+
+void FiffRawData::update_operator_cache(const RowVectorXi& sel, SparseMatrix<double>& cal, SparseMatrix<double>& mult) const
+{
+    QMutexLocker locker(&m_mutexOperatorCache);
 
-    MatrixXd mult_full;
+    qint32 nchan = this->info.nchan;
+    qint32 i, k;
+
+    bool projAvailable = this->proj.size() > 0;
+    bool compAvailable = this->comp.kind != -1;
+
+    //
+    //  Compose the full operator proj*comp*cal again only if one of its inputs changed
     //
-    if (sel.size() == 0)
+    bool keyChanged = !m_bOperatorCached
+            || m_vecCachedCals.size() != this->cals.size() || m_vecCachedCals != this->cals
+            || m_matCachedProj.rows() != this->proj.rows() || m_matCachedProj.cols() != this->proj.cols() || m_matCachedProj != this->proj
+            || m_iCachedCompKind != this->comp.kind;
+
+    if(!keyChanged && compAvailable)
+        keyChanged = m_matCachedComp.rows() != this->comp.data->data.rows()
+                || m_matCachedComp.cols() != this->comp.data->data.cols()
+                || m_matCachedComp != this->comp.data->data;
+
+    if(keyChanged)
     {
-        data = MatrixXd(nchan, to-from+1);
-//            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
+        if (!projAvailable)
+            qDebug() << "FiffRawData::read_raw_segment - No projectors set";
+
+        m_vecCachedCals = this->cals;
+        m_matCachedProj = this->proj;
+        m_iCachedCompKind = this->comp.kind;
+        m_matCachedComp = compAvailable ? this->comp.data->data : MatrixXd();
+
+        if (projAvailable || compAvailable)
         {
             if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
+                m_matCachedOperator = this->comp.data->data;
+            else if (!compAvailable)
+                m_matCachedOperator = this->proj;
             else
-                mult_full = this->proj*this->comp.data->data*cal;
+                m_matCachedOperator = this->proj*this->comp.data->data;
+            for(k = 0; k < nchan; ++k)
+                m_matCachedOperator.col(k) *= this->cals[k];
+        }
+        else
+        {
+            m_matCachedOperator = MatrixXd();
         }
+
+        m_bOperatorCached = true;
     }
-    else
+    else if(m_vecCachedSel.size() == sel.size() && m_vecCachedSel == sel)
     {
-        data = MatrixXd(sel.size(),to-from+1);
-//            data->setZero();
-
-        MatrixXd selVect(sel.size(), nchan);
-
-        selVect.setZero();
+        //
+        //  Nothing changed -> the row selected operators are still valid
+        //
+        cal = m_matCachedCal;
+        mult = m_matCachedMult;
+        return;
+    }
 
-        if (!projAvailable && this->comp.kind == -1)
-        {
-            tripletList.clear();
-            tripletList.reserve(sel.size());
-            for(i = 0; i < sel.size(); ++i)
-                tripletList.push_back(T(i, i, this->cals[sel[i]]));
-            cal = SparseMatrix<double>(sel.size(), sel.size());
-            cal.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-        else
-        {
-            if (!projAvailable)
-            {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+    m_vecCachedSel = sel;
 
-                mult_full = selVect*cal;
-            }
-            else
-            {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+    typedef Eigen::Triplet<double> T;
+    std::vector<T> tripletList;
 
-                mult_full = selVect*this->comp.data->data*cal;
-            }
-        }
-    }
+    //
+    //  Calibration for the selected channels
+    //
+    qint32 nrows = sel.size() == 0 ? nchan : sel.size();
+    tripletList.reserve(nrows);
+    for(i = 0; i < nrows; ++i)
+        tripletList.push_back(T(i, i, this->cals[sel.size() == 0 ? i : sel[i]]));
+    m_matCachedCal = SparseMatrix<double>(nrows, nrows);
+    m_matCachedCal.setFromTriplets(tripletList.begin(), tripletList.end());
 
     //
-    // Make mult sparse
+    //  Make the row selected operator sparse
     //
+    m_matCachedMult = SparseMatrix<double>();
+    if (m_matCachedOperator.size() == 0)
+    {
+        cal = m_matCachedCal;
+        mult = m_matCachedMult;
+        return;
+    }
+
     tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
+    for(i = 0; i < nrows; ++i)
+    {
+        qint32 row = sel.size() == 0 ? i : sel[i];
+        for(k = 0; k < nchan; ++k)
+            if(m_matCachedOperator(row,k) != 0)
+                tripletList.push_back(T(i, k, m_matCachedOperator(row,k)));
+    }
 
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
+    m_matCachedMult = SparseMatrix<double>(nrows, nchan);
     if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
+        m_matCachedMult.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    cal = m_matCachedCal;
+    mult = m_matCachedMult;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawData::make_rawdir_index()
+{
+    m_vecRawDirLast.resize(rawdir.size());
+    for(qint32 k = 0; k < rawdir.size(); ++k)
+        m_vecRawDirLast[k] = rawdir[k].last;
+}
+
 
+//*************************************************************************************************************
+
+fiff_int_t FiffRawData::find_rawdir_entry(fiff_int_t sample) const
+{
+    if(m_vecRawDirLast.size() == rawdir.size())
+        return std::lower_bound(m_vecRawDirLast.constBegin(), m_vecRawDirLast.constEnd(), sample) - m_vecRawDirLast.constBegin();
+
+    //
+    //  The index is out of date -> search rawdir directly, the entries are in ascending sample order as well
     //
+    fiff_int_t lo = 0;
+    fiff_int_t hi = rawdir.size();
+    while(lo < hi)
+    {
+        fiff_int_t mid = lo + (hi - lo) / 2;
+        if(rawdir[mid].last < sample)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
 
-    FiffStream::SPtr fid;
-    if (!this->file->device()->isOpen())
+
+//*************************************************************************************************************
+
+template<typename T>
+static void delta_decode_channels(const uchar* p_pDeltas, fiff_int_t nchan, fiff_int_t nsamp, uchar* p_pOut)
+{
+    //
+    //  Undo the channel by channel differences and interleave the channels again, in big endian
+    //
+    for(fiff_int_t c = 0; c < nchan; ++c)
     {
-        if (!this->file->device()->open(QIODevice::ReadOnly))
+        T value = 0;
+        const uchar* in = p_pDeltas + (qint64)c * nsamp * sizeof(T);
+        for(fiff_int_t s = 0; s < nsamp; ++s)
         {
-            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
+            value = (T)(value + qFromBigEndian<T>(in + s * sizeof(T)));
+            qToBigEndian<T>(value, p_pOut + ((qint64)s * nchan + c) * sizeof(T));
         }
-        fid = this->file;
-    }
-    else
-    {
-        fid = this->file;
     }
+}
 
-    MatrixXd one;
-    fiff_int_t first_pick, last_pick, picksamp;
-    for(k = 0; k < this->rawdir.size(); ++k)
-    {
-        FiffRawDir thisRawDir = this->rawdir[k];
-        //
-        //  Do we need this buffer
-        //
-        if (thisRawDir.last > from)
-        {
-            if (thisRawDir.ent->kind == -1)
-            {
-                //
-                //  Take the easy route: skip is translated to zeros
-                //
-                if(do_debug)
-                    printf("S");
-                if (sel.cols() <= 0)
-                    one.resize(nchan,thisRawDir.nsamp);
-                else
-                    one.resize(sel.cols(),thisRawDir.nsamp);
 
-                one.setZero();
-            }
-            else
-            {
-                FiffTag::SPtr t_pTag;
-                fid->read_tag(t_pTag, thisRawDir.ent->pos);
-                //
-                //   Depending on the state of the projection and selection
-                //   we proceed a little bit differently
-                //
-                if (mult.cols() == 0)
-                {
-                    if (sel.cols() == 0)
-                    {
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                            one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_INT)
-                            one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                            one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_SHORT)
-                            one = cal*(Map< MatrixShort >( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else
-                            printf("Data Storage Format not known jet [1]!! Type: %d\n", t_pTag->type);
-                    }
-                    else
-                    {
+//*************************************************************************************************************
 
-                        //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
-                        MatrixXd newData(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
+bool FiffRawData::decompress_raw_buffer(const uchar* p_pData,
+                                        fiff_int_t size,
+                                        fiff_int_t nchan,
+                                        fiff_int_t& type,
+                                        QByteArray& buffer)
+{
+    if(size < 2*(fiff_int_t)sizeof(qint32) || nchan <= 0)
+        return false;
 
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
+    fiff_int_t nsamp = qFromBigEndian<qint32>(p_pData);
+    type = qFromBigEndian<qint32>(p_pData + sizeof(qint32));
 
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_INT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
+    int elsize;
+    switch(type)
+    {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            elsize = 2;
+            break;
+        case FIFFT_INT:
+        case FIFFT_FLOAT:
+            elsize = 4;
+            break;
+        default:
+            return false;
+    }
 
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+    QByteArray deltas = qUncompress(p_pData + 2*sizeof(qint32), size - 2*sizeof(qint32));
+    if(nsamp < 0 || deltas.size() != elsize * nchan * nsamp)
+        return false;
 
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_SHORT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixShort > ( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
+    buffer.resize(deltas.size());
+    if(elsize == 2)
+        delta_decode_channels<quint16>((const uchar*)deltas.constData(), nchan, nsamp, (uchar*)buffer.data());
+    else
+        delta_decode_channels<quint32>((const uchar*)deltas.constData(), nchan, nsamp, (uchar*)buffer.data());
 
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else
-                        {
-                            printf("Data Storage Format not known jet [2]!! Type: %d\n", t_pTag->type);
-                        }
+    return true;
+}
 
-                        one = cal*newData;
-                    }
-                }
-                else
-                {
-                    if (t_pTag->type == FIFFT_DAU_PACK16)
-                        one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_INT)
-                        one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_FLOAT)
-                        one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else
-                        printf("Data Storage Format not known jet [3]!! Type: %d\n", t_pTag->type);
-                }
-            }
-            //
-            //  The picking logic is a bit complicated
-            //
-            if (to >= thisRawDir.last && from <= thisRawDir.first)
-            {
-                //
-                //  We need the whole buffer
-                //
-                first_pick = 0;//1;
-                last_pick  = thisRawDir.nsamp - 1;
-                if (do_debug)
-                    printf("W");
-            }
-            else if (from > thisRawDir.first)
-            {
-                first_pick = from - thisRawDir.first;// + 1;
-                if(to < thisRawDir.last)
-                {
-                    //
-                    //  Something from the middle
-                    //
-//                    qDebug() << "This needs to be debugged!";
-                    last_pick = thisRawDir.nsamp + to - thisRawDir.last - 1;//is this alright?
-                    if (do_debug)
-                        printf("M");
-                }
-                else
-                {
-                    //
-                    //  From the middle to the end
-                    //
-                    last_pick = thisRawDir.nsamp - 1;
-                    if (do_debug)
-                        printf("E");
-                }
-            }
-            else
-            {
-                //
-                //  From the beginning to the middle
-                //
-                first_pick = 0;//1;
-                last_pick  = to - thisRawDir.first;// + 1;
-                if (do_debug)
-                    printf("B");
-            }
-            //
-            //  Now we are ready to pick
-            //
-            picksamp = last_pick - first_pick + 1;
 
-            if(do_debug)
-            {
-                qDebug() << "first_pick: " << first_pick;
-                qDebug() << "last_pick: " << last_pick;
-                qDebug() << "picksamp: " << picksamp;
-            }
+//*************************************************************************************************************
+//=============================================================================================================
+// Readers for big endian raw data samples used by decode_raw_buffer
+//=============================================================================================================
 
-            if (picksamp > 0)
-            {
-//                    for(r = 0; r < data->rows(); ++r)
-//                        for(c = 0; c < picksamp; ++c)
-//                            (*data)(r,dest + c) = one(r,first_pick + c);
-                data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+struct BigEndianShort
+{
+    enum { Bytes = 2 };
+    static inline double value(const uchar* p) { return qFromBigEndian<qint16>(p); }
+};
 
-                dest += picksamp;
-            }
-        }
-        //
-        //  Done?
-        //
-        if (thisRawDir.last >= to)
-        {
-            printf(" [done]\n");
-            break;
-        }
+struct BigEndianInt
+{
+    enum { Bytes = 4 };
+    static inline double value(const uchar* p) { return qFromBigEndian<qint32>(p); }
+};
+
+struct BigEndianFloat
+{
+    enum { Bytes = 4 };
+    static inline double value(const uchar* p)
+    {
+        quint32 bits = qFromBigEndian<quint32>(p);
+        float value;
+        memcpy(&value, &bits, sizeof(float));
+        return value;
     }
+};
 
-    if(mult.cols()==0)
-        multSegment = cal;
-    else
-        multSegment = mult;
-//        fclose(fid);
 
-    times = MatrixXd(1, to-from+1);
+//*************************************************************************************************************
 
-    for (i = 0; i < times.cols(); ++i)
-        times(0, i) = ((float)(from+i)) / this->info.sfreq;
+template<class Reader>
+static void decode_raw_columns(const uchar* p_pData,
+                               fiff_int_t nchan,
+                               fiff_int_t first_pick,
+                               fiff_int_t picksamp,
+                               const RowVectorXi& sel,
+                               const double* scale,
+                               MatrixXd& dest,
+                               fiff_int_t destCol)
+{
+    const fiff_int_t nrows = sel.size() > 0 ? sel.size() : nchan;
 
-    return true;
+    for(fiff_int_t s = 0; s < picksamp; ++s)
+    {
+        const uchar* column = p_pData + (qint64)(first_pick + s) * nchan * Reader::Bytes;
+        double* out = dest.data() + (qint64)(destCol + s) * dest.rows();
+
+        for(fiff_int_t r = 0; r < nrows; ++r)
+        {
+            const fiff_int_t ch = sel.size() > 0 ? sel[r] : r;
+            const double value = Reader::value(column + ch * Reader::Bytes);
+            out[r] = scale ? scale[ch] * value : value;
+        }
+    }
 }
 
 
 //*************************************************************************************************************
 
-bool FiffRawData::read_raw_segment_times(MatrixXd& data,
-                                         MatrixXd& times,
-                                         float from,
-                                         float to,
-                                         const RowVectorXi& sel) const
+bool FiffRawData::decode_raw_buffer(const uchar* p_pData,
+                                    fiff_int_t size,
+                                    fiff_int_t type,
+                                    fiff_int_t nchan,
+                                    fiff_int_t first_pick,
+                                    fiff_int_t picksamp,
+                                    const RowVectorXi& sel,
+                                    const double* scale,
+                                    MatrixXd& dest,
+                                    fiff_int_t destCol)
 {
-    //
-    //   Convert to samples
-    //
-    from = floor(from*this->info.sfreq);
-    to   = ceil(to*this->info.sfreq);
-    //
-    //   Read it
-    //
-    return this->read_raw_segment(data, times, (qint32)from, (qint32)to, sel);
+    fiff_int_t bytes;
+    switch(type)
+    {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            bytes = BigEndianShort::Bytes;
+            break;
+        case FIFFT_INT:
+        case FIFFT_FLOAT:
+            bytes = BigEndianInt::Bytes;
+            break;
+        default:
+            return false;
+    }
+
+    if (!p_pData || first_pick < 0 || picksamp < 0 || size < 0 || (qint64)(first_pick + picksamp) * nchan * bytes > size)
+        return false;
+
+    switch(type)
+    {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            decode_raw_columns<BigEndianShort>(p_pData, nchan, first_pick, picksamp, sel, scale, dest, destCol);
+            return true;
+        case FIFFT_INT:
+            decode_raw_columns<BigEndianInt>(p_pData, nchan, first_pick, picksamp, sel, scale, dest, destCol);
+            return true;
+        case FIFFT_FLOAT:
+            decode_raw_columns<BigEndianFloat>(p_pData, nchan, first_pick, picksamp, sel, scale, dest, destCol);
+            return true;
+        default:
+            return false;
+    }
 }
@@ -62,7 +62,9 @@
 //=============================================================================================================
 
 #include <QList>
+#include <QMutex>
 #include <QSharedPointer>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -110,6 +112,16 @@ public:
     */
     FiffRawData(const FiffRawData &p_FiffRawData);
 
+    //=========================================================================================================
+    /**
+    * Assignment operator. The operator cache is not copied, it is composed again by the next read.
+    *
+    * @param[in] p_FiffRawData  FIFF raw measurement which should be assigned
+    *
+    * @return this FIFF raw measurement
+    */
+    FiffRawData& operator= (const FiffRawData &p_FiffRawData);
+
     //=========================================================================================================
     /**
     * Constructs fiff raw data, by reading from a IO device.
@@ -130,6 +142,13 @@ public:
     */
     void clear();
 
+    //=========================================================================================================
+    /**
+    * Drops the cached calibration, projection and compensation operator. read_raw_segment detects changes of
+    * proj, comp and cals by itself, this only releases the memory held by the cache.
+    */
+    void clear_operator_cache();
+
     //=========================================================================================================
     /**
     * True if fiff raw data are empty.
@@ -175,6 +194,9 @@ public:
     * @param[in] to         last sample to include. If omitted, defaults to the last sample in data (optional)
     * @param[in] sel        channel selection vector (optional)
     *
+    * Note: If the file was memory mapped beforehand (file->map_file()) the buffers are decoded straight from
+    * the mapped file without allocating intermediate tags.
+    *
     * @return true if succeeded, false otherwise
     */
     bool read_raw_segment(MatrixXd& data,
@@ -205,6 +227,85 @@ public:
                                 float to,
                                 const RowVectorXi& sel = defaultRowVectorXi) const;
 
+    //=========================================================================================================
+    /**
+    * Builds the sample index over rawdir, which allows read_raw_segment to locate the first buffer of a segment
+    * by binary search. setup_read_raw calls this, it has to be called again whenever rawdir is modified.
+    */
+    void make_rawdir_index();
+
+    //=========================================================================================================
+    /**
+    * Locates the raw directory entry containing the given sample in O(log n).
+    *
+    * @param[in] sample     The sample of interest
+    *
+    * @return the index of the first rawdir entry whose last sample is >= sample, rawdir.size() if there is none
+    */
+    fiff_int_t find_rawdir_entry(fiff_int_t sample) const;
+
+    //=========================================================================================================
+    /**
+    * Decodes the samples first_pick ... first_pick+picksamp-1 of a big endian raw data buffer payload
+    * (e.g. a view into a memory mapped file) straight into the columns destCol ... of dest.
+    *
+    * @param[in] p_pData        The buffer payload, nchan x nsamp in file byte order
+    * @param[in] size           Size of the payload in bytes
+    * @param[in] type           The buffer data type (FIFFT_DAU_PACK16, FIFFT_SHORT, FIFFT_INT or FIFFT_FLOAT)
+    * @param[in] nchan          Number of channels stored in the buffer
+    * @param[in] first_pick     First sample of the buffer to decode
+    * @param[in] picksamp       Number of samples to decode
+    * @param[in] sel            Channel selection vector, empty for all channels
+    * @param[in] scale          Per channel scaling (indexed by the buffer channel), NULL for no scaling
+    * @param[out] dest          The destination matrix, has to provide sel.size() (or nchan) rows
+    * @param[in] destCol        First column of dest to write to
+    *
+    * @return true if the data type is supported and the payload holds the samples, false otherwise
+    */
+    static bool decode_raw_buffer(const uchar* p_pData,
+                                  fiff_int_t size,
+                                  fiff_int_t type,
+                                  fiff_int_t nchan,
+                                  fiff_int_t first_pick,
+                                  fiff_int_t picksamp,
+                                  const RowVectorXi& sel,
+                                  const double* scale,
+                                  MatrixXd& dest,
+                                  fiff_int_t destCol);
+
+private:
+    //=========================================================================================================
+    /**
+    * Composes the calibration, projection and compensation operator (proj*comp*cal) and its row selected sparse
+    * version for the given channel selection. The result is cached and only recomputed when proj, comp, cals
+    * or the selection differ from the ones used for the cached version. The cache is guarded by a mutex and the
+    * operators are handed out as copies, so several threads can read segments at the same time.
+    *
+    * @param[in] sel    Channel selection vector, empty for all channels
+    * @param[out] cal   Calibration of the selected channels
+    * @param[out] mult  Row selected sparse operator, empty if neither proj nor comp are set
+    */
+    void update_operator_cache(const RowVectorXi& sel, SparseMatrix<double>& cal, SparseMatrix<double>& mult) const;
+
+    //=========================================================================================================
+    /**
+    * Decompresses a FIFFT_DELTA_ZLIB buffer payload into the equivalent uncompressed big endian payload, which
+    * can be handed to decode_raw_buffer.
+    *
+    * @param[in] p_pData        The compressed buffer payload
+    * @param[in] size           Size of the payload in bytes
+    * @param[in] nchan          Number of channels stored in the buffer
+    * @param[out] type          The data type of the uncompressed buffer
+    * @param[out] buffer        The uncompressed buffer payload, nchan x nsamp in file byte order
+    *
+    * @return true if the payload could be decompressed, false otherwise
+    */
+    static bool decompress_raw_buffer(const uchar* p_pData,
+                                      fiff_int_t size,
+                                      fiff_int_t nchan,
+                                      fiff_int_t& type,
+                                      QByteArray& buffer);
+
 public:
     FiffStream::SPtr file;      /**< replaces fid */
     FiffInfo info;              /**< Fiff measurement information */
@@ -214,6 +315,20 @@ public:
     QList<FiffRawDir> rawdir;   /**< Special fiff diretory entry for raw data. */
     MatrixXd proj;              /**< SSP operator to apply to the data. */
     FiffCtfComp comp;           /**< Compensator. */
+
+private:
+    QVector<fiff_int_t> m_vecRawDirLast;    /**< Last sample of each rawdir entry (ascending), used for the binary search in find_rawdir_entry. */
+
+    mutable QMutex                  m_mutexOperatorCache;   /**< Guards the cached operator members below. */
+    mutable bool                    m_bOperatorCached;      /**< Whether the cached operator below is valid. */
+    mutable RowVectorXd             m_vecCachedCals;        /**< cals the cached operator was composed with. */
+    mutable MatrixXd                m_matCachedProj;        /**< proj the cached operator was composed with. */
+    mutable fiff_int_t              m_iCachedCompKind;      /**< comp.kind the cached operator was composed with. */
+    mutable MatrixXd                m_matCachedComp;        /**< comp data the cached operator was composed with. */
+    mutable RowVectorXi             m_vecCachedSel;         /**< Channel selection of m_matCachedCal and m_matCachedMult. */
+    mutable MatrixXd                m_matCachedOperator;    /**< The composed proj*comp*cal operator (all channels), empty if neither proj nor comp are set. */
+    mutable SparseMatrix<double>    m_matCachedCal;         /**< Calibration of the selected channels. */
+    mutable SparseMatrix<double>    m_matCachedMult;        /**< Row selected sparse version of m_matCachedOperator. */
 };
 
 } // NAMESPACE
@@ -0,0 +1,311 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_recorder.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawRecorder class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_recorder.h"
+#include "fiff_file.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawRecorder::FiffRawRecorder(int iMaxQueueSize, QObject *parent)
+: QThread(parent)
+, m_iMaxQueueSize(qMax(iMaxQueueSize, 1))
+, m_iMaxQueueDepth(0)
+, m_iDroppedBlocks(0)
+, m_iWrittenBlocks(0)
+, m_bIsRecording(false)
+, m_bApplyCals(true)
+, m_bResetRange(false)
+, m_iDataType(FIFFT_FLOAT)
+, m_iMaxFileSize(FIFF_RAW_RECORDER_MAX_FILE_SIZE)
+, m_iFileDataSize(0)
+, m_iSplitCount(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+FiffRawRecorder::~FiffRawRecorder()
+{
+    stopRecording();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::startRecording(const QString& sFileName,
+                                     const FiffInfo& info,
+                                     bool bApplyCals,
+                                     qint64 iMaxFileSize,
+                                     const MatrixXi& sel,
+                                     bool bResetRange,
+                                     fiff_int_t iDataType)
+{
+    if(isRunning()) {
+        printf("FiffRawRecorder::startRecording - A recording is already running.\n");
+        return false;
+    }
+
+    m_info = info;
+    m_sel = sel;
+    m_bApplyCals = bApplyCals;
+    m_bResetRange = bResetRange;
+    m_iDataType = iDataType;
+    m_sFileName = sFileName;
+    m_iMaxFileSize = iMaxFileSize;
+    m_iFileDataSize = 0;
+    m_iSplitCount = 0;
+
+    m_file.setFileName(m_sFileName);
+    m_pOutfid = FiffStream::start_writing_raw(m_file, m_info, m_cals, m_sel, m_bResetRange, m_iDataType);
+    if(!m_pOutfid)
+        return false;
+
+    fiff_int_t first = 0;
+    m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+
+    m_mutex.lock();
+    m_queue.clear();
+    m_iMaxQueueDepth = 0;
+    m_iDroppedBlocks = 0;
+    m_iWrittenBlocks = 0;
+    m_bIsRecording = true;
+    m_mutex.unlock();
+
+    start();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawRecorder::stopRecording()
+{
+    m_mutex.lock();
+    m_bIsRecording = false;
+    m_condNewData.wakeAll();
+    m_mutex.unlock();
+
+    wait();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::append(const MatrixXd& matData)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if(!m_bIsRecording)
+        return false;
+
+    if(m_queue.size() >= m_iMaxQueueSize) {
+        ++m_iDroppedBlocks;
+        return false;
+    }
+
+    m_queue.enqueue(matData);
+    m_iMaxQueueDepth = qMax(m_iMaxQueueDepth, m_queue.size());
+    m_condNewData.wakeOne();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::isRecording() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_bIsRecording;
+}
+
+
+//*************************************************************************************************************
+
+int FiffRawRecorder::queueDepth() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_queue.size();
+}
+
+
+//*************************************************************************************************************
+
+int FiffRawRecorder::maxQueueDepth() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_iMaxQueueDepth;
+}
+
+
+//*************************************************************************************************************
+
+qint64 FiffRawRecorder::droppedBlocks() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_iDroppedBlocks;
+}
+
+
+//*************************************************************************************************************
+
+qint64 FiffRawRecorder::writtenBlocks() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_iWrittenBlocks;
+}
+
+
+//*************************************************************************************************************
+
+int FiffRawRecorder::splitCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_iSplitCount;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawRecorder::run()
+{
+    MatrixXd matData;
+
+    forever {
+        m_mutex.lock();
+        while(m_queue.isEmpty() && m_bIsRecording)
+            m_condNewData.wait(&m_mutex);
+
+        if(m_queue.isEmpty()) {
+            //Stopped and everything is written
+            m_mutex.unlock();
+            break;
+        }
+
+        matData = m_queue.dequeue();
+        m_mutex.unlock();
+
+        qint64 iDataSize = matData.rows()*matData.cols()*(m_iDataType == FIFFT_SHORT || m_iDataType == FIFFT_DAU_PACK16 ? 2 : 4);
+
+        if(m_iMaxFileSize > 0 && m_iFileDataSize > 0 && m_iFileDataSize + iDataSize > m_iMaxFileSize) {
+            if(!splitFile()) {
+                printf("FiffRawRecorder::run - Could not start the next file. Recording stopped.\n");
+                m_mutex.lock();
+                m_iDroppedBlocks += m_queue.size() + 1;
+                m_queue.clear();
+                m_bIsRecording = false;
+                m_mutex.unlock();
+                return;
+            }
+        }
+
+        if(m_bApplyCals) {
+            m_pOutfid->write_raw_buffer(matData, m_cals);
+        } else {
+            m_pOutfid->write_raw_buffer(matData);
+        }
+        m_iFileDataSize += iDataSize;
+
+        m_mutex.lock();
+        ++m_iWrittenBlocks;
+        m_mutex.unlock();
+    }
+
+    m_pOutfid->finish_writing_raw();
+    m_pOutfid.clear();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::splitFile()
+{
+    m_mutex.lock();
+    int iSplitCount = ++m_iSplitCount;
+    m_mutex.unlock();
+
+    QString sNextFileName = m_sFileName;
+    sNextFileName.remove("_raw.fif");
+    sNextFileName += QString("-%1_raw.fif").arg(iSplitCount);
+
+    //Write the link to the next file
+    qint32 data;
+    m_pOutfid->start_block(FIFFB_REF);
+    data = FIFFV_ROLE_NEXT_FILE;
+    m_pOutfid->write_int(FIFF_REF_ROLE, &data);
+    m_pOutfid->write_string(FIFF_REF_FILE_NAME, sNextFileName);
+    m_pOutfid->write_id(FIFF_REF_FILE_ID);//ToDo meas_id
+    data = iSplitCount - 1;
+    m_pOutfid->write_int(FIFF_REF_FILE_NUM, &data);
+    m_pOutfid->end_block(FIFFB_REF);
+
+    //Finish the current file
+    m_pOutfid->finish_writing_raw();
+
+    //Start the next file
+    m_file.setFileName(sNextFileName);
+    m_pOutfid = FiffStream::start_writing_raw(m_file, m_info, m_cals, m_sel, m_bResetRange, m_iDataType);
+    if(!m_pOutfid)
+        return false;
+
+    fiff_int_t first = 0;
+    m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+    m_iFileDataSize = 0;
+
+    emit fileSplit(sNextFileName);
+
+    return true;
+}
@@ -0,0 +1,253 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_recorder.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawRecorder class declaration.
+*
+*/
+
+#ifndef FIFF_RAW_RECORDER_H
+#define FIFF_RAW_RECORDER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_info.h"
+#include "fiff_stream.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QFile>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+#define FIFF_RAW_RECORDER_MAX_FILE_SIZE   2000000000L   /**< Default number of data bytes after which a recording is split into a new file. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+
+//=============================================================================================================
+/**
+* Records raw data blocks to fiff files in a dedicated writer thread. Acquisition threads hand over their data
+* blocks with append, which never blocks on disk I/O. The blocks are kept in a bounded queue and written by the
+* recorder thread, which also applies the calibration and rolls over to a new file once the maximal file size
+* is reached. When the queue is full, incoming blocks are dropped and counted.
+*
+* @brief Asynchronous raw data recorder.
+*/
+class FIFFSHARED_EXPORT FiffRawRecorder : public QThread
+{
+    Q_OBJECT
+
+public:
+    typedef QSharedPointer<FiffRawRecorder> SPtr;            /**< Shared pointer type for FiffRawRecorder. */
+    typedef QSharedPointer<const FiffRawRecorder> ConstSPtr; /**< Const shared pointer type for FiffRawRecorder. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a FiffRawRecorder.
+    *
+    * @param[in] iMaxQueueSize  Maximal number of data blocks waiting to be written
+    * @param[in] parent         Parent QObject (optional)
+    */
+    explicit FiffRawRecorder(int iMaxQueueSize = 64, QObject *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the FiffRawRecorder. A running recording is stopped and its file is finished.
+    */
+    ~FiffRawRecorder();
+
+    //=========================================================================================================
+    /**
+    * Creates the first file of a recording, writes the measurement info and starts the writer thread.
+    *
+    * @param[in] sFileName      Name of the first file. Split files are named <name>-<n>_raw.fif.
+    * @param[in] info           The measurement info to write
+    * @param[in] bApplyCals     Whether to divide the data by the channel calibrations before writing
+    * @param[in] iMaxFileSize   Number of data bytes after which a new file is started, 0 disables splitting
+    * @param[in] sel            Which channels are included in the files (optional)
+    * @param[in] bResetRange    Flag if the channel range is to be resetted to 1.0f, see FiffStream::start_writing_raw
+    * @param[in] iDataType      Storage type of the raw buffers, see FiffStream::start_writing_raw
+    *
+    * @return true if the file could be created, false otherwise
+    */
+    bool startRecording(const QString& sFileName,
+                        const FiffInfo& info,
+                        bool bApplyCals = true,
+                        qint64 iMaxFileSize = FIFF_RAW_RECORDER_MAX_FILE_SIZE,
+                        const Eigen::MatrixXi& sel = defaultMatrixXi,
+                        bool bResetRange = false,
+                        fiff_int_t iDataType = FIFFT_FLOAT);
+
+    //=========================================================================================================
+    /**
+    * Stops accepting new blocks, waits until the writer thread has written all queued blocks and finishes the
+    * current file.
+    */
+    void stopRecording();
+
+    //=========================================================================================================
+    /**
+    * Hands a data block over to the writer thread. Never blocks on disk I/O.
+    *
+    * @param[in] matData    The data block (channels x samples) to record
+    *
+    * @return true if the block was queued, false if it was dropped because the queue is full or no recording is running
+    */
+    bool append(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+    * Returns whether a recording is running.
+    *
+    * @return true if recording, false otherwise
+    */
+    bool isRecording() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of blocks currently waiting to be written.
+    *
+    * @return the current queue depth
+    */
+    int queueDepth() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the largest queue depth observed since the recording was started.
+    *
+    * @return the maximal queue depth
+    */
+    int maxQueueDepth() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of blocks dropped because the queue was full since the recording was started.
+    *
+    * @return the number of dropped blocks
+    */
+    qint64 droppedBlocks() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of blocks written since the recording was started.
+    *
+    * @return the number of written blocks
+    */
+    qint64 writtenBlocks() const;
+
+    //=========================================================================================================
+    /**
+    * Returns how often the recording was split into a new file.
+    *
+    * @return the split count
+    */
+    int splitCount() const;
+
+signals:
+    //=========================================================================================================
+    /**
+    * Emitted from the writer thread whenever the recording rolled over to a new file.
+    *
+    * @param[in] sFileName  Name of the new file
+    */
+    void fileSplit(const QString& sFileName);
+
+protected:
+    //=========================================================================================================
+    /**
+    * The writer loop. Dequeues and writes blocks until the recording is stopped and the queue is empty.
+    */
+    virtual void run();
+
+private:
+    //=========================================================================================================
+    /**
+    * Writes the reference to the next file, finishes the current file and starts the next one.
+    *
+    * @return true if the next file could be created, false otherwise
+    */
+    bool splitFile();
+
+    mutable QMutex              m_mutex;            /**< Guards the queue and the counters. */
+    QWaitCondition              m_condNewData;      /**< Signals the writer thread that a block is waiting or the recording stopped. */
+    QQueue<Eigen::MatrixXd>     m_queue;            /**< Blocks waiting to be written. */
+
+    int                         m_iMaxQueueSize;    /**< Maximal number of queued blocks. */
+    int                         m_iMaxQueueDepth;   /**< Largest observed queue depth. */
+    qint64                      m_iDroppedBlocks;   /**< Number of dropped blocks. */
+    qint64                      m_iWrittenBlocks;   /**< Number of written blocks. */
+    bool                        m_bIsRecording;     /**< Whether new blocks are accepted. */
+
+    FiffInfo                    m_info;             /**< The measurement info written to each file. */
+    Eigen::MatrixXi             m_sel;              /**< The selected channels. */
+    Eigen::RowVectorXd          m_cals;             /**< The calibrations of the selected channels. */
+    bool                        m_bApplyCals;       /**< Whether the data is divided by the calibrations before writing. */
+    bool                        m_bResetRange;      /**< Whether the channel ranges are reset to 1.0f. */
+    fiff_int_t                  m_iDataType;        /**< Storage type of the raw buffers. */
+
+    QString                     m_sFileName;        /**< Name of the first file of the recording. */
+    QFile                       m_file;             /**< The file currently written. */
+    FiffStream::SPtr            m_pOutfid;          /**< The stream currently written. */
+    qint64                      m_iMaxFileSize;     /**< Number of data bytes after which the recording is split. */
+    qint64                      m_iFileDataSize;    /**< Number of data bytes written to the current file. */
+    int                         m_iSplitCount;      /**< Number of splits. */
+};
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_RECORDER_H
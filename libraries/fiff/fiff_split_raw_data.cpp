@@ -0,0 +1,296 @@
+//=============================================================================================================
+/**
+* @file     fiff_split_raw_data.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffSplitRawData class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_split_raw_data.h"
+#include "fiff_file.h"
+#include "fiff_tag.h"
+#include "fiff_dir_node.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFileInfo>
+#include <QDir>
+#include <QSet>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffSplitRawData::FiffSplitRawData()
+: first_samp(-1)
+, last_samp(-1)
+{
+}
+
+
+//*************************************************************************************************************
+
+FiffSplitRawData::FiffSplitRawData(const QString& sFileName)
+: first_samp(-1)
+, last_samp(-1)
+{
+    QSet<QString> visited;
+    QString sCurrent = sFileName;
+
+    while(!sCurrent.isEmpty()) {
+        QFileInfo fileInfo(sCurrent);
+        QString sCanonical = fileInfo.canonicalFilePath();
+        if(sCanonical.isEmpty()) {
+            printf("FiffSplitRawData - Could not find part %s.\n", sCurrent.toUtf8().constData());
+            break;
+        }
+        if(visited.contains(sCanonical)) {
+            printf("FiffSplitRawData - %s is referenced twice, the reference chain is cyclic.\n", sCurrent.toUtf8().constData());
+            break;
+        }
+        visited.insert(sCanonical);
+
+        QSharedPointer<QFile> pFile(new QFile(sCurrent));
+        FiffRawData::SPtr pPart(new FiffRawData);
+        if(!FiffStream::setup_read_raw(*pFile, *pPart)) {
+            printf("FiffSplitRawData - Could not read part %s.\n", sCurrent.toUtf8().constData());
+            break;
+        }
+
+        //
+        //  The parts are placed back to back. Some writers restart the sample count in each part.
+        //
+        fiff_int_t partFirst;
+        if(parts.isEmpty()) {
+            info = pPart->info;
+            first_samp = pPart->first_samp;
+            partFirst = first_samp;
+        }
+        else {
+            if(pPart->info.nchan != info.nchan || pPart->info.sfreq != info.sfreq) {
+                printf("FiffSplitRawData - The channels or the sampling frequency of part %s do not match.\n", sCurrent.toUtf8().constData());
+                break;
+            }
+            partFirst = last_samp + 1;
+        }
+        last_samp = partFirst + pPart->last_samp - pPart->first_samp;
+
+        m_lFiles.append(pFile);
+        parts.append(pPart);
+        part_first_samp.append(partFirst);
+
+        sCurrent = next_file_name(*pPart, sCurrent);
+    }
+
+    if(!parts.isEmpty())
+        printf("FiffSplitRawData - Read %d part(s) with samples %d ... %d.\n", parts.size(), first_samp, last_samp);
+}
+
+
+//*************************************************************************************************************
+
+FiffSplitRawData::~FiffSplitRawData()
+{
+    //
+    //  The parts refer to the files, release them first
+    //
+    parts.clear();
+    m_lFiles.clear();
+}
+
+
+//*************************************************************************************************************
+
+void FiffSplitRawData::clear()
+{
+    info.clear();
+    first_samp = -1;
+    last_samp = -1;
+    parts.clear();
+    part_first_samp.clear();
+    m_lFiles.clear();
+}
+
+
+//*************************************************************************************************************
+
+qint32 FiffSplitRawData::find_part(fiff_int_t sample) const
+{
+    if(parts.isEmpty() || sample < first_samp || sample > last_samp)
+        return -1;
+
+    //
+    //  Last part starting at or before the sample
+    //
+    QVector<fiff_int_t>::const_iterator it = std::upper_bound(part_first_samp.constBegin(), part_first_samp.constEnd(), sample);
+    return static_cast<qint32>(it - part_first_samp.constBegin()) - 1;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffSplitRawData::read_raw_segment(MatrixXd& data,
+                                        MatrixXd& times,
+                                        fiff_int_t from,
+                                        fiff_int_t to,
+                                        const RowVectorXi& sel) const
+{
+    if(parts.isEmpty())
+        return false;
+
+    if(from == -1)
+        from = first_samp;
+    if(to == -1)
+        to = last_samp;
+    //
+    //  Initial checks
+    //
+    if(from < first_samp)
+        from = first_samp;
+    if(to > last_samp)
+        to = last_samp;
+    //
+    if(from > to)
+    {
+        printf("No data in this range\n");
+        return false;
+    }
+
+    qint32 nrows = sel.size() > 0 ? static_cast<qint32>(sel.size()) : info.nchan;
+    qint32 ncols = to - from + 1;
+    data.resize(nrows, ncols);
+
+    qint32 firstPart = find_part(from);
+    qint32 lastPart = find_part(to);
+
+    //
+    //  Reads the overlap of part k into its own column block of data
+    //
+    auto readPart = [&](qint32 k) -> bool {
+        fiff_int_t partLast = (k + 1 < part_first_samp.size() ? part_first_samp[k + 1] : last_samp + 1) - 1;
+        fiff_int_t globalFrom = qMax(from, part_first_samp[k]);
+        fiff_int_t globalTo = qMin(to, partLast);
+        fiff_int_t offset = parts[k]->first_samp - part_first_samp[k];
+
+        MatrixXd partData, partTimes;
+        if(!parts[k]->read_raw_segment(partData, partTimes, globalFrom + offset, globalTo + offset, sel))
+            return false;
+
+        data.block(0, globalFrom - from, nrows, globalTo - globalFrom + 1) = partData;
+        return true;
+    };
+
+    bool ok = true;
+    if(firstPart == lastPart) {
+        ok = readPart(firstPart);
+    }
+    else {
+        //
+        //  The segment spans split boundaries, each part has its own stream and is decoded concurrently
+        //
+        QList<QFuture<bool> > futures;
+        for(qint32 k = firstPart; k <= lastPart; ++k)
+            futures.append(QtConcurrent::run([&readPart, k]() { return readPart(k); }));
+
+        for(qint32 i = 0; i < futures.size(); ++i)
+            ok = futures[i].result() && ok;
+    }
+
+    if(!ok) {
+        printf("FiffSplitRawData::read_raw_segment - Could not read samples %d ... %d.\n", from, to);
+        return false;
+    }
+
+    times.resize(1, ncols);
+    for(qint32 i = 0; i < ncols; ++i)
+        times(0, i) = ((float)(from + i)) / info.sfreq;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+QString FiffSplitRawData::next_file_name(const FiffRawData& part, const QString& sFileName)
+{
+    QList<FiffDirNode::SPtr> refs = part.file->dirtree()->dir_tree_find(FIFFB_REF);
+
+    FiffTag::SPtr t_pTag;
+    for(qint32 i = 0; i < refs.size(); ++i) {
+        if(!refs[i]->find_tag(part.file.data(), FIFF_REF_ROLE, t_pTag) || *t_pTag->toInt() != FIFFV_ROLE_NEXT_FILE)
+            continue;
+        if(!refs[i]->find_tag(part.file.data(), FIFF_REF_FILE_NAME, t_pTag))
+            continue;
+
+        QString sNext = t_pTag->toString();
+        QDir dir = QFileInfo(sFileName).absoluteDir();
+
+        //
+        //  Relative names refer to the directory of the current part. Recordings which were moved still carry
+        //  the original path, fall back to the bare file name next to the current part.
+        //
+        QFileInfo nextInfo(QDir::isRelativePath(sNext) ? dir.filePath(sNext) : sNext);
+        if(!nextInfo.exists())
+            nextInfo = QFileInfo(dir.filePath(QFileInfo(sNext).fileName()));
+
+        return nextInfo.filePath();
+    }
+
+    return QString();
+}
@@ -0,0 +1,193 @@
+//=============================================================================================================
+/**
+* @file     fiff_split_raw_data.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffSplitRawData class declaration.
+*
+*/
+
+
+#ifndef FIFF_SPLIT_RAW_DATA_H
+#define FIFF_SPLIT_RAW_DATA_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_info.h"
+#include "fiff_raw_data.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+
+//=============================================================================================================
+/**
+* Raw data of a recording which was split into several files. Starting from the first file, the files are
+* linked by the FIFF_REF_FILE_NAME tags of their FIFFB_REF blocks (role FIFFV_ROLE_NEXT_FILE). The parts are
+* placed back to back, so that the recording is presented as one continuous sample range starting at the
+* first sample of the first file. Segments spanning a split boundary are read from the parts concurrently.
+*
+* @brief Split raw data.
+*/
+class FIFFSHARED_EXPORT FiffSplitRawData
+{
+public:
+    typedef QSharedPointer<FiffSplitRawData> SPtr;               /**< Shared pointer type for FiffSplitRawData. */
+    typedef QSharedPointer<const FiffSplitRawData> ConstSPtr;    /**< Const shared pointer type for FiffSplitRawData. */
+
+    //=========================================================================================================
+    /**
+    * Default constructor.
+    */
+    FiffSplitRawData();
+
+    //=========================================================================================================
+    /**
+    * Opens the first file of a split recording and follows the reference chain to all subsequent parts.
+    *
+    * @param[in] sFileName  Name of the first file
+    */
+    explicit FiffSplitRawData(const QString& sFileName);
+
+    //=========================================================================================================
+    /**
+    * Destroys the split raw data.
+    */
+    ~FiffSplitRawData();
+
+    //=========================================================================================================
+    /**
+    * Initializes the split raw data.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * True if no part could be read.
+    *
+    * @return true if empty
+    */
+    inline bool isEmpty() const;
+
+    //=========================================================================================================
+    /**
+    * Locates the part containing the given sample in O(log n).
+    *
+    * @param[in] sample     The sample of interest
+    *
+    * @return the index of the part, -1 if the sample is outside of the recording
+    */
+    qint32 find_part(fiff_int_t sample) const;
+
+    //=========================================================================================================
+    /**
+    * Reads a raw data segment of the whole recording. Parts overlapped by the segment are read concurrently.
+    * Projection and compensation are taken from the individual parts.
+    *
+    * @param[out] data      returns the data matrix (channels x samples)
+    * @param[out] times     returns the time values corresponding to the samples
+    * @param[in] from       first sample to include. If omitted, defaults to the first sample of the recording (optional)
+    * @param[in] to         last sample to include. If omitted, defaults to the last sample of the recording (optional)
+    * @param[in] sel        channel selection vector (optional)
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_raw_segment(Eigen::MatrixXd& data,
+                          Eigen::MatrixXd& times,
+                          fiff_int_t from = -1,
+                          fiff_int_t to = -1,
+                          const Eigen::RowVectorXi& sel = defaultRowVectorXi) const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Looks up the name of the file following the given part.
+    *
+    * @param[in] part       The part of interest
+    * @param[in] sFileName  The file name of the part, used to resolve relative and moved references
+    *
+    * @return the name of the next file, empty if the part is the last one
+    */
+    static QString next_file_name(const FiffRawData& part, const QString& sFileName);
+
+public:
+    FiffInfo info;                          /**< Measurement info of the first part. */
+    fiff_int_t first_samp;                  /**< First sample of the recording. */
+    fiff_int_t last_samp;                   /**< Last sample of the recording. */
+    QList<FiffRawData::SPtr> parts;         /**< The parts in recording order. */
+    QVector<fiff_int_t> part_first_samp;    /**< First sample of each part in the sample range of the recording. */
+
+private:
+    QList<QSharedPointer<QFile> > m_lFiles; /**< The files of the parts, they have to live as long as the parts. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool FiffSplitRawData::isEmpty() const
+{
+    return parts.isEmpty();
+}
+
+} // NAMESPACE
+
+#endif // FIFF_SPLIT_RAW_DATA_H
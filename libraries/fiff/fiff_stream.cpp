@@ -67,6 +67,9 @@
 #define FALSE 0
 #endif
 
+#define FIFF_DIR_CACHE_MAGIC    0x46444952  /**< "FDIR", identifies a directory cache file */
+#define FIFF_DIR_CACHE_VERSION  1
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -74,6 +77,7 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <limits>
 #include <time.h>
 
 
@@ -92,7 +96,11 @@
 //=============================================================================================================
 
 #include <QFile>
+#include <QFileDevice>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QTcpSocket>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -111,6 +119,12 @@ using namespace UTILSLIB;
 
 FiffStream::FiffStream(QIODevice *p_pIODevice)
 : QDataStream(p_pIODevice)
+, m_iRawDataType(FIFFT_FLOAT)
+, m_bCompressRaw(false)
+, m_bUseDirCache(false)
+, m_iDirPointerPos(-1)
+, m_pMappedData(NULL)
+, m_iMappedSize(0)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -122,6 +136,12 @@ FiffStream::FiffStream(QIODevice *p_pIODevice)
 
 FiffStream::FiffStream(QByteArray * a, QIODevice::OpenMode mode)
 : QDataStream(a, mode)
+, m_iRawDataType(FIFFT_FLOAT)
+, m_bCompressRaw(false)
+, m_bUseDirCache(false)
+, m_iDirPointerPos(-1)
+, m_pMappedData(NULL)
+, m_iMappedSize(0)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -303,6 +323,7 @@ bool FiffStream::open(QIODevice::OpenModeFlag mode)
     }
     m_id = t_pTag->toFiffID();
 
+    m_iDirPointerPos = this->device()->pos();
     this->read_tag(t_pTag);
     if (t_pTag->kind != FIFF_DIR_POINTER) {
         printf("Fiff::open: file does have a directory pointer");//consider throw
@@ -321,11 +342,15 @@ bool FiffStream::open(QIODevice::OpenModeFlag mode)
     * Do we have a directory or not?
     */
     if (dirpos <= 0) {  /* Must do it in the hard way... */
-        bool ok = false;
-        m_dir = this->make_dir(&ok);
-        if (!ok) {
-          qCritical ("Could not create tag directory!");
-          return false;
+        if (!m_bUseDirCache || !this->read_dir_cache(m_dir)) {
+            bool ok = false;
+            m_dir = this->make_dir(&ok);
+            if (!ok) {
+              qCritical ("Could not create tag directory!");
+              return false;
+            }
+            if (m_bUseDirCache)
+                this->write_dir_cache(m_dir);
         }
     }
     else {              /* Just read the directory */
@@ -369,6 +394,8 @@ bool FiffStream::open(QIODevice::OpenModeFlag mode)
 
 bool FiffStream::close()
 {
+    this->unmap_file();
+
     if(this->device()->isOpen())
         this->device()->close();
 
@@ -376,6 +403,89 @@ bool FiffStream::close()
 }
 
 
+//*************************************************************************************************************
+
+bool FiffStream::add_dir()
+{
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!t_pFile || !t_pFile->isWritable() || m_dir.isEmpty() || m_iDirPointerPos < 0) {
+        printf("Fiff::add_dir: the file has to be opened for reading and writing\n");
+        return false;
+    }
+
+    FiffTag::SPtr t_pTag;
+    if(!this->read_tag(t_pTag, m_iDirPointerPos) || t_pTag->kind != FIFF_DIR_POINTER)
+        return false;
+    if(*t_pTag->toInt() > 0)
+        return true; /* Already has one */
+
+    //
+    //   The directory goes right after the last complete tag. A partially written tag at the end is dropped and
+    //   trailing garbage is cut off, so that the directory only lists tags which can be read.
+    //
+    QList<FiffDirEntry::SPtr> dir = m_dir;
+    dir.removeLast(); /* terminating entry */
+
+    fiff_long_t fileSize = t_pFile->size();
+    fiff_long_t dirpos = -1;
+    while(!dir.isEmpty()) {
+        fiff_long_t tagEnd = (fiff_long_t)dir.last()->pos + FIFFC_DATA_OFFSET + dir.last()->size;
+        if(dir.last()->size >= 0 && tagEnd <= fileSize) {
+            dirpos = tagEnd;
+            break;
+        }
+        printf("Fiff::add_dir: dropping the incomplete tag %d at %d\n", dir.last()->kind, dir.last()->pos);
+        dir.removeLast();
+    }
+
+    if(dirpos < 0) {
+        printf("Fiff::add_dir: %s contains no complete tags\n", this->streamName().toUtf8().constData());
+        return false;
+    }
+
+    if(dirpos > std::numeric_limits<fiff_int_t>::max()) {
+        printf("Fiff::add_dir: %s is too large to hold a directory\n", this->streamName().toUtf8().constData());
+        return false;
+    }
+
+    if(dirpos < fileSize) {
+        this->unmap_file();
+        if(!t_pFile->resize(dirpos)) {
+            printf("Fiff::add_dir: could not truncate %s\n", this->streamName().toUtf8().constData());
+            return false;
+        }
+    }
+
+    m_dir = dir;
+
+    FiffDirEntry::SPtr t_pDirEntry = FiffDirEntry::SPtr(new FiffDirEntry);
+    t_pDirEntry->kind = FIFF_DIR;
+    t_pDirEntry->type = FIFFT_DIR_ENTRY_STRUCT;
+    t_pDirEntry->size = (dir.size()+2)*FiffDirEntry::storageSize();
+    t_pDirEntry->pos  = (fiff_int_t)dirpos;
+    dir.append(t_pDirEntry);
+
+    t_pDirEntry = FiffDirEntry::SPtr(new FiffDirEntry);
+    t_pDirEntry->kind = -1;
+    t_pDirEntry->type = -1;
+    t_pDirEntry->size = -1;
+    t_pDirEntry->pos  = -1;
+    dir.append(t_pDirEntry);
+    m_dir.append(t_pDirEntry);
+
+    this->write_dir_entries(dir, dirpos);
+    this->write_dir_pointer((fiff_int_t)dirpos, m_iDirPointerPos);
+    t_pFile->flush();
+
+    //
+    //   A cached directory of the old file state is no longer needed
+    //
+    QFile::remove(t_pFile->fileName() + ".dir");
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 FiffDirNode::SPtr FiffStream::make_subtree(QList<FiffDirEntry::SPtr> &dentry)
@@ -445,6 +555,54 @@ FiffDirNode::SPtr FiffStream::make_subtree(QList<FiffDirEntry::SPtr> &dentry)
 }
 
 
+//*************************************************************************************************************
+
+bool FiffStream::map_file()
+{
+    if(m_pMappedData)
+        return true;
+
+    QFileDevice* t_pFile = qobject_cast<QFileDevice*>(this->device());
+    if(!t_pFile) {
+        qWarning("FiffStream::map_file - Only file devices can be memory mapped.");
+        return false;
+    }
+
+    if(!t_pFile->isOpen() && !t_pFile->open(QIODevice::ReadOnly)) {
+        qWarning("FiffStream::map_file - Cannot open %s", this->streamName().toUtf8().constData());
+        return false;
+    }
+
+    qint64 size = t_pFile->size();
+    uchar* data = size > 0 ? t_pFile->map(0, size) : NULL;
+    if(!data) {
+        qWarning("FiffStream::map_file - Cannot map %s", this->streamName().toUtf8().constData());
+        return false;
+    }
+
+    m_pMappedData = data;
+    m_iMappedSize = size;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStream::unmap_file()
+{
+    if(!m_pMappedData)
+        return;
+
+    QFileDevice* t_pFile = qobject_cast<QFileDevice*>(this->device());
+    if(t_pFile)
+        t_pFile->unmap(m_pMappedData);
+
+    m_pMappedData = NULL;
+    m_iMappedSize = 0;
+}
+
+
 //*************************************************************************************************************
 
 QStringList FiffStream::read_bad_channels(const FiffDirNode::SPtr& p_Node)
@@ -1679,6 +1837,31 @@ bool FiffStream::read_tag(FiffTag::SPtr &p_pTag, fiff_long_t pos)
 }
 
 
+//*************************************************************************************************************
+
+bool FiffStream::read_tag_view(fiff_long_t pos, fiff_int_t& kind, fiff_int_t& type, fiff_int_t& size, const uchar*& p_pData) const
+{
+    p_pData = NULL;
+
+    if(!m_pMappedData || pos < 0 || pos + FIFFC_DATA_OFFSET > m_iMappedSize)
+        return false;
+
+    const uchar* header = m_pMappedData + pos;
+    kind = qFromBigEndian<qint32>(header);
+    type = qFromBigEndian<qint32>(header + 4);
+    size = qFromBigEndian<qint32>(header + 8);
+
+    if(size < 0 || pos + FIFFC_DATA_OFFSET + size > m_iMappedSize) {
+        qWarning("FiffStream::read_tag_view - Tag at %lld exceeds the mapped file (file probably damaged).", pos);
+        return false;
+    }
+
+    p_pData = header + FIFFC_DATA_OFFSET;
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool allow_maxshield)
@@ -1809,6 +1992,14 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
                 case FIFFT_INT:
                     nsamp = ent->size/(4*nchan);
                     break;
+                case FIFFT_DELTA_ZLIB:
+                    //
+                    //  The number of samples precedes the compressed chunk
+                    //
+                    if(!t_pStream->device()->seek(ent->pos + 4*sizeof(qint32)))
+                        return false;
+                    *t_pStream >> nsamp;
+                    break;
                 default:
                     printf("Cannot handle data buffers of type %d\n",ent->type);
                     return false;
@@ -1860,6 +2051,7 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
     //
     data.cals       = cals;
     data.rawdir     = rawdir;
+    data.make_rawdir_index();
     //data->proj       = [];
     //data.comp       = [];
     //
@@ -1987,12 +2179,17 @@ FiffStream::SPtr FiffStream::open_update(QIODevice &p_IODevice)
 
 //*************************************************************************************************************
 
-FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice, const FiffInfo& info, RowVectorXd& cals, MatrixXi sel, bool resetRange)
+FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice, const FiffInfo& info, RowVectorXd& cals, MatrixXi sel, bool resetRange, fiff_int_t dataType, bool compress)
 {
     //
-    //   We will always write floats
+    //   Floats unless packed integers are requested
     //
-    fiff_int_t data_type = 4;
+    if(dataType != FIFFT_FLOAT && dataType != FIFFT_INT && dataType != FIFFT_SHORT && dataType != FIFFT_DAU_PACK16)
+    {
+        printf("Cannot write raw data buffers of type %d\n", dataType);
+        return FiffStream::SPtr();
+    }
+    fiff_int_t data_type = dataType;
     qint32 k;
 
     if(sel.cols() == 0)
@@ -2013,6 +2210,10 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice, const Fiff
     //  Create the file and save the essentials
     //
     FiffStream::SPtr t_pStream = start_file(p_IODevice);//1, 2, 3
+    if(!t_pStream)
+        return t_pStream;
+    t_pStream->m_iRawDataType = dataType;
+    t_pStream->m_bCompressRaw = compress;
     t_pStream->start_block(FIFFB_MEAS);//4
     t_pStream->write_id(FIFF_BLOCK_ID);//5
     if(info.meas_id.version != -1)
@@ -2165,7 +2366,7 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice, const Fiff
             //    Scan numbers may have been messed up
             //
             chs[k].scanNo = k+1;//+1 because
-            cals[k] = chs[k].cal;
+            cals[k] = chs[k].range*chs[k].cal;
             t_pStream->write_ch_info(chs[k]);
         }
     }
@@ -2581,7 +2782,7 @@ fiff_long_t FiffStream::write_dir_entries(const QList<FiffDirEntry::SPtr> &dir,
     pos = this->device()->pos();
 
     fiff_int_t nent = dir.size();
-    fiff_int_t datasize = nent * (fiff_int_t)sizeof(FiffDirEntry);
+    fiff_int_t datasize = nent * FiffDirEntry::storageSize();
 
     *this << (qint32)FIFF_DIR;
     *this << (qint32)FIFFT_DIR_ENTRY_STRUCT;
@@ -2615,10 +2816,7 @@ fiff_long_t FiffStream::write_double(fiff_int_t kind, const double* data, fiff_i
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
-//    this->setFloatingPointPrecision(QDataStream::SinglePrecision);
-
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
+    this->write_bulk_data((const char*)data, sizeof(double), nel);
 
     return pos;
 }
@@ -2637,10 +2835,7 @@ fiff_long_t FiffStream::write_float(fiff_int_t kind, const float* data, fiff_int
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
-//    this->setFloatingPointPrecision(QDataStream::SinglePrecision);
-
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
+    this->write_bulk_data((const char*)data, sizeof(float), nel);
 
     return pos;
 }
@@ -2661,12 +2856,11 @@ fiff_long_t FiffStream::write_float_matrix(fiff_int_t kind, const MatrixXf& mat)
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
-    qint32 i, j;
     // Storage order: row-major
-    for(i = 0; i < mat.rows(); ++i)
-        for(j = 0; j < mat.cols(); ++j)
-            *this << mat(i,j);
+    Matrix<float, Dynamic, Dynamic, RowMajor> matRowMajor = mat;
+    this->write_bulk_data((const char*)matRowMajor.data(), sizeof(float), numel);
 
+    qint32 i;
     qint32 dims[3];
     dims[0] = mat.cols();
     dims[1] = mat.rows();
@@ -2995,8 +3189,7 @@ fiff_long_t FiffStream::write_int(fiff_int_t kind, const fiff_int_t* data, fiff_
     *this << (qint32)datasize;
     *this << (qint32)next;
 
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
+    this->write_bulk_data((const char*)data, sizeof(fiff_int_t), nel);
 
     return pos;
 }
@@ -3020,12 +3213,11 @@ fiff_long_t FiffStream::write_int_matrix(fiff_int_t kind, const MatrixXi& mat)
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
-    qint32 i, j;
     // Storage order: row-major
-    for(i = 0; i < mat.rows(); ++i)
-        for(j = 0; j < mat.cols(); ++j)
-            *this << mat(i,j);
+    Matrix<int, Dynamic, Dynamic, RowMajor> matRowMajor = mat;
+    this->write_bulk_data((const char*)matRowMajor.data(), sizeof(int), numel);
 
+    qint32 i;
     qint32 dims[3];
     dims[0] = mat.cols();
     dims[1] = mat.rows();
@@ -3122,8 +3314,7 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const RowVectorXd& cals)
     SparseMatrix<double> inv_calsMat(cals.cols(), cals.cols());
     inv_calsMat.setFromTriplets(tripletList.begin(), tripletList.end());
 
-    MatrixXf tmp = (inv_calsMat*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    this->write_raw_data(inv_calsMat*buf);
     return true;
 }
 
@@ -3142,8 +3333,7 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const SparseMatrix<double
       for (SparseMatrix<double>::InnerIterator it(mult,k); it; ++it)
         inv_mult.coeffRef(it.row(),it.col()) = 1/it.value();
 
-    MatrixXf tmp = (inv_mult*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    this->write_raw_data(inv_mult*buf);
     return true;
 }
 
@@ -3152,8 +3342,7 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const SparseMatrix<double
 
 bool FiffStream::write_raw_buffer(const MatrixXd& buf)
 {
-    MatrixXf tmp = buf.cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    this->write_raw_data(buf);
     return true;
 }
 
@@ -3263,3 +3452,237 @@ bool FiffStream::check_beginning(FiffTag::SPtr &p_pTag)
     //do not rewind since the data is contained in the returned tag; -> done for TCP IP reasosn, no rewind possible there
     return true;
 }
+
+
+//*************************************************************************************************************
+
+bool FiffStream::read_dir_cache(QList<FiffDirEntry::SPtr>& dir)
+{
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!t_pFile)
+        return false;
+
+    QFile t_cacheFile(t_pFile->fileName() + ".dir");
+    if(!t_cacheFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream t_cache(&t_cacheFile);
+    t_cache.setByteOrder(QDataStream::BigEndian);
+
+    qint32 magic, version, nent;
+    qint64 fileSize, modified;
+    fiff_int_t idVersion, machid0, machid1, secs, usecs;
+
+    t_cache >> magic >> version;
+    if(t_cache.status() != QDataStream::Ok || magic != FIFF_DIR_CACHE_MAGIC || version != FIFF_DIR_CACHE_VERSION)
+        return false;
+
+    //
+    //   The cache is only valid for exactly this file
+    //
+    t_cache >> fileSize >> modified;
+    t_cache >> idVersion >> machid0 >> machid1 >> secs >> usecs;
+    QFileInfo t_fileInfo(*t_pFile);
+    if(fileSize != t_pFile->size()
+            || modified != t_fileInfo.lastModified().toMSecsSinceEpoch()
+            || idVersion != m_id.version
+            || machid0 != m_id.machid[0]
+            || machid1 != m_id.machid[1]
+            || secs != m_id.time.secs
+            || usecs != m_id.time.usecs)
+        return false;
+
+    t_cache >> nent;
+    if(t_cache.status() != QDataStream::Ok || nent <= 0 || (qint64)nent*FiffDirEntry::storageSize() > t_cacheFile.size())
+        return false;
+
+    QList<FiffDirEntry::SPtr> t_dir;
+    t_dir.reserve(nent);
+    for(qint32 k = 0; k < nent; ++k) {
+        FiffDirEntry::SPtr t_pEntry = FiffDirEntry::SPtr(new FiffDirEntry);
+        t_cache >> t_pEntry->kind >> t_pEntry->type >> t_pEntry->size >> t_pEntry->pos;
+        t_dir.append(t_pEntry);
+    }
+
+    if(t_cache.status() != QDataStream::Ok)
+        return false;
+
+    dir = t_dir;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::write_dir_cache(const QList<FiffDirEntry::SPtr>& dir)
+{
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!t_pFile)
+        return false;
+
+    QFile t_cacheFile(t_pFile->fileName() + ".dir");
+    if(!t_cacheFile.open(QIODevice::WriteOnly)) {
+        printf("Cannot write the directory cache %s\n", t_cacheFile.fileName().toUtf8().constData());
+        return false;
+    }
+
+    QDataStream t_cache(&t_cacheFile);
+    t_cache.setByteOrder(QDataStream::BigEndian);
+
+    QFileInfo t_fileInfo(*t_pFile);
+
+    t_cache << (qint32)FIFF_DIR_CACHE_MAGIC << (qint32)FIFF_DIR_CACHE_VERSION;
+    t_cache << (qint64)t_pFile->size() << (qint64)t_fileInfo.lastModified().toMSecsSinceEpoch();
+    t_cache << m_id.version << m_id.machid[0] << m_id.machid[1] << m_id.time.secs << m_id.time.usecs;
+
+    t_cache << (qint32)dir.size();
+    for(qint32 k = 0; k < dir.size(); ++k)
+        t_cache << dir[k]->kind << dir[k]->type << dir[k]->size << dir[k]->pos;
+
+    return t_cache.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStream::write_raw_data(const MatrixXd& buf)
+{
+    qint64 numel = buf.rows()*buf.cols();
+
+    //
+    //   The calibrations are fixed for the whole file, report samples which do not fit into the integer type
+    //
+    if(m_iRawDataType != FIFFT_FLOAT)
+    {
+        double dMax = m_iRawDataType == FIFFT_INT ? 2147483647.0 : 32767.0;
+        double dMin = -dMax - 1.0;
+        qint64 iClipped = (buf.array().round() < dMin || buf.array().round() > dMax).count();
+
+        if(iClipped > 0)
+            qWarning("FiffStream::write_raw_data - %lld of %lld samples exceed the range of the storage type and were clipped.", iClipped, numel);
+    }
+
+    if(m_iRawDataType == FIFFT_SHORT || m_iRawDataType == FIFFT_DAU_PACK16)
+    {
+        Matrix<qint16, Dynamic, Dynamic> tmp = buf.array().round().max(-32768.0).min(32767.0).matrix().cast<qint16>();
+
+        if(m_bCompressRaw)
+        {
+            this->write_compressed_raw_data((const char*)tmp.data(), sizeof(qint16), buf.rows(), buf.cols());
+            return;
+        }
+
+        *this << (qint32)FIFF_DATA_BUFFER;
+        *this << (qint32)m_iRawDataType;
+        *this << (qint32)(2*numel);
+        *this << (qint32)FIFFV_NEXT_SEQ;
+
+        this->write_bulk_data((const char*)tmp.data(), sizeof(qint16), numel);
+    }
+    else if(m_iRawDataType == FIFFT_INT)
+    {
+        MatrixXi tmp = buf.array().round().max(-2147483648.0).min(2147483647.0).matrix().cast<int>();
+        if(m_bCompressRaw)
+            this->write_compressed_raw_data((const char*)tmp.data(), sizeof(int), buf.rows(), buf.cols());
+        else
+            this->write_int(FIFF_DATA_BUFFER, tmp.data(), numel);
+    }
+    else
+    {
+        MatrixXf tmp = buf.cast<float>();
+        if(m_bCompressRaw)
+            this->write_compressed_raw_data((const char*)tmp.data(), sizeof(float), buf.rows(), buf.cols());
+        else
+            this->write_float(FIFF_DATA_BUFFER, tmp.data(), numel);
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+static void delta_encode_channels(const char* p_pData, fiff_int_t nchan, fiff_int_t nsamp, uchar* p_pOut)
+{
+    //
+    //  Channel by channel differences of the bit patterns, in big endian. Unsigned arithmetic wraps around,
+    //  which makes the coding lossless for integers and floats alike.
+    //
+    for(fiff_int_t c = 0; c < nchan; ++c)
+    {
+        T prev = 0;
+        uchar* out = p_pOut + (qint64)c * nsamp * sizeof(T);
+        for(fiff_int_t s = 0; s < nsamp; ++s)
+        {
+            T value;
+            memcpy(&value, p_pData + ((qint64)s * nchan + c) * sizeof(T), sizeof(T));
+            qToBigEndian<T>((T)(value - prev), out + s * sizeof(T));
+            prev = value;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffStream::write_compressed_raw_data(const char* data, int elsize, fiff_int_t nchan, fiff_int_t nsamp)
+{
+    QByteArray deltas(elsize * nchan * nsamp, 0);
+    if(elsize == 2)
+        delta_encode_channels<quint16>(data, nchan, nsamp, (uchar*)deltas.data());
+    else
+        delta_encode_channels<quint32>(data, nchan, nsamp, (uchar*)deltas.data());
+
+    QByteArray chunk = qCompress(deltas);
+
+    *this << (qint32)FIFF_DATA_BUFFER;
+    *this << (qint32)FIFFT_DELTA_ZLIB;
+    *this << (qint32)(2*sizeof(qint32) + chunk.size());
+    *this << (qint32)FIFFV_NEXT_SEQ;
+
+    *this << (qint32)nsamp;
+    *this << (qint32)m_iRawDataType;
+    this->writeRawData(chunk.constData(), chunk.size());
+}
+
+
+//*************************************************************************************************************
+
+void FiffStream::write_bulk_data(const char* data, int elsize, qint64 nel)
+{
+    if(nel <= 0)
+        return;
+
+    QDataStream::ByteOrder nativeOrder = (Q_BYTE_ORDER == Q_BIG_ENDIAN) ? QDataStream::BigEndian : QDataStream::LittleEndian;
+
+    if(this->byteOrder() == nativeOrder) {
+        this->writeRawData(data, elsize*nel);
+        return;
+    }
+
+    //
+    // Convert in chunks to keep the temporary buffer small
+    //
+    const qint64 chunkSize = 65536;
+    QByteArray chunk(elsize*qMin(nel, chunkSize), 0);
+
+    for(qint64 k = 0; k < nel; k += chunkSize) {
+        qint64 n = qMin(nel - k, chunkSize);
+        memcpy(chunk.data(), data + elsize*k, elsize*n);
+
+        switch(elsize) {
+            case 2:
+                IOUtils::swap_short_array((qint16*)chunk.data(), n);
+                break;
+            case 4:
+                IOUtils::swap_int_array((qint32*)chunk.data(), n);
+                break;
+            case 8:
+                IOUtils::swap_long_array((qint64*)chunk.data(), n);
+                break;
+            default:
+                break;
+        }
+
+        this->writeRawData(chunk.constData(), elsize*n);
+    }
+}
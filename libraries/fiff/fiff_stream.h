@@ -276,6 +276,51 @@ public:
     */
     FiffDirNode::SPtr make_subtree(QList<FiffDirEntry::SPtr>& dentry);
 
+    //=========================================================================================================
+    /**
+    * Maps the underlying file into memory. Once mapped, tag payloads can be accessed through read_tag_view
+    * without copying them into a FiffTag. Only file based streams can be mapped. The device is opened
+    * read only if it is not open yet. The mapping is released by unmap_file or close.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool map_file();
+
+    //=========================================================================================================
+    /**
+    * Releases the memory mapping created by map_file. The device stays open.
+    */
+    void unmap_file();
+
+    //=========================================================================================================
+    /**
+    * Whether the underlying file is currently memory mapped
+    *
+    * @return true if the file is mapped, false otherwise
+    */
+    inline bool is_mapped() const;
+
+    //=========================================================================================================
+    /**
+    * Enables the on-disk tag directory cache. If a file without a directory is opened, open then reads the
+    * directory from the sidecar file <file name>.dir instead of scanning all tags. The sidecar is only used
+    * when the size, the modification time and the file id of the file still match, otherwise the tags are
+    * scanned and the sidecar is rewritten. Has to be set before open. Disabled by default.
+    *
+    * @param[in] enabled    Whether to use the directory cache
+    */
+    inline void set_dir_cache_enabled(bool enabled);
+
+    //=========================================================================================================
+    /**
+    * Appends the tag directory to a file which has none and lets its FIFF_DIR_POINTER point to it, so that
+    * the file opens without scanning all tags from then on. The stream has to be opened with
+    * QIODevice::ReadWrite. Files which already have a directory are left untouched.
+    *
+    * @return true if the file has a directory afterwards, false otherwise
+    */
+    bool add_dir();
+
     //=========================================================================================================
     /**
     * fiff_read_bad_channels
@@ -445,6 +490,22 @@ public:
     */
     bool read_tag(QSharedPointer<FiffTag>& p_pTag, fiff_long_t pos = -1);
 
+    //=========================================================================================================
+    /**
+    * Reads the header of the tag at pos from the memory mapped file and returns a read-only view of its payload.
+    * No FiffTag is allocated and the payload is not copied. Note: the payload stays in the big endian file
+    * byte order, it is up to the caller to convert it. Requires map_file to be called before.
+    *
+    * @param[in] pos        position of the tag inside the fif file
+    * @param[out] kind      the tag kind
+    * @param[out] type      the tag data type
+    * @param[out] size      the payload size in bytes
+    * @param[out] p_pData   pointer to the first payload byte inside the mapped file
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_tag_view(fiff_long_t pos, fiff_int_t& kind, fiff_int_t& type, fiff_int_t& size, const uchar*& p_pData) const;
+
     //=========================================================================================================
     /**
     * fiff_setup_read_raw
@@ -521,10 +582,15 @@ public:
     * @param[out] cals          Thecalibration matrix
     * @param[in] sel            Which channels will be included in the output file (optional)
     * @param[in] resetRange     Flag if the channel range is to be resetted to 1.0f (TODO: The flag was introduced due to conformity to the babyMEG system. See Limin commit from Oct 1st 2014)
+    * @param[in] dataType       Storage type of the raw buffers: FIFFT_FLOAT (default), FIFFT_INT, FIFFT_SHORT or FIFFT_DAU_PACK16.
+    *                           Integer buffers hold the data in multiples of the channel calibrations (range*cal),
+    *                           samples outside the range of the type are clipped with a warning.
+    * @param[in] compress       Flag if the raw buffers are stored as lossless delta coded, zlib compressed chunks
+    *                           (FIFFT_DELTA_ZLIB). Such files can only be read by FiffRawData.
     *
     * @return the started fiff file
     */
-    static FiffStream::SPtr start_writing_raw(QIODevice &p_IODevice, const FiffInfo& info, RowVectorXd& cals, MatrixXi sel = defaultMatrixXi, bool resetRange = false);
+    static FiffStream::SPtr start_writing_raw(QIODevice &p_IODevice, const FiffInfo& info, RowVectorXd& cals, MatrixXi sel = defaultMatrixXi, bool resetRange = false, fiff_int_t dataType = FIFFT_FLOAT, bool compress = false);
 
     //=========================================================================================================
     /**
@@ -889,6 +955,59 @@ private:
     */
     QList<FiffDirEntry::SPtr> make_dir(bool *ok=Q_NULLPTR);
 
+    //=========================================================================================================
+    /**
+    * Reads the tag directory from the sidecar cache file, see set_dir_cache_enabled.
+    *
+    * @param[out] dir   The cached directory
+    *
+    * @return true if a valid cache for this file was found, false otherwise
+    */
+    bool read_dir_cache(QList<FiffDirEntry::SPtr>& dir);
+
+    //=========================================================================================================
+    /**
+    * Writes the tag directory to the sidecar cache file, see set_dir_cache_enabled.
+    *
+    * @param[in] dir    The directory to cache
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool write_dir_cache(const QList<FiffDirEntry::SPtr>& dir);
+
+    //=========================================================================================================
+    /**
+    * Writes a raw data buffer in the storage type chosen at start_writing_raw. Integer types are rounded and
+    * clipped to their range, a warning reports how many samples were clipped. Compressed buffers are written with
+    * write_compressed_raw_data.
+    *
+    * @param[in] buf        the already calibrated buffer to write
+    */
+    void write_raw_data(const MatrixXd& buf);
+
+    //=========================================================================================================
+    /**
+    * Writes a raw data buffer as FIFFT_DELTA_ZLIB chunk. The samples of each channel are delta coded on their
+    * bit pattern, which keeps the coding lossless for all storage types, and compressed with qCompress.
+    *
+    * @param[in] data       The buffer in the storage type, nchan x nsamp in native byte order
+    * @param[in] elsize     Size of one sample in bytes (2 or 4)
+    * @param[in] nchan      Number of channels
+    * @param[in] nsamp      Number of samples
+    */
+    void write_compressed_raw_data(const char* data, int elsize, fiff_int_t nchan, fiff_int_t nsamp);
+
+    //=========================================================================================================
+    /**
+    * Writes an array of 16, 32 or 64 bit elements given in native byte order in the byte order of the stream.
+    * The data is converted in chunks with the bulk swap routines of IOUtils instead of element by element.
+    *
+    * @param[in] data       The data to write
+    * @param[in] elsize     Size of one element in bytes (2, 4 or 8)
+    * @param[in] nel        Number of elements
+    */
+    void write_bulk_data(const char* data, int elsize, qint64 nel);
+
 private:
 
 //    char         *file_name;    /**< Name of the file */ -> Use streamName() instead
@@ -897,6 +1016,12 @@ private:
     QList<FiffDirEntry::SPtr>   m_dir;  /**< This is the directory. If no directory exists, open automatically scans the file to create one. */
 //    int         nent;           /**< How many entries? */ -> Use nent() instead
     FiffDirNode::SPtr           m_dirtree; /**< Directory compiled into a tree */
+    fiff_int_t                  m_iRawDataType; /**< Storage type of the raw buffers written by write_raw_buffer */
+    bool                        m_bCompressRaw; /**< Whether write_raw_buffer writes compressed chunks */
+    bool                        m_bUseDirCache; /**< Whether open uses the sidecar directory cache for files without a directory */
+    fiff_long_t                 m_iDirPointerPos;   /**< Position of the FIFF_DIR_POINTER tag, -1 if unknown */
+    uchar*                      m_pMappedData;  /**< Start of the memory mapped file, NULL if not mapped */
+    qint64                      m_iMappedSize;  /**< Size of the memory mapped region in bytes */
 //    char        *ext_file_name; /**< Name of the file holding the external data */
 //    FILE        *ext_fd;        /**< The file descriptor of the above file if open  */
 
@@ -917,6 +1042,25 @@ private:
 
 };
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool FiffStream::is_mapped() const
+{
+    return m_pMappedData != NULL;
+}
+
+
+//*************************************************************************************************************
+
+inline void FiffStream::set_dir_cache_enabled(bool enabled)
+{
+    m_bUseDirCache = enabled;
+}
+
 } // NAMESPACE
 
 #endif // FIFF_STREAM_H
@@ -346,9 +346,7 @@ void FiffTag::convert_matrix_from_file_data(FiffTag::SPtr tag)
 {
     int ndim;
     int k;
-    int *dimp,*data,kind,np,nz;
-    float *fdata;
-    double *ddata;
+    int *dimp,kind,np,nz;
     unsigned int tsize = tag->size();
 
     if (fiff_type_fundamental(tag->type) != FIFFTS_FS_MATRIX)
@@ -388,26 +386,19 @@ void FiffTag::convert_matrix_from_file_data(FiffTag::SPtr tag)
         /*
          * Take care of the indices
         */
-        for (data = (int *)(tag->data())+nz, k = 0; k < np; k++)
-            IOUtils::swap_intp(data+k);
+        IOUtils::swap_int_array((int *)(tag->data())+nz, np);
         np = nz;
     }
     /*
      * Now convert data...
      */
     kind = fiff_type_base(tag->type);
-    if (kind == FIFFT_INT) {
-        for (data = (int *)(tag->data()), k = 0; k < np; k++)
-            IOUtils::swap_intp(data+k);
-    }
-    else if (kind == FIFFT_FLOAT) {
-        for (fdata = (float *)(tag->data()), k = 0; k < np; k++)
-            IOUtils::swap_floatp(fdata+k);
-    }
-    else if (kind == FIFFT_DOUBLE) {
-        for (ddata = (double *)(tag->data()), k = 0; k < np; k++)
-            IOUtils::swap_doublep(ddata+k);
-    }
+    if (kind == FIFFT_INT)
+        IOUtils::swap_int_array((int *)(tag->data()), np);
+    else if (kind == FIFFT_FLOAT)
+        IOUtils::swap_float_array((float *)(tag->data()), np);
+    else if (kind == FIFFT_DOUBLE)
+        IOUtils::swap_double_array((double *)(tag->data()), np);
     return;
 }
 
@@ -421,9 +412,7 @@ void FiffTag::convert_matrix_to_file_data(FiffTag::SPtr tag)
 {
     int ndim;
     int k;
-    int *dimp,*data,kind,np;
-    float *fdata;
-    double *ddata;
+    int *dimp,kind,np;
     unsigned int tsize = tag->size();
 
     if (fiff_type_fundamental(tag->type) != FIFFTS_FS_MATRIX)
@@ -465,26 +454,16 @@ void FiffTag::convert_matrix_to_file_data(FiffTag::SPtr tag)
     * Now convert data...
     */
     kind = fiff_type_base(tag->type);
-    if (kind == FIFFT_INT) {
-        for (data = (int *)(tag->data()), k = 0; k < np; k++)
-            IOUtils::swap_intp(data+k);
-    }
-    else if (kind == FIFFT_FLOAT) {
-        for (fdata = (float *)(tag->data()), k = 0; k < np; k++)
-            IOUtils::swap_floatp(fdata+k);
-    }
-    else if (kind == FIFFT_DOUBLE) {
-        for (ddata = (double *)(tag->data()), k = 0; k < np; k++)
-            IOUtils::swap_doublep(ddata+k);
-    }
-    else if (kind == FIFFT_COMPLEX_FLOAT) {
-        for (fdata = (float *)(tag->data()), k = 0; k < 2*np; k++)
-            IOUtils::swap_floatp(fdata+k);
-    }
-    else if (kind == FIFFT_COMPLEX_DOUBLE) {
-        for (ddata = (double *)(tag->data()), k = 0; k < 2*np; k++)
-            IOUtils::swap_doublep(ddata+k);
-    }
+    if (kind == FIFFT_INT)
+        IOUtils::swap_int_array((int *)(tag->data()), np);
+    else if (kind == FIFFT_FLOAT)
+        IOUtils::swap_float_array((float *)(tag->data()), np);
+    else if (kind == FIFFT_DOUBLE)
+        IOUtils::swap_double_array((double *)(tag->data()), np);
+    else if (kind == FIFFT_COMPLEX_FLOAT)
+        IOUtils::swap_float_array((float *)(tag->data()), 2*np);
+    else if (kind == FIFFT_COMPLEX_DOUBLE)
+        IOUtils::swap_double_array((double *)(tag->data()), 2*np);
     return;
 }
 
@@ -497,10 +476,7 @@ void FiffTag::convert_tag_data(FiffTag::SPtr tag, int from_endian, int to_endian
     int            k,r;//,c;
     char           *offset;
     fiff_int_t     *ithis;
-    fiff_short_t   *sthis;
-    fiff_long_t    *lthis;
     float          *fthis;
-    double         *dthis;
 //    fiffDirEntry   dethis;
 //    fiffId         idthis;
 //    fiffChInfoRec* chthis;//FiffChInfo*     chthis;//ToDo adapt parsing to the new class
@@ -534,37 +510,32 @@ void FiffTag::convert_tag_data(FiffTag::SPtr tag, int from_endian, int to_endian
     case FIFFT_JULIAN :
     case FIFFT_UINT :
         np = tag->size()/sizeof(fiff_int_t);
-        for (ithis = (fiff_int_t *)tag->data(), k = 0; k < np; k++, ithis++)
-            IOUtils::swap_intp(ithis);
+        IOUtils::swap_int_array((fiff_int_t *)tag->data(), np);
         break;
 
     case FIFFT_LONG :
     case FIFFT_ULONG :
         np = tag->size()/sizeof(fiff_long_t);
-        for (lthis = (fiff_long_t *)tag->data(), k = 0; k < np; k++, lthis++)
-            IOUtils::swap_longp(lthis);
+        IOUtils::swap_long_array((fiff_long_t *)tag->data(), np);
         break;
 
     case FIFFT_SHORT :
     case FIFFT_DAU_PACK16 :
     case FIFFT_USHORT :
         np = tag->size()/sizeof(fiff_short_t);
-        for (sthis = (fiff_short_t *)tag->data(), k = 0; k < np; k++, sthis++)
-            *sthis = IOUtils::swap_short(*sthis);
+        IOUtils::swap_short_array((fiff_short_t *)tag->data(), np);
         break;
 
     case FIFFT_FLOAT :
     case FIFFT_COMPLEX_FLOAT :
         np = tag->size()/sizeof(fiff_float_t);
-        for (fthis = (fiff_float_t *)tag->data(), k = 0; k < np; k++, fthis++)
-            IOUtils::swap_floatp(fthis);
+        IOUtils::swap_float_array((fiff_float_t *)tag->data(), np);
         break;
 
     case FIFFT_DOUBLE :
     case FIFFT_COMPLEX_DOUBLE :
         np = tag->size()/sizeof(fiff_double_t);
-        for (dthis = (fiff_double_t *)tag->data(), k = 0; k < np; k++, dthis++)
-            IOUtils::swap_doublep(dthis);
+        IOUtils::swap_double_array((fiff_double_t *)tag->data(), np);
         break;
 
     case FIFFT_OLD_PACK :
@@ -572,12 +543,9 @@ void FiffTag::convert_tag_data(FiffTag::SPtr tag, int from_endian, int to_endian
     /*
      * Offset and scale...
      */
-        IOUtils::swap_floatp(fthis+0);
-        IOUtils::swap_floatp(fthis+1);
-        sthis = (short *)(fthis+2);
+        IOUtils::swap_float_array(fthis, 2);
         np = (tag->size() - 2*sizeof(float))/sizeof(short);
-        for (k = 0; k < np; k++,sthis++)
-            *sthis = IOUtils::swap_short(*sthis);
+        IOUtils::swap_short_array((short *)(fthis+2), np);
         break;
 
     case FIFFT_DIR_ENTRY_STRUCT :
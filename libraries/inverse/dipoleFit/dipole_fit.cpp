@@ -7,6 +7,16 @@
 #include <string.h>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+
+
 
 using namespace INVERSELIB;
 using namespace MNELIB;
@@ -587,6 +597,51 @@ int mne_get_values_from_data_ch (float time,      /* Interesting time point */
 }
 
 
+/*
+ * A block of consecutive time points fitted by one thread
+ */
+typedef struct {
+    DipoleFitData*  fit;            /* Precomputed fitting data (not modified while fitting) */
+    GuessData*      guess;          /* The initial guesses */
+    float           **B;            /* The data at all time points */
+    float           *times;         /* All time points */
+    int             *picked;        /* Could the data be picked? */
+    ECD             *dips;          /* The fitted dipoles */
+    int             *fitted;        /* Was the fit successful? */
+    int             first;          /* The time points of this block */
+    int             ntime;
+    int             verbose;
+    int             warm_start;     /* Start from the previous result within the block */
+} fitDipBlockRec;
+
+
+static void fit_dipole_block(fitDipBlockRec& b)
+/*
+ * Fit the time points of one block using a private workspace
+ */
+{
+    dipoleFitWorkspace work = DipoleFitData::new_dipole_fit_workspace(b.fit);
+    float rd_prev[3];
+    int   have_prev = FALSE;
+    int   s,k;
+
+    for (s = b.first; s < b.first + b.ntime; s++) {
+        if (!b.picked[s])
+            continue;
+        b.fitted[s] = DipoleFitData::fit_one(b.fit,b.guess,b.times[s],b.B[s],b.verbose,b.dips[s],work,
+                                             b.warm_start && have_prev ? rd_prev : NULL);
+        /*
+         * A failed fit is not a good starting point, go back to the guesses then
+         */
+        have_prev = b.fitted[s] && b.dips[s].good > 0.0;
+        if (have_prev)
+            for (k = 0; k < 3; k++)
+                rd_prev[k] = b.dips[s].rd[k];
+    }
+    DipoleFitData::free_dipole_fit_workspace(work);
+}
+
+
 
 
 
@@ -714,7 +769,8 @@ ECDSet DipoleFit::calculateFit() const
             goto out;
     }
     else {
-        if (fit_dipoles(settings->measname,data,fit_data,guess,settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set) == FAIL)
+        if (fit_dipoles(settings->measname,data,fit_data,guess,settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set,
+                        settings->use_threads,settings->warm_start) == FAIL)
             goto out;
     }
     printf("%d dipoles fitted\n",set.size());
@@ -728,34 +784,94 @@ out : {
 
 //*************************************************************************************************************
 
-int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, bool use_threads, bool warm_start)
 {
-    float *one = MALLOC(data->nchan,float);
+    float **B      = NULL;
+    float *times   = NULL;
+    int   *picked  = NULL;
+    int   *fitted  = NULL;
     float time;
     ECDSet set;
-    ECD   dip;
-    int   s;
+    QVector<ECD> dips;
+    QList<fitDipBlockRec> blocks;
+    fitDipBlockRec block;
+    int   s,k,ntime,nblock,first;
+    int   nproc = QThread::idealThreadCount();
     int   report_interval = 10;
 
     set.dataname = dataname;
 
+    for (ntime = 0, time = tmin; time < tmax; ntime++, time = tmin  + ntime*tstep)
+        ;
+    if (ntime == 0) {
+        p_set = set;
+        return OK;
+    }
+    /*
+     * Pick the data points first so that the fits do not need to access the data
+     */
+    B      = ALLOC_CMATRIX(ntime,data->nchan);
+    times  = MALLOC(ntime,float);
+    picked = MALLOC(ntime,int);
+    fitted = MALLOC(ntime,int);
+    dips.resize(ntime);
+    for (s = 0; s < ntime; s++) {
+        times[s]  = tmin + s*tstep;
+        fitted[s] = FALSE;
+        picked[s] = mne_get_values_from_data(times[s],integ,data->current->data,data->current->np,data->nchan,data->current->tmin,
+                                             1.0/data->current->tstep,FALSE,B[s]) != FAIL;
+        if (!picked[s])
+            fprintf(stderr,"Cannot pick time: %7.1f ms\n",1000*times[s]);
+    }
+    /*
+     * Split the time points into blocks.
+     * Small blocks balance the load between the threads better.
+     * With warm starts, however, the first time point of each block has to be started from the guesses.
+     */
+    if (nproc < 2)
+        use_threads = false;
+    if (use_threads)
+        nblock = warm_start ? nproc : 4*nproc;
+    else
+        nblock = 1;
+    if (nblock > ntime)
+        nblock = ntime;
+
+    block.fit        = fit;
+    block.guess      = guess;
+    block.B          = B;
+    block.times      = times;
+    block.picked     = picked;
+    block.dips       = dips.data();
+    block.fitted     = fitted;
+    block.verbose    = verbose;
+    block.warm_start = warm_start;
+    for (k = 0, first = 0; k < nblock; k++) {
+        block.first = first;
+        block.ntime = (int)((qint64)ntime*(k+1)/nblock) - first;
+        first       = first + block.ntime;
+        blocks.append(block);
+    }
+
+    if (nblock > 1)
+        fprintf(stderr,"%d processors. I will fit %d blocks of time points in parallel.\n",nproc,nblock);
     fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
-    for (s = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
-        /*
-     * Pick the data point
+    if (nblock > 1)
+        QtConcurrent::blockingMap(blocks, fit_dipole_block);
+    else
+        fit_dipole_block(blocks[0]);
+    /*
+     * Collect the results in temporal order
      */
-        if (mne_get_values_from_data(time,integ,data->current->data,data->current->np,data->nchan,data->current->tmin,
-                                     1.0/data->current->tstep,FALSE,one) == FAIL) {
-            fprintf(stderr,"Cannot pick time: %7.1f ms\n",1000*time);
+    for (s = 0; s < ntime; s++) {
+        if (!picked[s])
             continue;
-        }
-
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
-            printf("t = %7.1f ms : %s\n",1000*time,"error (tbd: catch)");
+        if (!fitted[s])
+            printf("t = %7.1f ms : %s\n",1000*times[s],"error (tbd: catch)");
         else {
-            set.addEcd(dip);
+            set.addEcd(dips[s]);
             if (verbose)
-                dip.print(stdout);
+                dips[s].print(stdout);
             else {
                 if (set.size() % report_interval == 0)
                     fprintf(stderr,"%d..",set.size());
@@ -764,7 +880,10 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
     }
     if (!verbose)
         fprintf(stderr,"[done]\n");
-    FREE(one);
+    FREE_CMATRIX(B);
+    FREE(times);
+    FREE(picked);
+    FREE(fitted);
     p_set = set;
     return OK;
 }
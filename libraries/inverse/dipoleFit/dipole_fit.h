@@ -119,10 +119,12 @@ public:
     * @param[in] integ      Integration time
     * @param[in] verbose    Verbose output?
     * @param[out] p_set     the fitted ECD Set
+    * @param[in] use_threads    Fit blocks of time points in parallel?
+    * @param[in] warm_start     Start each fit from the result at the previous time point instead of the best guess?
     *
     * @return true when successful
     */
-    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, bool use_threads = true, bool warm_start = false);
 
     //=========================================================================================================
     /**
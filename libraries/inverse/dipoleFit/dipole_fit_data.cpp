@@ -566,6 +566,8 @@ typedef struct {
     float          *B;
     double         B2;
     DipoleForward*  fwd;
+    DipoleFitData*  fit;            /* The fitting data */
+    dipoleFitFuncs  funcs;          /* The forward functions of the current pass */
 } *fitDipUser,fitDipUserRec;
 
 
@@ -4639,6 +4641,7 @@ out : {
 //*************************************************************************************************************
 
 DipoleForward* dipole_forward(DipoleFitData* d,
+                              dipoleFitFuncs funcs,
                               float         **rd,
                               int           ndip,
                               DipoleForward* old)
@@ -4675,7 +4678,7 @@ DipoleForward* dipole_forward(DipoleFitData* d,
         /*
      * Calculate the field of three orthogonal dipoles
      */
-        if ((DipoleFitData::compute_dipole_field(d,rd[k],TRUE,this_fwd)) == FAIL)
+        if ((DipoleFitData::compute_dipole_field(d,funcs,rd[k],TRUE,this_fwd)) == FAIL)
             goto bad;
         /*
      * Choice of column normalization
@@ -4734,10 +4737,24 @@ DipoleForward* DipoleFitData::dipole_forward_one(DipoleFitData* d,
 /*
  * Convenience function to compute the field of one dipole
  */
+{
+    return dipole_forward_one(d,d->funcs,rd,old);
+}
+
+
+//*************************************************************************************************************
+
+DipoleForward* DipoleFitData::dipole_forward_one(DipoleFitData* d,
+                                                 dipoleFitFuncs funcs,
+                                                 float         *rd,
+                                                 DipoleForward* old)
+/*
+ * Compute the field of one dipole with the given forward functions
+ */
 {
     float *rds[1];
     rds[0] = rd;
-    return dipole_forward(d,rds,1,old);
+    return dipole_forward(d,funcs,rds,1,old);
 }
 
 
@@ -4748,13 +4765,12 @@ static float fit_eval(float *rd,int npar,void *user)
  * Calculate the residual sum of squares
  */
 {
-    DipoleFitData* fit   = (DipoleFitData*)user;
     DipoleForward* fwd;
-    fitDipUser       fuser = (fitDipUser)fit->user;
+    fitDipUser       fuser = (fitDipUser)user;
     double        Bm2,one;
     int           ncomp,c;
 
-    fwd = fuser->fwd = DipoleFitData::dipole_forward_one(fit,rd,fuser->fwd);
+    fwd = fuser->fwd = DipoleFitData::dipole_forward_one(fuser->fit,fuser->funcs,rd,fuser->fwd);
     ncomp = fwd->sing[2]/fwd->sing[0] > fuser->limit ? 3 : 2;
     if (fuser->report_dim)
         fprintf(stderr,"ncomp = %d\n",ncomp);
@@ -4889,6 +4905,7 @@ static int report_func(int     loop,
 
 
 static int fit_Q(DipoleFitData* fit,	     /* The fit data */
+                 dipoleFitFuncs funcs,	     /* The forward functions */
                  float *B,		     /* Measurement */
                  float *rd,		     /* Dipole position */
                  float limit,		     /* Radial component omission limit */
@@ -4900,7 +4917,7 @@ static int fit_Q(DipoleFitData* fit,	     /* The fit data */
  */
 {
     int c;
-    DipoleForward* fwd = DipoleFitData::dipole_forward_one(fit,rd,NULL);
+    DipoleForward* fwd = DipoleFitData::dipole_forward_one(fit,funcs,rd,NULL);
     float Bm2,one;
 
     if (!fwd)
@@ -5119,6 +5136,22 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
                     int           verbose,
                     ECD&          res               /* The fitted dipole */
                     )
+{
+    return fit_one(fit,guess,time,B,verbose,res,NULL,NULL);
+}
+
+
+//*************************************************************************************************************
+
+bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitting data */
+                    GuessData*     guess,	            /* The initial guesses */
+                    float         time,              /* Which time is it? */
+                    float         *B,	            /* The field to fit */
+                    int           verbose,
+                    ECD&          res,              /* The fitted dipole */
+                    dipoleFitWorkspace work,        /* Thread-private forward functions (optional) */
+                    const float   *rd_start         /* Start here instead of the best guess (optional) */
+                    )
 {
     float  **simplex       = NULL;	       /* The simplex */
     float  vals[4];			       /* Values at the vertices */
@@ -5136,6 +5169,8 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     fitDipUserRec user;
     int        k,p,neval,neval_tot,nchan,ncomp;
     int        fit_fail;
+    dipoleFitFuncs sphere_funcs = work ? &work->sphere_funcs : fit->sphere_funcs;
+    dipoleFitFuncs bem_funcs    = work ? (work->has_bem ? &work->bem_funcs : NULL) : fit->bem_funcs;
 
     nchan = fit->nmeg+fit->neeg;
     user.fwd = NULL;
@@ -5146,21 +5181,25 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     if (mne_whiten_one_data(B,B,nchan,fit->noise) == FAIL)
         goto bad;
     /*
-   * Get the initial guess
+   * Get the initial guess, unless the caller knows a better starting point
+   * (typically the result at the neighbouring time point)
    */
-    if (find_best_guess(B,nchan,guess,limit,&best,&good) < 0)
-        goto bad;
-
+    if (rd_start) {
+        VEC_COPY_3(rd_guess,rd_start);
+    }
+    else {
+        if (find_best_guess(B,nchan,guess,limit,&best,&good) < 0)
+            goto bad;
+        VEC_COPY_3(rd_guess,guess->rr[best]);
+    }
+    VEC_COPY_3(rd_final,rd_guess);
 
     user.limit = limit;
     user.B     = B;
     user.B2    = mne_dot_vectors_3(B,B,nchan);
     user.fwd   = NULL;
     user.report_dim = FALSE;
-    fit->user  = &user;
-
-    VEC_COPY_3(rd_guess,guess->rr[best]);
-    VEC_COPY_3(rd_final,guess->rr[best]);
+    user.fit   = fit;
 
     neval_tot = 0;
     fit_fail = FALSE;
@@ -5169,20 +5208,20 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
      * Do first pass with the sphere model
      */
         if (k == 0)
-            fit->funcs = fit->sphere_funcs;
+            user.funcs = sphere_funcs;
         else
-            fit->funcs = !fit->bemname.isEmpty() ? fit->bem_funcs : fit->sphere_funcs;
+            user.funcs = !fit->bemname.isEmpty() && bem_funcs ? bem_funcs : sphere_funcs;
 
         simplex = make_initial_dipole_simplex(rd_guess,size);
         for (p = 0; p < 4; p++)
-            vals[p] = fit_eval(simplex[p],3,fit);
+            vals[p] = fit_eval(simplex[p],3,&user);
         if (simplex_minimize(simplex,           /* The initial simplex */
                              vals,              /* Function values at the vertices */
                              3,                 /* Number of variables */
                              ftol[k],           /* Relative convergence tolerance for the target function */
                              atol[k],           /* Absolute tolerance for the change in the parameters */
                              fit_eval,          /* The function to be evaluated */
-                             fit,               /* Data to be passed to the above function in each evaluation */
+                             &user,             /* Data to be passed to the above function in each evaluation */
                              max_eval,          /* Maximum number of function evaluations */
                              &neval,            /* Number of function evaluations */
                              report_interval,   /* How often to report (-1 = no_reporting) */
@@ -5208,7 +5247,7 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     /*
    * Compute the dipole moment at the final point
    */
-    if (fit_Q(fit,user.B,rd_final,user.limit,Q,&ncomp,&final_val) == OK) {
+    if (fit_Q(fit,user.funcs,user.B,rd_final,user.limit,Q,&ncomp,&final_val) == OK) {
         res.time  = time;
         res.valid = true;
         for(int i = 0; i < 3; ++i)
@@ -5250,9 +5289,80 @@ bad : {
 
 
 
+//*************************************************************************************************************
+
+dipoleFitWorkspace DipoleFitData::new_dipole_fit_workspace(DipoleFitData* fit)
+/*
+ * Duplicate the client data of the forward functions used in fit_one.
+ * Only the scratch areas are made private, everything read-only is shared with fit.
+ */
+{
+    dipoleFitWorkspace work = MALLOC_3(1,dipoleFitWorkspaceRec);
+    FwdThreadArg       one;
+
+    work->meg_sphere = NULL;
+    work->meg_bem    = NULL;
+    work->eeg_bem    = NULL;
+    work->has_bem    = fit->bem_funcs != NULL;
+
+    work->sphere_funcs = *fit->sphere_funcs;
+    work->sphere_funcs.meg_client_free = NULL;
+    work->sphere_funcs.eeg_client_free = NULL;
+    if (fit->sphere_funcs->meg_client) {
+        one.client = fit->sphere_funcs->meg_client;
+        work->meg_sphere = FwdThreadArg::create_meg_multi_thread_duplicate(&one,false);
+        work->sphere_funcs.meg_client = work->meg_sphere->client;
+    }
+
+    if (work->has_bem) {
+        work->bem_funcs = *fit->bem_funcs;
+        work->bem_funcs.meg_client_free = NULL;
+        work->bem_funcs.eeg_client_free = NULL;
+        if (fit->bem_funcs->meg_client) {
+            one.client = fit->bem_funcs->meg_client;
+            work->meg_bem = FwdThreadArg::create_meg_multi_thread_duplicate(&one,true);
+            work->bem_funcs.meg_client = work->meg_bem->client;
+        }
+        if (fit->bem_funcs->eeg_client) {
+            one.client = fit->bem_funcs->eeg_client;
+            work->eeg_bem = FwdThreadArg::create_eeg_multi_thread_duplicate(&one,true);
+            work->bem_funcs.eeg_client = work->eeg_bem->client;
+        }
+    }
+    one.client = NULL;
+    return work;
+}
+
+
+//*************************************************************************************************************
+
+void DipoleFitData::free_dipole_fit_workspace(dipoleFitWorkspace work)
+{
+    if (!work)
+        return;
+
+    if (work->meg_sphere)
+        FwdThreadArg::free_meg_multi_thread_duplicate(work->meg_sphere,false);
+    if (work->meg_bem)
+        FwdThreadArg::free_meg_multi_thread_duplicate(work->meg_bem,true);
+    if (work->eeg_bem)
+        FwdThreadArg::free_eeg_multi_thread_duplicate(work->eeg_bem,true);
+    FREE_3(work);
+    return;
+}
+
+
 //*************************************************************************************************************
 
 int DipoleFitData::compute_dipole_field(DipoleFitData* d, float *rd, int whiten, float **fwd)
+{
+    return compute_dipole_field(d,d->funcs,rd,whiten,fwd);
+}
+
+
+//*************************************************************************************************************
+
+int DipoleFitData::compute_dipole_field(DipoleFitData* d, dipoleFitFuncs funcs, float *rd, int whiten, float **fwd)
 /*
  * Compute the field and take whitening and projection into account
  */
@@ -5266,34 +5376,34 @@ int DipoleFitData::compute_dipole_field(DipoleFitData* d, float *rd, int whiten,
    * Compute the fields
    */
     if (d->nmeg > 0) {
-        if (d->funcs->meg_vec_field) {
-            if (d->funcs->meg_vec_field(rd,d->meg_coils,fwd,d->funcs->meg_client) != OK)
+        if (funcs->meg_vec_field) {
+            if (funcs->meg_vec_field(rd,d->meg_coils,fwd,funcs->meg_client) != OK)
                 goto bad;
         }
         else {
-            if (d->funcs->meg_field(rd,Qx,d->meg_coils,fwd[0],d->funcs->meg_client) != OK)
+            if (funcs->meg_field(rd,Qx,d->meg_coils,fwd[0],funcs->meg_client) != OK)
                 goto bad;
-            if (d->funcs->meg_field(rd,Qy,d->meg_coils,fwd[1],d->funcs->meg_client) != OK)
+            if (funcs->meg_field(rd,Qy,d->meg_coils,fwd[1],funcs->meg_client) != OK)
                 goto bad;
-            if (d->funcs->meg_field(rd,Qz,d->meg_coils,fwd[2],d->funcs->meg_client) != OK)
+            if (funcs->meg_field(rd,Qz,d->meg_coils,fwd[2],funcs->meg_client) != OK)
                 goto bad;
         }
     }
 
     if (d->neeg > 0) {
-        if (d->funcs->eeg_vec_pot) {
+        if (funcs->eeg_vec_pot) {
             eeg_fwd[0] = fwd[0]+d->nmeg;
             eeg_fwd[1] = fwd[1]+d->nmeg;
             eeg_fwd[2] = fwd[2]+d->nmeg;
-            if (d->funcs->eeg_vec_pot(rd,d->eeg_els,eeg_fwd,d->funcs->eeg_client) != OK)
+            if (funcs->eeg_vec_pot(rd,d->eeg_els,eeg_fwd,funcs->eeg_client) != OK)
                 goto bad;
         }
         else {
-            if (d->funcs->eeg_pot(rd,Qx,d->eeg_els,fwd[0]+d->nmeg,d->funcs->eeg_client) != OK)
+            if (funcs->eeg_pot(rd,Qx,d->eeg_els,fwd[0]+d->nmeg,funcs->eeg_client) != OK)
                 goto bad;
-            if (d->funcs->eeg_pot(rd,Qy,d->eeg_els,fwd[1]+d->nmeg,d->funcs->eeg_client) != OK)
+            if (funcs->eeg_pot(rd,Qy,d->eeg_els,fwd[1]+d->nmeg,funcs->eeg_client) != OK)
                 goto bad;
-            if (d->funcs->eeg_pot(rd,Qz,d->eeg_els,fwd[2]+d->nmeg,d->funcs->eeg_client) != OK)
+            if (funcs->eeg_pot(rd,Qz,d->eeg_els,fwd[2]+d->nmeg,funcs->eeg_client) != OK)
                 goto bad;
         }
     }
@@ -48,6 +48,7 @@
 #include <fwd/fwd_types.h>
 #include <fwd/fwd_eeg_sphere_model.h>
 #include <fwd/fwd_bem_model.h>
+#include <fwd/fwd_thread_arg.h>
 #include "dipole_forward.h"
 
 
@@ -91,6 +92,19 @@ typedef struct {
   mneUserFreeFunc eeg_client_free;
 } *dipoleFitFuncs,dipoleFitFuncsRec;
 
+/*
+ * The field computations keep their scratch areas in the client data.
+ * Each thread fitting time points concurrently therefore needs its own copies.
+ */
+typedef struct {
+  dipoleFitFuncsRec     sphere_funcs;	    /* Sphere model functions with private client data */
+  dipoleFitFuncsRec     bem_funcs;	    /* BEM functions with private client data */
+  int                   has_bem;	    /* Are the BEM functions available? */
+  FWDLIB::FwdThreadArg  *meg_sphere;	    /* The duplicated client data (see FwdThreadArg) */
+  FWDLIB::FwdThreadArg  *meg_bem;
+  FWDLIB::FwdThreadArg  *eeg_bem;
+} *dipoleFitWorkspace,dipoleFitWorkspaceRec;
+
 
 
 
@@ -214,18 +228,61 @@ public:
     */
     static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res);
 
+    //=========================================================================================================
+    /**
+    * Fit a single dipole to the given data. This version does not modify the fitting data and can be called
+    * concurrently from several threads as long as each thread passes its own workspace.
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in] guess      The initial guesses
+    * @param[in] time       Which time is it?
+    * @param[in] B          The field to fit
+    * @param[in] verbose
+    * @param[in] res        The fitted dipole
+    * @param[in] work       Thread-private workspace, NULL uses the forward functions of fit directly
+    * @param[in] rd_start   Initial dipole position replacing the search over the guesses, may be NULL
+    */
+    static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res,
+                        dipoleFitWorkspace work, const float *rd_start);
+
+    //=========================================================================================================
+    /**
+    * Creates a workspace for fit_one with private copies of the forward computation client data.
+    * The read-only parts (coil definitions, BEM solution) are shared with fit.
+    *
+    * @param[in] fit        Precomputed fitting data
+    *
+    * @return the workspace, to be released with free_dipole_fit_workspace
+    */
+    static dipoleFitWorkspace new_dipole_fit_workspace(DipoleFitData* fit);
+
+    //=========================================================================================================
+    /**
+    * Releases a workspace created with new_dipole_fit_workspace
+    *
+    * @param[in] work       The workspace
+    */
+    static void free_dipole_fit_workspace(dipoleFitWorkspace work);
+
 
 
 //============================= dipole_forward.c
 
     static int compute_dipole_field(DipoleFitData* d, float *rd, int whiten, float **fwd);
 
+    static int compute_dipole_field(DipoleFitData* d, dipoleFitFuncs funcs, float *rd, int whiten, float **fwd);
+
     //============================= dipole_forward.c
 
     static DipoleForward* dipole_forward_one(DipoleFitData* d,
                                      float         *rd,
                                      DipoleForward* old);
 
+    static DipoleForward* dipole_forward_one(DipoleFitData* d,
+                                     dipoleFitFuncs funcs,
+                                     float         *rd,
+                                     DipoleForward* old);
+
 
 
 
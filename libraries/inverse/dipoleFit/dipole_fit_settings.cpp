@@ -121,6 +121,8 @@ void DipoleFitSettings::initMembers()
     scale_eeg_pos  = false;     
     mag_reg      = 0.1f;         
     fit_mag_dipoles = false;
+    use_threads  = true;
+    warm_start   = false;
 
     grad_reg     = 0.1f;         
     eeg_reg      = 0.1f;                  
@@ -277,6 +279,8 @@ void DipoleFitSettings::usage(char *name)
     printf("\t--mindist dist/mm Exclude points which are closer than this distance from the inner skull surface  (default = %6.1f mm).\n",1000*guess_mindist);
     printf("\t--grid    dist/mm Source space grid size (default = %6.1f mm).\n",1000*guess_grid);
     printf("\t--magdip          Fit magnetic dipoles instead of current dipoles.\n");
+    printf("\t--warmstart       Start each fit from the dipole fitted at the previous time point instead of the best guess.\n");
+    printf("\t--nothreads       Fit the time points one after another.\n");
     printf("\nOutput:\n\n");
     printf("\t--dip     name    xfit dip format output file name\n");
     printf("\t--bdip    name    xfit bdip format output file name\n");
@@ -823,6 +827,14 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             found = 1;
             fit_mag_dipoles = true;
         }
+        else if (strcmp(argv[k],"--warmstart") == 0) {
+            found = 1;
+            warm_start = true;
+        }
+        else if (strcmp(argv[k],"--nothreads") == 0) {
+            found = 1;
+            use_threads = false;
+        }
         else if (strcmp(argv[k],"--dip") == 0) {
             found = 2;
             if (k == *argc - 1) {
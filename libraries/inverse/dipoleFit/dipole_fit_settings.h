@@ -179,6 +179,8 @@ float  eeg_sphere_rad;      		/**< Scalp radius to use in EEG sphere model */
     bool    scale_eeg_pos;     		/**< Scale the electrode locations to scalp in the sphere model */
     float  mag_reg;         		/**< Noise-covariance matrix regularization for MEG (magnetometers and axial gradiometers)  */
     bool   fit_mag_dipoles;
+    bool   use_threads;                 /**< Fit several time points in parallel */
+    bool   warm_start;                  /**< Start each fit from the result at the previous time point instead of the guess grid */
 
 float  grad_reg;         		/**< Noise-covariance matrix regularization for EEG (planar gradiometers) */
     float  eeg_reg;         		/**< Noise-covariance matrix regularization for EEG  */
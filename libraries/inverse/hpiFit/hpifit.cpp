@@ -64,8 +64,8 @@
 // QT INCLUDES
 //=============================================================================================================
 
-#include <QFuture>
-#include <QtConcurrent/QtConcurrent>
+#include <QDir>
+#include <QDateTime>
 
 
 //*************************************************************************************************************
@@ -90,6 +90,12 @@ using namespace FIFFLIB;
 //=============================================================================================================
 
 HPIFit::HPIFit()
+: m_dSFreq(0.0)
+, m_iSampleCount(0)
+, m_iDemodWindow(1)
+, m_iTopoFirst(0)
+, m_iTopoCount(0)
+, m_bWarmStart(false)
 {
 
 }
@@ -106,6 +112,60 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
                         FiffInfo::SPtr pFiffInfo,
                         bool bDoDebug,
                         const QString& sHPIResourceDir)
+{
+    HPIFit hpiFit;
+    hpiFit.fit(t_mat,
+               t_matProjectors,
+               transDevHead,
+               vFreqs,
+               vGof,
+               fittedPointSet,
+               pFiffInfo,
+               bDoDebug,
+               sHPIResourceDir);
+}
+
+
+//*************************************************************************************************************
+
+void HPIFit::setDemodulationWindow(int iNumBlocks)
+{
+    iNumBlocks = iNumBlocks >= 1 ? iNumBlocks : 1;
+    if(iNumBlocks == m_iDemodWindow) {
+        return;
+    }
+
+    m_iDemodWindow = iNumBlocks;
+
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void HPIFit::reset()
+{
+    m_iSampleCount = 0;
+    m_vecTopo.clear();
+    m_iTopoFirst = 0;
+    m_iTopoCount = 0;
+    m_matTopoSum.resize(0,0);
+
+    m_bWarmStart = false;
+}
+
+
+//*************************************************************************************************************
+
+void HPIFit::fit(const MatrixXd& t_mat,
+                 const Eigen::MatrixXd& t_matProjectors,
+                 FiffCoordTrans& transDevHead,
+                 const QVector<int>& vFreqs,
+                 QVector<double>& vGof,
+                 FiffDigPointSet& fittedPointSet,
+                 FiffInfo::SPtr pFiffInfo,
+                 bool bDoDebug,
+                 const QString& sHPIResourceDir)
 {
     //Check if data was passed
     if(t_mat.rows() == 0 || t_mat.cols() == 0 ) {
@@ -119,9 +179,7 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
 
     vGof.clear();
 
-    struct SensorInfo sensors;
     struct CoilParam coil;
-    int numCh = pFiffInfo->nchan;
     int samF = pFiffInfo->sfreq;
     int samLoc = t_mat.cols(); // minimum samples required to localize numLoc times in a second
 
@@ -149,27 +207,34 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
         return;
     }
 
+    //Recompute the sensor structures only if the channels or the projectors changed
+    if(m_pFiffInfo != pFiffInfo
+            || m_lBads != pFiffInfo->bads
+            || m_matProjectors.rows() != t_matProjectors.rows()
+            || m_matProjectors.cols() != t_matProjectors.cols()
+            || m_matProjectors != t_matProjectors) {
+        updateSensors(t_matProjectors, pFiffInfo);
+        reset();
+    }
+
+    //Recompute the reference only if the coils, the frequencies or the block length changed
+    if(m_vecCoilFreqs.size() != coilfreq.size()
+            || m_vecCoilFreqs != coilfreq
+            || m_dSFreq != samF
+            || m_matSimsigPinvT.rows() != samLoc) {
+        m_vecCoilFreqs = coilfreq;
+        updateReference(samLoc, samF);
+        reset();
+    }
+
+    const QVector<int>& innerind = m_vInnerInd;
+
     // Initialize HPI coils location and moment
     coil.pos = Eigen::MatrixXd::Zero(numCoils,3);
     coil.mom = Eigen::MatrixXd::Zero(numCoils,3);
     coil.dpfiterror = Eigen::VectorXd::Zero(numCoils);
     coil.dpfitnumitr = Eigen::VectorXd::Zero(numCoils);
 
-    // Generate simulated data
-    Eigen::MatrixXd simsig(samLoc,numCoils*2);
-    Eigen::VectorXd time(samLoc);
-
-    for (int i = 0; i < samLoc; ++i) {
-        time[i] = i*1.0/samF;
-    }
-
-    for(int i = 0; i < numCoils; ++i) {
-        for(int j = 0; j < samLoc; ++j) {
-            simsig(j,i) = sin(2*M_PI*coilfreq[i]*time[j]);
-            simsig(j,i+numCoils) = cos(2*M_PI*coilfreq[i]*time[j]);
-        }
-    }
-
     // Create digitized HPI coil position matrix
     Eigen::MatrixXd headHPI(numCoils,3);
 
@@ -188,64 +253,55 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
         }
     }
 
-    // Get the indices of inner layer channels and exclude bad channels.
-    //TODO: Only supports babymeg and vectorview gradiometeres for hpi fitting.
-    QVector<int> innerind(0);
+    Eigen::MatrixXd amp(innerind.size(), numCoils);
+    Eigen::MatrixXd ampC(innerind.size(), numCoils);
 
-    for (int i = 0; i < numCh; ++i) {
-        if(pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_BABY_MAG ||
-                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T1 ||
-                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T2 ||
-                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T3) {
-            // Check if the sensor is bad, if not append to innerind
-            if(!(pFiffInfo->bads.contains(pFiffInfo->ch_names.at(i)))) {
-                innerind.append(i);
-            }
-        }
+    // Get the data from inner layer channels
+    Eigen::MatrixXd innerdata(innerind.size(), t_mat.cols());
+
+    for(int j = 0; j < innerind.size(); ++j) {
+        innerdata.row(j) << t_mat.row(innerind[j]);
     }
 
-    //Create new projector based on the excluded channels, first exclude the rows then the columns
-    MatrixXd matProjectorsRows(innerind.size(),t_matProjectors.cols());
-    MatrixXd matProjectorsInnerind(innerind.size(),innerind.size());
+    // Calculate topo with the cached reference pseudoinverse
+    Eigen::MatrixXd topo = innerdata * m_matSimsigPinvT; // topo: # of good inner channel x 8
 
-    for (int i = 0; i < matProjectorsRows.rows(); ++i) {
-        matProjectorsRows.row(i) = t_matProjectors.row(innerind.at(i));
-    }
+    // Rotate the sine/cosine components to the phase of the first block, so that the topographies of consecutive
+    // blocks can be averaged: a*sin(w(t-t0)) + b*cos(w(t-t0)) = (a*cos(wt0) + b*sin(wt0))*sin(wt) + (b*cos(wt0) - a*sin(wt0))*cos(wt)
+    for(int i = 0; i < numCoils; ++i) {
+        double dPhase = 2*M_PI*std::fmod(coilfreq[i]*m_iSampleCount, samF)/samF;
+        double dCos = cos(dPhase);
+        double dSin = sin(dPhase);
 
-    for (int i = 0; i < matProjectorsInnerind.cols(); ++i) {
-        matProjectorsInnerind.col(i) = matProjectorsRows.col(innerind.at(i));
+        VectorXd vecSin = topo.col(i);
+        topo.col(i) = dCos*vecSin + dSin*topo.col(i+numCoils);
+        topo.col(i+numCoils) = dCos*topo.col(i+numCoils) - dSin*vecSin;
     }
 
-    //UTILSLIB::IOUtils::write_eigen_matrix(matProjectorsInnerind, "matProjectorsInnerind.txt");
-    //UTILSLIB::IOUtils::write_eigen_matrix(t_matProjectors, "t_matProjectors.txt");
-
-    // Initialize inner layer sensors
-    sensors.coilpos = Eigen::MatrixXd::Zero(innerind.size(),3);
-    sensors.coilori = Eigen::MatrixXd::Zero(innerind.size(),3);
-    sensors.tra = Eigen::MatrixXd::Identity(innerind.size(),innerind.size());
+    m_iSampleCount += samLoc;
 
-    for(int i = 0; i < innerind.size(); i++) {
-        sensors.coilpos(i,0) = pFiffInfo->chs[innerind.at(i)].chpos.r0[0];
-        sensors.coilpos(i,1) = pFiffInfo->chs[innerind.at(i)].chpos.r0[1];
-        sensors.coilpos(i,2) = pFiffInfo->chs[innerind.at(i)].chpos.r0[2];
-        sensors.coilori(i,0) = pFiffInfo->chs[innerind.at(i)].chpos.ez[0];
-        sensors.coilori(i,1) = pFiffInfo->chs[innerind.at(i)].chpos.ez[1];
-        sensors.coilori(i,2) = pFiffInfo->chs[innerind.at(i)].chpos.ez[2];
+    // Sliding demodulation window
+    if(m_vecTopo.size() != m_iDemodWindow) {
+        m_vecTopo.resize(m_iDemodWindow);
+        m_iTopoFirst = 0;
+        m_iTopoCount = 0;
     }
 
-    Eigen::MatrixXd topo(innerind.size(), numCoils*2);
-    Eigen::MatrixXd amp(innerind.size(), numCoils);
-    Eigen::MatrixXd ampC(innerind.size(), numCoils);
-
-    // Get the data from inner layer channels
-    Eigen::MatrixXd innerdata(innerind.size(), t_mat.cols());
+    if(m_iTopoCount == 0) {
+        m_matTopoSum = MatrixXd::Zero(topo.rows(), topo.cols());
+    }
 
-    for(int j = 0; j < innerind.size(); ++j) {
-        innerdata.row(j) << t_mat.row(innerind[j]);
+    if(m_iTopoCount < m_iDemodWindow) {
+        m_vecTopo[(m_iTopoFirst + m_iTopoCount) % m_iDemodWindow] = topo;
+        m_iTopoCount++;
+    } else {
+        m_matTopoSum -= m_vecTopo.at(m_iTopoFirst);
+        m_vecTopo[m_iTopoFirst] = topo;
+        m_iTopoFirst = (m_iTopoFirst + 1) % m_iDemodWindow;
     }
 
-    // Calculate topo
-    topo = innerdata * UTILSLIB::MNEMath::pinv(simsig).transpose(); // topo: # of good inner channel x 8
+    m_matTopoSum += topo;
+    topo = m_matTopoSum / m_iTopoCount;
 
     // Select sine or cosine component depending on the relative size
     amp  = topo.leftCols(numCoils); // amp: # of good inner channel x 4
@@ -266,49 +322,57 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
        }
     }
 
-    //Find good seed point/starting point for the coil position in 3D space
-    //Find biggest amplitude per pickup coil (sensor) and store corresponding sensor channel index
-    VectorXi chIdcs(numCoils);
-
-    for (int j = 0; j < numCoils; j++) {
-        double maxVal = 0;
-        int chIdx = 0;
-
-        for (int i = 0; i < amp.rows(); ++i) {
-            if(std::fabs(amp(i,j)) > maxVal) {
-                maxVal = std::fabs(amp(i,j));
+    VectorXi chIdcs = VectorXi::Zero(numCoils);
+    Eigen::MatrixXd coilPos = Eigen::MatrixXd::Zero(numCoils,3);
 
-                if(chIdx < innerind.size()) {
-                    chIdx = innerind.at(i);
+    if(m_bWarmStart && m_matCoilPos.rows() == numCoils) {
+        //Start from the coil positions of the previous fit
+        coilPos = m_matCoilPos;
+    } else {
+        //Find good seed point/starting point for the coil position in 3D space
+        //Find biggest amplitude per pickup coil (sensor) and store corresponding sensor channel index
+        for (int j = 0; j < numCoils; j++) {
+            double maxVal = 0;
+            int chIdx = 0;
+
+            for (int i = 0; i < amp.rows(); ++i) {
+                if(std::fabs(amp(i,j)) > maxVal) {
+                    maxVal = std::fabs(amp(i,j));
+
+                    if(chIdx < innerind.size()) {
+                        chIdx = innerind.at(i);
+                    }
                 }
             }
-        }
 
-        chIdcs(j) = chIdx;
-    }
+            chIdcs(j) = chIdx;
+        }
 
-    //Generate seed point by projection the found channel position 3cm inwards
-    Eigen::MatrixXd coilPos = Eigen::MatrixXd::Zero(numCoils,3);
+        //Generate seed point by projection the found channel position 3cm inwards
+        for (int j = 0; j < chIdcs.rows(); ++j) {
+            int chIdx = chIdcs(j);
 
-    for (int j = 0; j < chIdcs.rows(); ++j) {
-        int chIdx = chIdcs(j);
+            if(chIdx < pFiffInfo->chs.size()) {
+                double x = pFiffInfo->chs.at(chIdcs(j)).chpos.r0[0];
+                double y = pFiffInfo->chs.at(chIdcs(j)).chpos.r0[1];
+                double z = pFiffInfo->chs.at(chIdcs(j)).chpos.r0[2];
 
-        if(chIdx < pFiffInfo->chs.size()) {
-            double x = pFiffInfo->chs.at(chIdcs(j)).chpos.r0[0];
-            double y = pFiffInfo->chs.at(chIdcs(j)).chpos.r0[1];
-            double z = pFiffInfo->chs.at(chIdcs(j)).chpos.r0[2];
+                coilPos(j,0) = -1 * pFiffInfo->chs.at(chIdcs(j)).chpos.ez[0] * 0.03 + x;
+                coilPos(j,1) = -1 * pFiffInfo->chs.at(chIdcs(j)).chpos.ez[1] * 0.03 + y;
+                coilPos(j,2) = -1 * pFiffInfo->chs.at(chIdcs(j)).chpos.ez[2] * 0.03 + z;
+            }
 
-            coilPos(j,0) = -1 * pFiffInfo->chs.at(chIdcs(j)).chpos.ez[0] * 0.03 + x;
-            coilPos(j,1) = -1 * pFiffInfo->chs.at(chIdcs(j)).chpos.ez[1] * 0.03 + y;
-            coilPos(j,2) = -1 * pFiffInfo->chs.at(chIdcs(j)).chpos.ez[2] * 0.03 + z;
+            //std::cout << "HPIFit::fitHPI - Coil " << j << " max value index " << chIdx << std::endl;
         }
-
-        //std::cout << "HPIFit::fitHPI - Coil " << j << " max value index " << chIdx << std::endl;
     }
 
     coil.pos = coilPos;
 
-    coil = dipfit(coil, sensors, amp, numCoils, matProjectorsInnerind);
+    coil = dipfit(coil, m_sensors, amp, numCoils, m_matProjectorsInnerind);
+
+    //Keep the fitted positions as starting point for the next fit if all coils were fitted well
+    m_matCoilPos = coil.pos;
+    m_bWarmStart = coil.dpfiterror.size() > 0 && coil.dpfiterror.maxCoeff() < HPIFIT_WARMSTART_MAX_ERROR;
 
     Eigen::Matrix4d trans = computeTransformation(headHPI, coil.pos);
     //Eigen::Matrix4d trans = computeTransformation(coil.pos, headHPI);
@@ -392,12 +456,93 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
 }
 
 
+//*************************************************************************************************************
+
+void HPIFit::updateSensors(const Eigen::MatrixXd& t_matProjectors,
+                           FiffInfo::SPtr pFiffInfo)
+{
+    m_pFiffInfo = pFiffInfo;
+    m_lBads = pFiffInfo->bads;
+    m_matProjectors = t_matProjectors;
+
+    // Get the indices of inner layer channels and exclude bad channels.
+    //TODO: Only supports babymeg and vectorview gradiometeres for hpi fitting.
+    QVector<int> innerind(0);
+
+    for (int i = 0; i < pFiffInfo->nchan; ++i) {
+        if(pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_BABY_MAG ||
+                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T1 ||
+                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T2 ||
+                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T3) {
+            // Check if the sensor is bad, if not append to innerind
+            if(!(pFiffInfo->bads.contains(pFiffInfo->ch_names.at(i)))) {
+                innerind.append(i);
+            }
+        }
+    }
+
+    //Create new projector based on the excluded channels, first exclude the rows then the columns
+    MatrixXd matProjectorsRows(innerind.size(),t_matProjectors.cols());
+    m_matProjectorsInnerind.resize(innerind.size(),innerind.size());
+
+    for (int i = 0; i < matProjectorsRows.rows(); ++i) {
+        matProjectorsRows.row(i) = t_matProjectors.row(innerind.at(i));
+    }
+
+    for (int i = 0; i < m_matProjectorsInnerind.cols(); ++i) {
+        m_matProjectorsInnerind.col(i) = matProjectorsRows.col(innerind.at(i));
+    }
+
+    // Initialize inner layer sensors
+    m_sensors.coilpos = Eigen::MatrixXd::Zero(innerind.size(),3);
+    m_sensors.coilori = Eigen::MatrixXd::Zero(innerind.size(),3);
+    m_sensors.tra = Eigen::MatrixXd::Identity(innerind.size(),innerind.size());
+
+    for(int i = 0; i < innerind.size(); i++) {
+        m_sensors.coilpos(i,0) = pFiffInfo->chs[innerind.at(i)].chpos.r0[0];
+        m_sensors.coilpos(i,1) = pFiffInfo->chs[innerind.at(i)].chpos.r0[1];
+        m_sensors.coilpos(i,2) = pFiffInfo->chs[innerind.at(i)].chpos.r0[2];
+        m_sensors.coilori(i,0) = pFiffInfo->chs[innerind.at(i)].chpos.ez[0];
+        m_sensors.coilori(i,1) = pFiffInfo->chs[innerind.at(i)].chpos.ez[1];
+        m_sensors.coilori(i,2) = pFiffInfo->chs[innerind.at(i)].chpos.ez[2];
+    }
+
+    m_vInnerInd = innerind;
+}
+
+
+//*************************************************************************************************************
+
+void HPIFit::updateReference(int iSamples, double dSFreq)
+{
+    int numCoils = m_vecCoilFreqs.size();
+
+    m_dSFreq = dSFreq;
+
+    // Generate simulated data
+    Eigen::MatrixXd simsig(iSamples,numCoils*2);
+    Eigen::VectorXd time(iSamples);
+
+    for (int i = 0; i < iSamples; ++i) {
+        time[i] = i*1.0/dSFreq;
+    }
+
+    for(int i = 0; i < numCoils; ++i) {
+        for(int j = 0; j < iSamples; ++j) {
+            simsig(j,i) = sin(2*M_PI*m_vecCoilFreqs[i]*time[j]);
+            simsig(j,i+numCoils) = cos(2*M_PI*m_vecCoilFreqs[i]*time[j]);
+        }
+    }
+
+    m_matSimsigPinvT = UTILSLIB::MNEMath::pinv(simsig).transpose();
+}
+
+
 //*************************************************************************************************************
 
 CoilParam HPIFit::dipfit(struct CoilParam coil, struct SensorInfo sensors, const Eigen::MatrixXd& data, int numCoils, const Eigen::MatrixXd& t_matProjectors)
 {
-    //Do this in conncurrent mode
-    //Generate QList structure which can be handled by the QConcurrent framework
+    //Generate QList structure which holds the data of each coil
     QList<HPIFitData> lCoilData;
 
     for(qint32 i = 0; i < numCoils; ++i) {
@@ -409,17 +554,9 @@ CoilParam HPIFit::dipfit(struct CoilParam coil, struct SensorInfo sensors, const
 
         lCoilData.append(coilData);
     }
-    //Do the concurrent filtering
+    //Fit all coils together
     if(!lCoilData.isEmpty()) {
-//        //Do sequential
-//        for(int l = 0; l < lCoilData.size(); ++l) {
-//            doDipfitConcurrent(lCoilData[l]);
-//        }
-
-        //Do concurrent
-        QFuture<void> future = QtConcurrent::map(lCoilData,
-                                             &HPIFitData::doDipfitConcurrent);
-        future.waitForFinished();
+        HPIFitData::doDipfitLevenbergMarquardt(lCoilData);
 
         //Transform results to final coil information
         for(qint32 i = 0; i < lCoilData.size(); ++i) {
@@ -42,6 +42,7 @@
 //=============================================================================================================
 
 #include "../inverse_global.h"
+#include "hpifitdata.h"
 
 
 //*************************************************************************************************************
@@ -51,6 +52,8 @@
 
 #include <Eigen/Core>
 
+#define HPIFIT_WARMSTART_MAX_ERROR  0.1     /**< Maximal relative dipole fit error of all coils for which the next fit starts from the fitted coil positions. */
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -58,6 +61,8 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QVector>
+#include <QStringList>
 
 
 //*************************************************************************************************************
@@ -104,7 +109,10 @@ struct CoilParam {
 
 //=============================================================================================================
 /**
-* HPI Fit algorithms.
+* HPI Fit algorithms. An HPIFit object can be used for continuous head position tracking: it keeps the sensor
+* structures, the projector and the pseudoinverse of the sine/cosine reference between calls to fit, demodulates
+* the coil signals with phase continuous references over a sliding window of blocks and starts each fit from the
+* coil positions of the previous fit.
 *
 * @brief HPI Fit algorithms.
 */
@@ -121,6 +129,48 @@ public:
     */
     explicit HPIFit();
 
+    //=========================================================================================================
+    /**
+    * Fits the HPI coils to the next data block. The setup is only recomputed if the measurement info, its bad
+    * channels, the projectors, the coil frequencies or the block length changed. For a demodulation window of
+    * more than one block consecutive calls need to pass contiguous blocks.
+    *
+    * @param[in] t_mat           Data to estimate the HPI positions from
+    * @param[in] t_matProjectors The projectors to apply. Bad channels are still included.
+    * @param[out] transDevHead   The final dev head transformation matrix
+    * @param[in] vFreqs          The frequencies for each coil.
+    * @param[out] vGof           The goodness of fit in mm for each fitted HPI coil.
+    * @param[out] fittedPointSet The final fitted positions in form of a digitizer set.
+    * @param[in] pFiffInfo       Associated Fiff Information.
+    * @param[in] bDoDebug        Print debug info to cmd line and write debug info to file.
+    * @param[in] sHPIResourceDir The path to the debug file which is to be written.
+    */
+    void fit(const Eigen::MatrixXd& t_mat,
+             const Eigen::MatrixXd& t_matProjectors,
+             FIFFLIB::FiffCoordTrans &transDevHead,
+             const QVector<int>& vFreqs,
+             QVector<double> &vGof,
+             FIFFLIB::FiffDigPointSet& fittedPointSet,
+             QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo,
+             bool bDoDebug = false,
+             const QString& sHPIResourceDir = QString("./HPIFittingDebug"));
+
+    //=========================================================================================================
+    /**
+    * Sets the number of blocks the coil amplitudes are demodulated over. Defaults to one block. Changing the
+    * window drops the demodulation state, see reset.
+    *
+    * @param[in] iNumBlocks      The number of blocks
+    */
+    void setDemodulationWindow(int iNumBlocks);
+
+    //=========================================================================================================
+    /**
+    * Drops the demodulation window and the coil positions of the previous fit. The next fit is seeded from the
+    * amplitude maxima again.
+    */
+    void reset();
+
     //=========================================================================================================
     /**
     * Perform one single HPI fit.
@@ -131,7 +181,7 @@ public:
     * @param[in] vFreqs          The frequencies for each coil.
     * @param[out] vGof           The goodness of fit in mm for each fitted HPI coil.
     * @param[out] fittedPointSet The final fitted positions in form of a digitizer set.
-    * @param[in] p_pFiffInfo     Associated Fiff Information.
+    * @param[in] pFiffInfo       Associated Fiff Information.
     * @param[in] bDoDebug        Print debug info to cmd line and write debug info to file.
     * @param[in] sHPIResourceDir The path to the debug file which is to be written.
     */
@@ -171,7 +221,48 @@ protected:
     */
     static Eigen::Matrix4d computeTransformation(Eigen::MatrixXd NH, Eigen::MatrixXd BT);
 
+    //=========================================================================================================
+    /**
+    * Recomputes the inner layer channel selection, the sensor structure and the projector for the good inner
+    * layer channels.
+    *
+    * @param[in] t_matProjectors The projectors to apply. Bad channels are still included.
+    * @param[in] pFiffInfo       Associated Fiff Information.
+    */
+    void updateSensors(const Eigen::MatrixXd& t_matProjectors,
+                       QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo);
+
+    //=========================================================================================================
+    /**
+    * Recomputes the sine/cosine reference of one block and its pseudoinverse.
+    *
+    * @param[in] iSamples        The number of samples per block.
+    * @param[in] dSFreq          The sampling frequency.
+    */
+    void updateReference(int iSamples, double dSFreq);
+
     static QString         m_sHPIResourceDir;      /**< Hold the resource folder to store the debug information in. */
+
+    QSharedPointer<FIFFLIB::FiffInfo>   m_pFiffInfo;            /**< The measurement info the cached setup was computed for. */
+    QStringList                         m_lBads;                /**< The bad channels the cached setup was computed for. */
+    Eigen::MatrixXd                     m_matProjectors;        /**< The projectors the cached setup was computed for. */
+    QVector<int>                        m_vInnerInd;            /**< Indices of the good inner layer channels. */
+    Eigen::MatrixXd                     m_matProjectorsInnerind; /**< The projectors restricted to the good inner layer channels. */
+    SensorInfo                          m_sensors;              /**< The sensor structure of the good inner layer channels. */
+
+    Eigen::VectorXd                     m_vecCoilFreqs;         /**< The coil frequencies the reference was computed for. */
+    double                              m_dSFreq;               /**< The sampling frequency the reference was computed for. */
+    Eigen::MatrixXd                     m_matSimsigPinvT;       /**< Transposed pseudoinverse of the sine/cosine reference of one block. */
+    qint64                              m_iSampleCount;         /**< Number of samples since the reference phase origin. */
+
+    int                                 m_iDemodWindow;         /**< The number of blocks the amplitudes are demodulated over. */
+    QVector<Eigen::MatrixXd>            m_vecTopo;              /**< Ring of the phase aligned sine/cosine topographies of the last blocks. */
+    int                                 m_iTopoFirst;           /**< Ring index of the oldest topography. */
+    int                                 m_iTopoCount;           /**< Number of topographies in the ring. */
+    Eigen::MatrixXd                     m_matTopoSum;           /**< Sum of the topographies in the ring. */
+
+    Eigen::MatrixXd                     m_matCoilPos;           /**< The coil positions of the previous fit. */
+    bool                                m_bWarmStart;           /**< Whether the next fit starts from m_matCoilPos. */
 };
 
 //*************************************************************************************************************
@@ -50,6 +50,8 @@
 // Eigen INCLUDES
 //=============================================================================================================
 
+#include <Eigen/Dense>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -111,6 +113,185 @@ void HPIFitData::doDipfitConcurrent()
 }
 
 
+//*************************************************************************************************************
+
+void HPIFitData::doDipfitLevenbergMarquardt(QList<HPIFitData>& lCoilData,
+                                            int iMaxIterations)
+{
+    int iNumCoils = lCoilData.size();
+
+    if(iNumCoils == 0) {
+        return;
+    }
+
+    // All coils share the sensors and the projector, the projector acts on the transformed leadfield, see dipfitError
+    const SensorInfo& sensors = lCoilData.at(0).sensorPos;
+    Eigen::MatrixXd matProj = lCoilData.at(0).matProjector * sensors.tra;
+    int iNumSens = sensors.coilpos.rows();
+
+    Eigen::MatrixXd matPos(iNumCoils, 3);
+    Eigen::MatrixXd matData(iNumSens, iNumCoils);
+
+    for(int k = 0; k < iNumCoils; ++k) {
+        matPos.row(k) = lCoilData.at(k).coilPos;
+        matData.col(k) = lCoilData.at(k).sensorData.transpose();
+    }
+
+    Eigen::MatrixXd matMom = Eigen::MatrixXd::Zero(iNumCoils, 3);
+    Eigen::MatrixXd matField, matJacobian, matFieldTrial;
+
+    // Start with the least squares moments at the starting positions. The moment derivatives are the leadfields.
+    computeDipoleFields(sensors, matPos, matMom, matField, &matJacobian);
+    Eigen::MatrixXd matProjJacobian = matProj * matJacobian;
+
+    for(int k = 0; k < iNumCoils; ++k) {
+        Eigen::MatrixXd matLf(iNumSens, 3);
+        for(int j = 0; j < 3; ++j) {
+            matLf.col(j) = matProjJacobian.col((j+3)*iNumCoils + k);
+        }
+
+        matMom.row(k) = (matLf.transpose() * matLf).ldlt().solve(matLf.transpose() * matData.col(k)).transpose();
+    }
+
+    computeDipoleFields(sensors, matPos, matMom, matField);
+    Eigen::VectorXd vecCost = (matData - matProj * matField).colwise().squaredNorm().transpose();
+
+    Eigen::VectorXd vecLambda = Eigen::VectorXd::Constant(iNumCoils, 1e-3);
+    Eigen::VectorXi vecNumIterations = Eigen::VectorXi::Zero(iNumCoils);
+    QList<bool> lActive;
+    for(int k = 0; k < iNumCoils; ++k) {
+        lActive << true;
+    }
+
+    Eigen::MatrixXd matPosTrial(iNumCoils, 3);
+    Eigen::MatrixXd matMomTrial(iNumCoils, 3);
+    Eigen::MatrixXd matJk(iNumSens, 6);
+    Eigen::MatrixXd matJtJ(6, 6);
+    Eigen::VectorXd vecStep(6);
+
+    for(int iIter = 0; iIter < iMaxIterations && lActive.contains(true); ++iIter) {
+        computeDipoleFields(sensors, matPos, matMom, matField, &matJacobian);
+        matProjJacobian.noalias() = matProj * matJacobian;
+        Eigen::MatrixXd matResidual = matData - matProj * matField;
+
+        matPosTrial = matPos;
+        matMomTrial = matMom;
+
+        // Damped Gauss-Newton step per coil
+        for(int k = 0; k < iNumCoils; ++k) {
+            if(!lActive.at(k)) {
+                continue;
+            }
+
+            for(int j = 0; j < 6; ++j) {
+                matJk.col(j) = matProjJacobian.col(j*iNumCoils + k);
+            }
+
+            matJtJ.noalias() = matJk.transpose() * matJk;
+            matJtJ.diagonal() *= 1.0 + vecLambda(k);
+            vecStep = matJtJ.ldlt().solve(matJk.transpose() * matResidual.col(k));
+
+            matPosTrial.row(k) += vecStep.head(3).transpose();
+            matMomTrial.row(k) += vecStep.tail(3).transpose();
+        }
+
+        // Evaluate all trial steps in one pass
+        computeDipoleFields(sensors, matPosTrial, matMomTrial, matFieldTrial);
+        Eigen::VectorXd vecCostTrial = (matData - matProj * matFieldTrial).colwise().squaredNorm().transpose();
+
+        for(int k = 0; k < iNumCoils; ++k) {
+            if(!lActive.at(k)) {
+                continue;
+            }
+
+            vecNumIterations(k)++;
+
+            if(vecCostTrial(k) < vecCost(k)) {
+                double dStep = (matPosTrial.row(k) - matPos.row(k)).norm();
+                double dDecrease = (vecCost(k) - vecCostTrial(k)) / vecCost(k);
+
+                matPos.row(k) = matPosTrial.row(k);
+                matMom.row(k) = matMomTrial.row(k);
+                vecCost(k) = vecCostTrial(k);
+                vecLambda(k) /= 10.0;
+
+                if(dStep < 1e-9 || dDecrease < 1e-12) {
+                    lActive[k] = false;
+                }
+            } else {
+                vecLambda(k) *= 10.0;
+
+                if(vecLambda(k) > 1e10) {
+                    lActive[k] = false;
+                }
+            }
+        }
+    }
+
+    for(int k = 0; k < iNumCoils; ++k) {
+        HPIFitData& coilData = lCoilData[k];
+        Eigen::VectorXd vecData = coilData.sensorData.transpose();
+
+        coilData.coilPos = matPos.row(k);
+        coilData.errorInfo = coilData.dipfitError(coilData.coilPos, vecData, coilData.sensorPos, coilData.matProjector);
+        coilData.errorInfo.numIterations = vecNumIterations(k);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void HPIFitData::computeDipoleFields(const struct SensorInfo& sensors,
+                                     const Eigen::MatrixXd& matPos,
+                                     const Eigen::MatrixXd& matMom,
+                                     Eigen::MatrixXd& matField,
+                                     Eigen::MatrixXd* pMatJacobian)
+{
+    // Same constant as magnetic_dipole
+    const double c = 1e-7 / (4 * M_PI);
+
+    int iNumSens = sensors.coilpos.rows();
+    int iNumDip = matPos.rows();
+
+    // Sensors x dipoles arrays of the distance vectors, orientations and moments
+    Eigen::ArrayXXd d[3], o[3], m[3];
+
+    for(int j = 0; j < 3; ++j) {
+        d[j] = sensors.coilpos.col(j).replicate(1, iNumDip).array() - matPos.col(j).transpose().replicate(iNumSens, 1).array();
+        o[j] = sensors.coilori.col(j).replicate(1, iNumDip).array();
+        m[j] = matMom.col(j).transpose().replicate(iNumSens, 1).array();
+    }
+
+    Eigen::ArrayXXd r2 = d[0].square() + d[1].square() + d[2].square();
+    Eigen::ArrayXXd ir2 = r2.inverse();
+    Eigen::ArrayXXd ir5 = ir2.square() * r2.sqrt().inverse();
+
+    Eigen::ArrayXXd od = o[0]*d[0] + o[1]*d[1] + o[2]*d[2];
+    Eigen::ArrayXXd md = m[0]*d[0] + m[1]*d[1] + m[2]*d[2];
+    Eigen::ArrayXXd mo = m[0]*o[0] + m[1]*o[1] + m[2]*o[2];
+
+    // B.o = c * (3 (m.d)(o.d) - (m.o) r^2) / r^5
+    Eigen::ArrayXXd num = 3.0*md*od - mo*r2;
+    matField = (c * num * ir5).matrix();
+
+    if(!pMatJacobian) {
+        return;
+    }
+
+    pMatJacobian->resize(iNumSens, 6*iNumDip);
+
+    Eigen::ArrayXXd h = 5.0 * num * ir5 * ir2;
+
+    for(int j = 0; j < 3; ++j) {
+        // Position derivative, the distance vector changes with the negative position
+        pMatJacobian->middleCols(j*iNumDip, iNumDip) = (-c * ((3.0*od*m[j] + 3.0*md*o[j] - 2.0*mo*d[j]) * ir5 - h*d[j])).matrix();
+
+        // Moment derivative, which is the leadfield
+        pMatJacobian->middleCols((j+3)*iNumDip, iNumDip) = (c * (3.0*od*d[j] - o[j]*r2) * ir5).matrix();
+    }
+}
+
+
 //*************************************************************************************************************
 
 Eigen::MatrixXd HPIFitData::magnetic_dipole(Eigen::MatrixXd pos, Eigen::MatrixXd pnt, Eigen::MatrixXd ori)
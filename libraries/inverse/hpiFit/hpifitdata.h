@@ -58,6 +58,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -145,6 +146,20 @@ public:
     */
     void doDipfitConcurrent();
 
+    //=========================================================================================================
+    /**
+    * Fits the dipoles of all coils with a Levenberg-Marquardt iteration on the dipole positions and moments.
+    * The fields of all coils and their analytic Jacobians are evaluated together in one pass over the sensor
+    * arrays. All coils need to share the same sensors and projector. The coil positions are used as starting
+    * points and replaced by the fitted ones, the error info is evaluated with dipfitError at the fitted positions
+    * and holds the number of iterations.
+    *
+    * @param[in, out] lCoilData     The data of all coils
+    * @param[in] iMaxIterations     The maximal number of iterations
+    */
+    static void doDipfitLevenbergMarquardt(QList<HPIFitData>& lCoilData,
+                                           int iMaxIterations = 100);
+
     Eigen::RowVectorXd  coilPos;
     Eigen::RowVectorXd  sensorData;
     DipFitError         errorInfo;
@@ -170,6 +185,24 @@ protected:
     */
     Eigen::MatrixXd compute_leadfield(const Eigen::MatrixXd& pos, const struct SensorInfo& sensors);
 
+    //=========================================================================================================
+    /**
+    * Computes the fields of several magnetic dipoles at the sensors, see magnetic_dipole, and optionally their
+    * derivatives with respect to the dipole positions and moments.
+    *
+    * @param[in] sensors        The sensors. The sensor transformation is not applied.
+    * @param[in] matPos         The dipole positions (dipoles x 3)
+    * @param[in] matMom         The dipole moments (dipoles x 3)
+    * @param[out] matField      The fields (sensors x dipoles)
+    * @param[out] pMatJacobian  If not null, the derivatives (sensors x 6*dipoles). The derivative of dipole k by
+    *                           parameter j (x, y, z position, x, y, z moment) is stored in column j*dipoles+k.
+    */
+    static void computeDipoleFields(const struct SensorInfo& sensors,
+                                    const Eigen::MatrixXd& matPos,
+                                    const Eigen::MatrixXd& matMom,
+                                    Eigen::MatrixXd& matField,
+                                    Eigen::MatrixXd* pMatJacobian = 0);
+
     //=========================================================================================================
     /**
     * dipfitError computes the error between measured and model data
@@ -50,6 +50,7 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <cmath>
 
 
 //*************************************************************************************************************
@@ -70,6 +71,30 @@ using namespace MNELIB;
 using namespace INVERSELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+/**
+* Pools the x, y and z components of each source by their norm in one pass over the kernel output.
+*/
+template<typename T>
+static void minimumNormPoolOrientations(const Matrix<T, Dynamic, Dynamic> &matKernelOut, MatrixXd &matSourceData)
+{
+    const qint32 iNumSources = matKernelOut.rows() / 3;
+    matSourceData.resize(iNumSources, matKernelOut.cols());
+
+    for(qint32 t = 0; t < matKernelOut.cols(); ++t)
+    {
+        const T* pIn = matKernelOut.col(t).data();
+        double* pOut = matSourceData.col(t).data();
+        for(qint32 i = 0; i < iNumSources; ++i, pIn += 3)
+            pOut[i] = std::sqrt((double)(pIn[0]*pIn[0] + pIn[1]*pIn[1] + pIn[2]*pIn[2]));
+    }
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -78,6 +103,8 @@ using namespace INVERSELIB;
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, const QString method)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bPoolOrientations(false)
+, m_bSinglePrecision(false)
 {
     this->setRegularization(lambda);
     this->setMethod(method);
@@ -88,6 +115,8 @@ MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lamb
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, bool dSPM, bool sLORETA)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bPoolOrientations(false)
+, m_bSinglePrecision(false)
 {
     this->setRegularization(lambda);
     this->setMethod(dSPM, sLORETA);
@@ -206,62 +235,195 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
         return MNESourceEstimate();
     }
 
-    MatrixXd sol = K * data; //apply imaging kernel
+    MatrixXd sol;
+    MatrixXd matKernelOut;
+    applyKernel(m_matKernelRT, data, matKernelOut, sol);
+
+    return MNESourceEstimate(sol, m_vecVertices, tmin, tstep);
+
+}
+
+
+//*************************************************************************************************************
 
-    if (inv.source_ori == FIFFV_MNE_FREE_ORI)
+void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
+{
+    //
+    //   Set up the inverse according to the parameters
+    //
+    inv = m_inverseOperator.prepare_inverse_operator(nave, m_fLambda, m_bdSPM, m_bsLORETA);
+
+    printf("Computing inverse...");
+    inv.assemble_kernel(label, m_sMethod, pick_normal, K, noise_norm, vertno);
+
+    std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
+
+    //
+    //   Precompose the realtime kernel: the noise normalization is diagonal with one factor per source, which is
+    //   positive and therefore commutes with the norm of the free orientations
+    //
+    m_bPoolOrientations = (inv.source_ori == FIFFV_MNE_FREE_ORI && !pick_normal);
+    qint32 iOri = m_bPoolOrientations ? 3 : 1;
+
+    m_matKernelRT = K;
+    if(noise_norm.nonZeros() > 0)
     {
-        printf("combining the current components...");
-        MatrixXd sol1(sol.rows()/3,sol.cols());
-        for(qint32 i = 0; i < sol.cols(); ++i)
+        if(noise_norm.rows()*iOri != K.rows())
         {
-            VectorXd* tmp = MNEMath::combine_xyz(sol.block(0,i,sol.rows(),1));
-            sol1.block(0,i,sol.rows()/3,1) = tmp->cwiseSqrt();
-            delete tmp;
+            qWarning() << "MinimumNorm::doInverseSetup - Dimension mismatch between noise normalization and kernel -" << noise_norm.rows() << "and" << K.rows();
+        }
+        else
+        {
+            for (qint32 k = 0; k < noise_norm.outerSize(); ++k)
+                for (SparseMatrix<double>::InnerIterator it(noise_norm,k); it; ++it)
+                    if(it.row() == it.col())
+                        m_matKernelRT.middleRows(it.row()*iOri, iOri) *= it.value();
         }
-        sol.resize(sol1.rows(),sol1.cols());
-        sol = sol1;
     }
 
-    if (m_bdSPM)
+    m_vecVertices.resize(inv.src[0].vertno.size() + inv.src[1].vertno.size());
+    m_vecVertices << inv.src[0].vertno, inv.src[1].vertno;
+
+    inverseSetup = true;
+
+    updateRealtimeKernel();
+}
+
+
+//*************************************************************************************************************
+
+bool MinimumNorm::applyInverse(const MatrixXd &data, MatrixXd &matSourceData)
+{
+    if(!inverseSetup)
     {
-        printf("(dSPM)...");
-        sol = inv.noisenorm*sol;
+        qWarning("MinimumNorm::applyInverse - Inverse not setup -> call doInverseSetup first!");
+        return false;
+    }
+
+    if(m_matKernelRT.cols() != data.rows()) {
+        qWarning() << "MinimumNorm::applyInverse - Dimension mismatch between kernel columns and data.rows() -" << m_matKernelRT.cols() << "and" << data.rows();
+        return false;
     }
-    else if (m_bsLORETA)
+
+    if(m_bSinglePrecision)
     {
-        printf("(sLORETA)...");
-        sol = inv.noisenorm*sol;
+        m_matDataF = data.cast<float>();
+
+        m_matKernelOutF.resize(m_matKernelSelF.rows(), data.cols());
+        m_matKernelOutF.noalias() = m_matKernelSelF * m_matDataF;
+
+        if(m_bPoolOrientations)
+        {
+            minimumNormPoolOrientations(m_matKernelOutF, matSourceData);
+        }
+        else
+        {
+            matSourceData = m_matKernelOutF.cast<double>();
+        }
+    }
+    else
+    {
+        applyKernel(m_vecSourceSel.size() > 0 ? m_matKernelSel : m_matKernelRT, data, m_matKernelOut, matSourceData);
     }
-    printf("[done]\n");
 
-    //Results
-    VectorXi p_vecVertices(inv.src[0].vertno.size() + inv.src[1].vertno.size());
-    p_vecVertices << inv.src[0].vertno, inv.src[1].vertno;
+    return true;
+}
 
-//    VectorXi p_vecVertices();
-//    for(qint32 h = 0; h < inv.src.size(); ++h)
-//        t_qListVertices.push_back(inv.src[h].vertno);
 
-    return MNESourceEstimate(sol, p_vecVertices, tmin, tstep);
+//*************************************************************************************************************
+
+void MinimumNorm::setSourceSelection(const VectorXi &vecSourceSel)
+{
+    m_vecSourceSel = vecSourceSel;
 
+    if(inverseSetup)
+        updateRealtimeKernel();
 }
 
 
 //*************************************************************************************************************
 
-void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
+void MinimumNorm::setSourceSelection(const QList<Label> &qListLabels)
 {
-    //
-    //   Set up the inverse according to the parameters
-    //
-    inv = m_inverseOperator.prepare_inverse_operator(nave, m_fLambda, m_bdSPM, m_bsLORETA);
+    setSourceSelection(m_inverseOperator.src.label_src_sel(qListLabels));
+}
 
-    printf("Computing inverse...");
-    inv.assemble_kernel(label, m_sMethod, pick_normal, K, noise_norm, vertno);
 
-    std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
+//*************************************************************************************************************
 
-    inverseSetup = true;
+void MinimumNorm::setSinglePrecision(bool bSinglePrecision)
+{
+    m_bSinglePrecision = bSinglePrecision;
+
+    if(inverseSetup)
+        updateRealtimeKernel();
+}
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::applyKernel(const MatrixXd &matKernel, const MatrixXd &data, MatrixXd &matKernelOut, MatrixXd &matSourceData) const
+{
+    if(!m_bPoolOrientations)
+    {
+        matSourceData.resize(matKernel.rows(), data.cols());
+        matSourceData.noalias() = matKernel * data;
+        return;
+    }
+
+    matKernelOut.resize(matKernel.rows(), data.cols());
+    matKernelOut.noalias() = matKernel * data;
+
+    minimumNormPoolOrientations(matKernelOut, matSourceData);
+}
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::updateRealtimeKernel()
+{
+    qint32 iOri = m_bPoolOrientations ? 3 : 1;
+    qint32 iNumSources = m_matKernelRT.rows() / iOri;
+
+    for(qint32 i = 0; i < m_vecSourceSel.size(); ++i)
+    {
+        if(m_vecSourceSel[i] < 0 || m_vecSourceSel[i] >= iNumSources)
+        {
+            qWarning() << "MinimumNorm::updateRealtimeKernel - Source selection index" << m_vecSourceSel[i] << "out of range, selecting all" << iNumSources << "sources.";
+            m_vecSourceSel.resize(0);
+            break;
+        }
+    }
+
+    //Copy the selected rows, all rows of a source are contiguous
+    if(m_vecSourceSel.size() > 0)
+    {
+        m_matKernelSel.resize(m_vecSourceSel.size()*iOri, m_matKernelRT.cols());
+        m_vecVerticesSel.resize(m_vecSourceSel.size());
+
+        for(qint32 i = 0; i < m_vecSourceSel.size(); ++i)
+        {
+            m_matKernelSel.middleRows(i*iOri, iOri) = m_matKernelRT.middleRows(m_vecSourceSel[i]*iOri, iOri);
+            m_vecVerticesSel[i] = m_vecVertices[m_vecSourceSel[i]];
+        }
+    }
+    else
+    {
+        m_matKernelSel.resize(0, 0);
+        m_vecVerticesSel = m_vecVertices;
+    }
+
+    if(m_bSinglePrecision)
+    {
+        m_matKernelSelF = m_vecSourceSel.size() > 0 ? m_matKernelSel.cast<float>() : m_matKernelRT.cast<float>();
+
+        //The double precision rows are not needed by the realtime apply path anymore
+        m_matKernelSel.resize(0, 0);
+    }
+    else
+    {
+        m_matKernelSelF.resize(0, 0);
+    }
 }
 
 
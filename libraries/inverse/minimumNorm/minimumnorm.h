@@ -129,6 +129,64 @@ public:
 
     virtual void doInverseSetup(qint32 nave, bool pick_normal = false);
 
+    //=========================================================================================================
+    /**
+    * Realtime apply path. Multiplies the data with the precomposed kernel, in which the noise normalization is
+    * already folded in, and pools the free orientations within a single pass over the kernel output. The
+    * results are written into the caller-provided source matrix, which is only resized if its dimensions do
+    * not match, so that reusing it across blocks avoids any allocation. Call doInverseSetup first.
+    *
+    * Only the rows of the source selection are computed, see setSourceSelection, and the single precision
+    * kernel is used if enabled, see setSinglePrecision.
+    *
+    * @param[in] data               The data matrix (channels x samples), picked as the inverse operator channels.
+    * @param[out] matSourceData     The source estimate (selected sources x samples).
+    *
+    * @return true if successful, false otherwise.
+    */
+    bool applyInverse(const MatrixXd &data, MatrixXd &matSourceData);
+
+    //=========================================================================================================
+    /**
+    * Restricts the realtime apply path to a set of source points. An empty selection computes all sources.
+    *
+    * @param[in] vecSourceSel   Indices of the source points of both hemispheres, i.e. indices into getVertices.
+    */
+    void setSourceSelection(const VectorXi &vecSourceSel);
+
+    //=========================================================================================================
+    /**
+    * Restricts the realtime apply path to the source points covered by the labels.
+    *
+    * @param[in] qListLabels    ROIs, see MNESourceSpace::label_src_sel.
+    */
+    void setSourceSelection(const QList<Label> &qListLabels);
+
+    //=========================================================================================================
+    /**
+    * Sets whether the realtime apply path uses a single precision kernel. This halves the memory traffic of
+    * the kernel, the source estimates are still returned in double precision.
+    *
+    * @param[in] bSinglePrecision   Whether to use the single precision kernel.
+    */
+    void setSinglePrecision(bool bSinglePrecision);
+
+    //=========================================================================================================
+    /**
+    * Get the vertices of the source estimates computed by the prepared inverse operator.
+    *
+    * @return the vertices of both hemispheres
+    */
+    inline const VectorXi& getVertices() const;
+
+    //=========================================================================================================
+    /**
+    * Get the vertices of the source estimates computed by applyInverse.
+    *
+    * @return the vertices of the selected sources
+    */
+    inline const VectorXi& getSelectedVertices() const;
+
 
     virtual const char* getName() const;
 
@@ -170,6 +228,24 @@ public:
     inline MatrixXd& getKernel();
 
 private:
+    //=========================================================================================================
+    /**
+    * Applies a precomposed kernel and pools the orientations.
+    *
+    * @param[in] matKernel          The kernel to apply.
+    * @param[in] data               The data matrix (channels x samples).
+    * @param[out] matKernelOut      Buffer for the kernel output, only used for free orientations.
+    * @param[out] matSourceData     The source estimate (sources x samples).
+    */
+    void applyKernel(const MatrixXd &matKernel, const MatrixXd &data, MatrixXd &matKernelOut, MatrixXd &matSourceData) const;
+
+    //=========================================================================================================
+    /**
+    * Builds the kernel of the realtime apply path from the precomposed kernel, the source selection and the
+    * precision.
+    */
+    void updateRealtimeKernel();
+
     MNEInverseOperator m_inverseOperator;   /**< The inverse operator */
     float m_fLambda;                        /**< Regularization parameter */
     QString m_sMethod;                      /**< Selected method */
@@ -183,6 +259,19 @@ private:
     Label label;                            /**< The corresponding labels */
     MatrixXd K;                             /**< Imaging kernel */
 
+    MatrixXd m_matKernelRT;                 /**< Imaging kernel with the noise normalization folded in */
+    MatrixXd m_matKernelOut;                /**< Preallocated kernel output of the realtime apply path */
+    VectorXi m_vecVertices;                 /**< The vertices of both hemispheres */
+    bool m_bPoolOrientations;               /**< Whether the free orientations are pooled by their norm */
+
+    VectorXi m_vecSourceSel;                /**< Selected source points of the realtime apply path, empty for all */
+    VectorXi m_vecVerticesSel;              /**< The vertices of the selected source points */
+    bool m_bSinglePrecision;                /**< Whether the realtime apply path uses the single precision kernel */
+    MatrixXd m_matKernelSel;                /**< Selected rows of the precomposed kernel, empty if all are selected */
+    MatrixXf m_matKernelSelF;               /**< Single precision kernel of the selected rows */
+    MatrixXf m_matDataF;                    /**< Preallocated single precision data */
+    MatrixXf m_matKernelOutF;               /**< Preallocated single precision kernel output */
+
 };
 
 //*************************************************************************************************************
@@ -196,6 +285,22 @@ inline MatrixXd& MinimumNorm::getKernel()
 }
 
 
+//*************************************************************************************************************
+
+inline const VectorXi& MinimumNorm::getVertices() const
+{
+    return m_vecVertices;
+}
+
+
+//*************************************************************************************************************
+
+inline const VectorXi& MinimumNorm::getSelectedVertices() const
+{
+    return m_vecVerticesSel;
+}
+
+
 //*************************************************************************************************************
 
 inline MNEInverseOperator& MinimumNorm::getPreparedInverseOperator()
@@ -239,8 +239,8 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
                     //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
                     MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
 
-                    int idx1 = m_ppPairIdxCombinations[k]->x1;
-                    int idx2 = m_ppPairIdxCombinations[k]->x2;
+                    int idx1, idx2;
+                    RapMusic::getPointPair(m_iNumGridPoints, k, idx1, idx2);
 
                     RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
 
@@ -279,8 +279,7 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
             {
                 t_iMaxIdx_old = t_iMaxIdx;
                 //get positions in sparsed leadfield from index combinations;
-                t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
-                t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
+                RapMusic::getPointPair(m_iNumGridPoints, (int)t_iMaxIdx, t_iIdx1, t_iIdx2);
             }
 
 
@@ -41,6 +41,24 @@
 
 #include <utils/mnemath.h>
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Eigenvalues>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -65,7 +83,6 @@ RapMusic::RapMusic()
 , m_iNumGridPoints(0)
 , m_iNumChannels(0)
 , m_iNumLeadFieldCombinations(0)
-, m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
 , m_iSamplesStcWindow(-1)
@@ -82,7 +99,6 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 , m_iNumGridPoints(0)
 , m_iNumChannels(0)
 , m_iNumLeadFieldCombinations(0)
-, m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
 , m_iSamplesStcWindow(-1)
@@ -97,8 +113,6 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 
 RapMusic::~RapMusic()
 {
-    if(m_ppPairIdxCombinations != NULL)
-        free(m_ppPairIdxCombinations);
 }
 
 
@@ -153,20 +167,9 @@ bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, doubl
 
     m_ForwardSolution = p_pFwd;
 
-    //##### Calc lead field combination #####
-
-    std::cout << "Calculate gain matrix combinations. \n";
-
+    //The gain matrix pair indices are computed on the fly by getPointPair
     m_iNumLeadFieldCombinations = MNEMath::nchoose2(m_iNumGridPoints+1);
 
-    m_ppPairIdxCombinations = (Pair **)malloc(m_iNumLeadFieldCombinations * sizeof(Pair *));
-
-    calcPairCombinations(m_iNumGridPoints, m_iNumLeadFieldCombinations, m_ppPairIdxCombinations);
-
-    std::cout << "Gain matrix combinations calculated. \n\n";
-
-    //##### Calc lead field combination end #####
-
     std::cout << "Number of grid points: " << m_iNumGridPoints << "\n\n";
 
     std::cout << "Number of combinated points: " << m_iNumLeadFieldCombinations << "\n\n";
@@ -469,54 +472,16 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         MatrixXT t_matU_B;
         useFullRank(t_svdProj_Phi_S.matrixU(), t_svdProj_Phi_S.singularValues().asDiagonal(), t_matU_B);
 
-        //Inits
-        VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
-        t_vecRoh.setZero();
-
         //subcorr benchmark
         //Stop the time
         clock_t start_subcorr, end_subcorr;
         start_subcorr = clock();
 
-        //Multithreading correlation calculation
-        #ifdef _OPENMP
-        #pragma omp parallel num_threads(m_iMaxNumThreads)
-        #endif
-        {
-        #ifdef _OPENMP
-        #pragma omp for
-        #endif
-            for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
-            {
-                //new Version: calculate matrix multiplication before
-                //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
-
-                int idx1 = m_ppPairIdxCombinations[i]->x1;
-                int idx2 = m_ppPairIdxCombinations[i]->x2;
-
-                RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
+        //Scan all pair combinations for the maximal correlation ^roh_k
+        int t_iIdx1 = 0;
+        int t_iIdx2 = 0;
 
-                t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
-            }
-        }
-
-
-//         if(r==0)
-//         {
-//             std::fstream filestr;
-//             std::stringstream filename;
-//             filename << "Roh_gold.txt";
-//
-//             filestr.open ( filename.str().c_str(), std::fstream::out);
-//             for(int i = 0; i < m_iNumLeadFieldCombinations; ++i)
-//             {
-//               filestr << t_vecRoh(i) << "\n";
-//             }
-//             filestr.close();
-//
-//             //exit(0);
-//         }
+        double t_val_roh_k = scanPairs(t_matProj_LeadField, t_matU_B, t_iIdx1, t_iIdx2);
 
         //subcorr benchmark
         end_subcorr = clock();
@@ -524,17 +489,6 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         float t_fSubcorrElapsedTime = ( (float)(end_subcorr-start_subcorr) / (float)CLOCKS_PER_SEC ) * 1000.0f;
         std::cout << "Time Elapsed: " << t_fSubcorrElapsedTime << " ms" << std::endl;
 
-        //Find the maximum of correlation - can't put this in the for loop because it's running in different threads.
-        double t_val_roh_k;
-
-        VectorXT::Index t_iMaxIdx;
-
-        t_val_roh_k = t_vecRoh.maxCoeff(&t_iMaxIdx);//p_vecCor = ^roh_k
-
-        //get positions in sparsed leadfield from index combinations;
-        int t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
-        int t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
-
         // (Idx+1) because of MATLAB positions -> starting with 1 not with 0
         std::cout << "Iteration: " << r+1 << " of " << t_iMaxSearch
             << "; Correlation: " << t_val_roh_k<< "; Position (Idx+1): " << t_iIdx1+1 << " - " << t_iIdx2+1 <<"\n\n";
@@ -674,6 +628,152 @@ double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B)
 }
 
 
+//*************************************************************************************************************
+
+double RapMusic::subcorrGram(const Matrix6T& p_matGram, const Matrix6T& p_matCorr)
+{
+    //Eigen decomposition of the Gram matrix -> eigenvalues are the squared singular values of the pair, ascending
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigGram(p_matGram);
+    const Vector6T& t_vecLambda_A = t_eigGram.eigenvalues();
+
+    //lt. Mosher 1998: Only Retain those Components of U_A that correspond to nonzero singular values (> 10^-5, see
+    //getRank) -> the largest component is always retained. U_A = G*V_A*Sigma_A^-1 = G*t_matW
+    Matrix6T t_matW = Matrix6T::Zero();
+    for(int k = 5; k >= 0; --k)
+    {
+        if(k < 5 && t_vecLambda_A(k) <= 0.0000000001)
+            break;
+        if(t_vecLambda_A(k) > 0)
+            t_matW.col(k) = t_eigGram.eigenvectors().col(k) / std::sqrt(t_vecLambda_A(k));
+    }
+
+    //Step 2: the squared singular values of C = U_A^T * U_B are the eigenvalues of U_A^T*U_B*U_B^T*U_A
+    Matrix6T t_matCorCor = t_matW.transpose() * p_matCorr * t_matW;
+
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigCor(t_matCorCor, Eigen::EigenvaluesOnly);
+
+    //Step 3: Take only the correlation of the first principal components
+    double t_dLambda_C = t_eigCor.eigenvalues()(5);
+
+    return t_dLambda_C > 0 ? std::sqrt(t_dLambda_C) : 0;
+}
+
+
+//*************************************************************************************************************
+
+double RapMusic::scanPairs( const MatrixXT& p_matProj_LeadField,
+                            const MatrixXT& p_matU_B,
+                            int &p_iIdx1,
+                            int &p_iIdx2) const
+{
+    const int t_iTile = RAPMUSIC_SCAN_TILE_POINTS;
+    const int t_iNumTiles = (m_iNumGridPoints + t_iTile - 1) / t_iTile;
+    const int t_iNumTileCombinations = MNEMath::nchoose2(t_iNumTiles+1);
+
+    //Correlation of the projected Lead Field with the signal subspace: U_B^T*G for all grid points
+    MatrixXT t_matCorrLeadField(p_matU_B.cols(), p_matProj_LeadField.cols());
+    t_matCorrLeadField.noalias() = p_matU_B.transpose() * p_matProj_LeadField;
+
+    //3 x 3 diagonal blocks G_i^T*G_i and G_i^T*U_B*U_B^T*G_i of each grid point
+    MatrixXT t_matGramDiag(3, p_matProj_LeadField.cols());
+    MatrixXT t_matCorrDiag(3, p_matProj_LeadField.cols());
+
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(m_iMaxNumThreads)
+    #endif
+    for(int i = 0; i < m_iNumGridPoints; ++i)
+    {
+        t_matGramDiag.middleCols<3>(3*i).noalias() = p_matProj_LeadField.middleCols<3>(3*i).transpose() * p_matProj_LeadField.middleCols<3>(3*i);
+        t_matCorrDiag.middleCols<3>(3*i).noalias() = t_matCorrLeadField.middleCols<3>(3*i).transpose() * t_matCorrLeadField.middleCols<3>(3*i);
+    }
+
+    double t_dMaxCor = -1.0;
+    p_iIdx1 = 0;
+    p_iIdx2 = 0;
+
+    //Multithreading correlation calculation over the tile combinations, pairs are ordered like getPointPair
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
+    #endif
+    {
+        MatrixXT t_matGramTile(3*t_iTile, 3*t_iTile);
+        MatrixXT t_matCorrTile(3*t_iTile, 3*t_iTile);
+        Matrix6T t_matGram;
+        Matrix6T t_matCorr;
+
+        double t_dThreadMaxCor = -1.0;
+        int t_iThreadIdx1 = 0;
+        int t_iThreadIdx2 = 0;
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for(int t = 0; t < t_iNumTileCombinations; ++t)
+        {
+            int t_iTile1, t_iTile2;
+            RapMusic::getPointPair(t_iNumTiles, t, t_iTile1, t_iTile2);
+
+            const int i0 = t_iTile1*t_iTile;
+            const int j0 = t_iTile2*t_iTile;
+            const int ni = std::min(t_iTile, m_iNumGridPoints - i0);
+            const int nj = std::min(t_iTile, m_iNumGridPoints - j0);
+
+            //Off-diagonal blocks G_i^T*G_j and G_i^T*U_B*U_B^T*G_j of all pairs within the tile
+            t_matGramTile.topLeftCorner(3*ni, 3*nj).noalias() = p_matProj_LeadField.middleCols(3*i0, 3*ni).transpose() * p_matProj_LeadField.middleCols(3*j0, 3*nj);
+            t_matCorrTile.topLeftCorner(3*ni, 3*nj).noalias() = t_matCorrLeadField.middleCols(3*i0, 3*ni).transpose() * t_matCorrLeadField.middleCols(3*j0, 3*nj);
+
+            for(int a = 0; a < ni; ++a)
+            {
+                const int i = i0 + a;
+
+                t_matGram.topLeftCorner<3,3>() = t_matGramDiag.middleCols<3>(3*i);
+                t_matCorr.topLeftCorner<3,3>() = t_matCorrDiag.middleCols<3>(3*i);
+
+                for(int b = (t_iTile1 == t_iTile2) ? a : 0; b < nj; ++b)
+                {
+                    const int j = j0 + b;
+
+                    t_matGram.topRightCorner<3,3>() = t_matGramTile.block<3,3>(3*a, 3*b);
+                    t_matGram.bottomLeftCorner<3,3>() = t_matGramTile.block<3,3>(3*a, 3*b).transpose();
+                    t_matGram.bottomRightCorner<3,3>() = t_matGramDiag.middleCols<3>(3*j);
+
+                    t_matCorr.topRightCorner<3,3>() = t_matCorrTile.block<3,3>(3*a, 3*b);
+                    t_matCorr.bottomLeftCorner<3,3>() = t_matCorrTile.block<3,3>(3*a, 3*b).transpose();
+                    t_matCorr.bottomRightCorner<3,3>() = t_matCorrDiag.middleCols<3>(3*j);
+
+                    double t_dCor = RapMusic::subcorrGram(t_matGram, t_matCorr);
+
+                    //Keep the first maximum in pair order, as the sequential search does
+                    if(t_dCor > t_dThreadMaxCor
+                       || (t_dCor == t_dThreadMaxCor && (i < t_iThreadIdx1 || (i == t_iThreadIdx1 && j < t_iThreadIdx2))))
+                    {
+                        t_dThreadMaxCor = t_dCor;
+                        t_iThreadIdx1 = i;
+                        t_iThreadIdx2 = j;
+                    }
+                }
+            }
+        }
+
+        //Find the maximum of correlation over all threads
+        #ifdef _OPENMP
+        #pragma omp critical
+        #endif
+        {
+            if(t_dThreadMaxCor > t_dMaxCor
+               || (t_dThreadMaxCor == t_dMaxCor && (t_iThreadIdx1 < p_iIdx1 || (t_iThreadIdx1 == p_iIdx1 && t_iThreadIdx2 < p_iIdx2))))
+            {
+                t_dMaxCor = t_dThreadMaxCor;
+                p_iIdx1 = t_iThreadIdx1;
+                p_iIdx2 = t_iThreadIdx2;
+            }
+        }
+    }
+
+    return t_dMaxCor;
+}
+
+
 //*************************************************************************************************************
 
 double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vector6T& p_vec_phi_k_1)
@@ -810,37 +910,6 @@ void RapMusic::calcOrthProj(const MatrixXT& p_matA_k_1, MatrixXT& p_matOrthProj)
 }
 
 
-//*************************************************************************************************************
-
-void RapMusic::calcPairCombinations(    const int p_iNumPoints,
-                                        const int p_iNumCombinations,
-                                        Pair** p_ppPairIdxCombinations) const
-{
-    int idx1 = 0;
-    int idx2 = 0;
-
-    //Process Code in {m_max_num_threads} threads -> When compile with Intel Compiler -> probably obsolete
-    #ifdef _OPENMP
-    #pragma omp parallel num_threads(m_iMaxNumThreads) private(idx1, idx2)
-    #endif
-    {
-    #ifdef _OPENMP
-    #pragma omp for
-    #endif
-        for (int i = 0; i < p_iNumCombinations; ++i)
-        {
-            RapMusic::getPointPair(p_iNumPoints, i, idx1, idx2);
-
-            Pair* t_pairCombination = new Pair();
-            t_pairCombination->x1 = idx1;
-            t_pairCombination->x2 = idx2;
-
-            p_ppPairIdxCombinations[i] = t_pairCombination;
-        }
-    }
-}
-
-
 //*************************************************************************************************************
 
 void RapMusic::getPointPair(const int p_iPoints, const int p_iCurIdx, int &p_iIdx1, int &p_iIdx2)
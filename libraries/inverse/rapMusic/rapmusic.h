@@ -87,16 +87,7 @@ using namespace MNELIB;
 #define NOT_TRANSPOSED   0  /**< Defines NOT_TRANSPOSED */
 #define IS_TRANSPOSED   1   /**< Defines IS_TRANSPOSED */
 
-
-//=============================================================================================================
-/**
-* Declares a pair structure for index combinations used in RAP MUSIC algorithm.
-*/
-typedef struct Pair
-{
-    int x1; /**< Index one of the pair. */
-    int x2; /**< Index two of the pair. */
-} Pair;
+#define RAPMUSIC_SCAN_TILE_POINTS   64  /**< Number of grid points per tile side of the pair scan. */
 
 
 
@@ -210,6 +201,39 @@ protected:
     */
     static double subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_pMatU_B);
 
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of a Lead Field pair from its Gram matrix and its correlation with the
+    * signal subspace, without materializing the pair. With the projected pair G and the signal subspace U_B,
+    * p_matGram is G^T*G and p_matCorr is G^T*U_B*U_B^T*G. The orthonormal basis U_A of G is expressed as
+    * G*V_A*Sigma_A^-1 from the eigen decomposition of the Gram matrix, using the same rank criterion as
+    * useFullRank, so that the correlation is the square root of the largest eigenvalue of
+    * Sigma_A^-1*V_A^T*p_matCorr*V_A*Sigma_A^-1.
+    *
+    * @param[in] p_matGram  The 6 x 6 Gram matrix G^T*G of the projected Lead Field pair.
+    * @param[in] p_matCorr  The 6 x 6 matrix G^T*U_B*U_B^T*G.
+    * @return   The maximal correlation c_1 of the subspace correlation, equal to subcorr.
+    */
+    static double subcorrGram(const Matrix6T& p_matGram, const Matrix6T& p_matCorr);
+
+    //=========================================================================================================
+    /**
+    * Scans all Lead Field pair combinations for the maximal subspace correlation. The pair indices are
+    * computed implicitly. The pair combinations are processed in tiles of RAPMUSIC_SCAN_TILE_POINTS grid
+    * points, for which the Gram and correlation blocks of all pairs are computed by two matrix products and
+    * distributed across the available threads.
+    *
+    * @param[in] p_matProj_LeadField    The projected Lead Field (channels x 3*grid points).
+    * @param[in] p_matU_B   The matrix U is the subspace projection of the orthogonal projected Phi_s
+    * @param[out] p_iIdx1   First grid index of the maximal correlated pair.
+    * @param[out] p_iIdx2   Second grid index of the maximal correlated pair.
+    * @return   The maximal correlation.
+    */
+    double scanPairs(   const MatrixXT& p_matProj_LeadField,
+                        const MatrixXT& p_matU_B,
+                        int &p_iIdx1,
+                        int &p_iIdx2) const;
+
     //=========================================================================================================
     /**
     * Computes the subspace correlation between the projected G_rho and the projected signal subspace Phi_s, as
@@ -252,21 +276,6 @@ protected:
     */
     void calcOrthProj(const MatrixXT& p_matA_k_1, MatrixXT& p_matOrthProj) const;
 
-    //=========================================================================================================
-    /**
-    * Pre-Calculates the gain matrix index combinations to search for a two dipole independent topography
-    * (IT = source).
-    *
-    * @param[in] p_iNumPoints   The number of Lead Field points -> for dimension check
-    * @param[in] p_iNumCombinations The number of pair index combinations.
-    * @param[out] p_ppPairIdxCombinations   The destination which contains pointer to pointer of index
-    *                                       combinations of Lead Field indices -> Number of pointers =
-    *                                       Combination (number of grid points over 2 = Num + 1 C 2)
-    */
-    void calcPairCombinations(  const int p_iNumPoints,
-                                const int p_iNumCombinations,
-                                Pair** p_ppPairIdxCombinations) const;
-
     //=========================================================================================================
     /**
     * Calculates the combination indices Idx1 and Idx2 of n points.\n
@@ -322,9 +331,8 @@ protected:
 
     int m_iNumGridPoints;               /**< Number of Grid points. */
     int m_iNumChannels;                 /**< Number of channels */
-    int m_iNumLeadFieldCombinations;    /**< Number of Lead Filed combinations (grid points + 1 over 2)*/
-
-    Pair** m_ppPairIdxCombinations; /**< Index combination vector with grid pair indices. */
+    int m_iNumLeadFieldCombinations;    /**< Number of Lead Filed combinations (grid points + 1 over 2), the
+                                             pair indices are computed by getPointPair*/
 
     int m_iMaxNumThreads;   /**< Number of available CPU threads. */
 
@@ -43,12 +43,22 @@
 #include <utils/mnemath.h>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // Qt INCLUDES
 //=============================================================================================================
 
 #include <QPointer>
+#include <QVector>
+#include <QFuture>
 #include <QtConcurrent>
 #include <QDebug>
 
@@ -99,57 +109,27 @@ MNEEpochDataList MNEEpochDataList::readEpochs(const FiffRawData& raw,
 {
     MNEEpochDataList data;
 
-    // Select the desired events
-    qint32 count = 0;
-    qint32 p;
-    MatrixXi selected = MatrixXi::Zero(1, events.rows());
-    for (p = 0; p < events.rows(); ++p)
-    {
-        if (events(p,1) == 0 && events(p,2) == event)
-        {
-            selected(0,count) = p;
-            ++count;
-        }
-    }
-    selected.conservativeResize(1, count);
-    if (count > 0) {
-        printf("%d matching events found\n",count);
-    } else {
-        printf("No desired events found.\n");
+    VectorXi vecFrom, vecTo;
+    RowVectorXi picksNew;
+    qint32 count = selectEpochWindows(raw, events, tmin, tmax, event, picks, vecFrom, vecTo, picksNew);
+    if (count == 0) {
         return MNEEpochDataList();
     }
 
-    // If picks are empty, pick all
-    RowVectorXi picksNew = picks;
-    if(picks.cols() <= 0) {
-        picksNew.resize(raw.info.chs.size());
-        for(int i = 0; i < raw.info.chs.size(); ++i) {
-            picksNew(i) = i;
-        }
-    }
-
-    fiff_int_t event_samp, from, to;
+    fiff_int_t from, to;
     fiff_int_t dropCount = 0;
     MatrixXd timesDummy;
-    MatrixXd times;
 
     MNEEpochData* epoch = Q_NULLPTR;
 
-    for (p = 0; p < count; ++p) {
+    for (qint32 p = 0; p < count; ++p) {
         // Read a data segment
-        event_samp = events(selected(p),0);
-        from = event_samp + tmin*raw.info.sfreq;
-        to   = event_samp + floor(tmax*raw.info.sfreq + 0.5);
+        from = vecFrom[p];
+        to   = vecTo[p];
 
         epoch = new MNEEpochData();
 
         if(raw.read_raw_segment(epoch->epoch, timesDummy, from, to, picksNew)) {
-            if (p == 0) {
-                times.resize(1, to-from+1);
-                for (qint32 i = 0; i < times.cols(); ++i)
-                    times(0, i) = ((float)(from-event_samp+i)) / raw.info.sfreq;
-            }
-
             epoch->event = event;
             epoch->tmin = ((float)(from)-(float)(raw.first_samp))/raw.info.sfreq;
             epoch->tmax = ((float)(to)-(float)(raw.first_samp))/raw.info.sfreq;
@@ -183,6 +163,182 @@ MNEEpochDataList MNEEpochDataList::readEpochs(const FiffRawData& raw,
 }
 
 
+//*************************************************************************************************************
+
+MNEEpochDataList MNEEpochDataList::readEpochsBatched(const FiffRawData& raw,
+                                                     const MatrixXi& events,
+                                                     float tmin,
+                                                     float tmax,
+                                                     qint32 event,
+                                                     double dEOGThreshold,
+                                                     const QString& sChType,
+                                                     const RowVectorXi& picks,
+                                                     float fMaxChunkTime)
+{
+    MNEEpochDataList data;
+
+    VectorXi vecFrom, vecTo;
+    RowVectorXi picksNew;
+    qint32 count = selectEpochWindows(raw, events, tmin, tmax, event, picks, vecFrom, vecTo, picksNew);
+    if (count == 0) {
+        return MNEEpochDataList();
+    }
+
+    struct EpochWindow {
+        qint32 index;
+        fiff_int_t from;
+        fiff_int_t to;
+    };
+
+    QVector<EpochWindow> windows(count);
+    for (qint32 p = 0; p < count; ++p) {
+        windows[p].index = p;
+        windows[p].from = vecFrom[p];
+        windows[p].to = vecTo[p];
+    }
+
+    // Sort the windows so that the raw data is traversed only once
+    std::sort(windows.begin(), windows.end(), [](const EpochWindow& a, const EpochWindow& b) {
+        return a.from < b.from;
+    });
+
+    fiff_int_t iMaxChunkSamples = (fiff_int_t)(fMaxChunkTime * raw.info.sfreq);
+
+    QVector<MNEEpochData::SPtr> epochs(count);
+    QList<QFuture<void> > artifactChecks;
+    MatrixXd chunk;
+    MatrixXd timesDummy;
+
+    qint32 i = 0;
+    while (i < count) {
+        // Merge all overlapping or adjacent windows into one chunk
+        fiff_int_t chunkFrom = windows[i].from;
+        fiff_int_t chunkTo = windows[i].to;
+        qint32 j = i + 1;
+        while (j < count
+               && windows[j].from <= chunkTo + 1
+               && std::max(chunkTo, windows[j].to) - chunkFrom + 1 <= iMaxChunkSamples) {
+            chunkTo = std::max(chunkTo, windows[j].to);
+            ++j;
+        }
+
+        // Read the chunk once, read_raw_segment clamps it to the available samples
+        fiff_int_t readFrom = std::max(chunkFrom, raw.first_samp);
+        fiff_int_t readTo = std::min(chunkTo, raw.last_samp);
+
+        if(readFrom > readTo || !raw.read_raw_segment(chunk, timesDummy, readFrom, readTo, picksNew)) {
+            printf("Can't read the event data segments");
+            i = j;
+            continue;
+        }
+
+        // Scatter the chunk into its epochs
+        for (qint32 k = i; k < j; ++k) {
+            const EpochWindow& window = windows[k];
+            fiff_int_t from = std::max(window.from, readFrom);
+            fiff_int_t to = std::min(window.to, readTo);
+
+            if(from > to) {
+                printf("Can't read the event data segments");
+                continue;
+            }
+
+            MNEEpochData::SPtr epoch = MNEEpochData::SPtr(new MNEEpochData());
+            epoch->epoch = chunk.middleCols(from - readFrom, to - from + 1);
+            epoch->event = event;
+            epoch->tmin = ((float)(window.from)-(float)(raw.first_samp))/raw.info.sfreq;
+            epoch->tmax = ((float)(window.to)-(float)(raw.first_samp))/raw.info.sfreq;
+
+            epochs[window.index] = epoch;
+
+            // The epoch is complete -> check it for artifacts in the background
+            artifactChecks.append(QtConcurrent::run([epoch, &raw, dEOGThreshold, sChType]() {
+                epoch->bReject = checkForArtifact(epoch->epoch,
+                                                  raw.info,
+                                                  dEOGThreshold,
+                                                  "threshold",
+                                                  sChType);
+            }));
+        }
+
+        i = j;
+    }
+
+    for (qint32 k = 0; k < artifactChecks.size(); ++k) {
+        artifactChecks[k].waitForFinished();
+    }
+
+    // Assemble the list in event order
+    fiff_int_t dropCount = 0;
+    for (qint32 k = 0; k < count; ++k) {
+        if(!epochs[k]) {
+            continue;
+        }
+
+        if (epochs[k]->bReject) {
+            dropCount++;
+        }
+
+        //Check if data block has the same size as the previous one
+        if(data.isEmpty() || epochs[k]->epoch.size() == data.last()->epoch.size()) {
+            data.append(epochs[k]);
+        }
+    }
+
+    qDebug() << "Read total of"<< data.size() <<"epochs and dropped"<< dropCount <<"of them";
+
+    return data;
+}
+
+
+//*************************************************************************************************************
+
+qint32 MNEEpochDataList::selectEpochWindows(const FiffRawData& raw,
+                                            const MatrixXi& events,
+                                            float tmin,
+                                            float tmax,
+                                            qint32 event,
+                                            const RowVectorXi& picks,
+                                            VectorXi& vecFrom,
+                                            VectorXi& vecTo,
+                                            RowVectorXi& picksNew)
+{
+    // Select the desired events
+    qint32 count = 0;
+    vecFrom.resize(events.rows());
+    vecTo.resize(events.rows());
+    for (qint32 p = 0; p < events.rows(); ++p)
+    {
+        if (events(p,1) == 0 && events(p,2) == event)
+        {
+            fiff_int_t event_samp = events(p,0);
+            vecFrom[count] = event_samp + tmin*raw.info.sfreq;
+            vecTo[count] = event_samp + floor(tmax*raw.info.sfreq + 0.5);
+            ++count;
+        }
+    }
+    vecFrom.conservativeResize(count);
+    vecTo.conservativeResize(count);
+
+    if (count > 0) {
+        printf("%d matching events found\n",count);
+    } else {
+        printf("No desired events found.\n");
+    }
+
+    // If picks are empty, pick all
+    picksNew = picks;
+    if(picks.cols() <= 0) {
+        picksNew.resize(raw.info.chs.size());
+        for(int i = 0; i < raw.info.chs.size(); ++i) {
+            picksNew(i) = i;
+        }
+    }
+
+    return count;
+}
+
+
 //*************************************************************************************************************
 
 FiffEvoked MNEEpochDataList::average(FiffInfo& info, fiff_int_t first, fiff_int_t last, VectorXi sel, bool proj)
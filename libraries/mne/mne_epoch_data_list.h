@@ -121,6 +121,36 @@ public:
                                        const QString& sChType = QString("eog"),
                                        const Eigen::RowVectorXi& picks = Eigen::RowVectorXi());
 
+    //=========================================================================================================
+    /**
+    * Read the epochs from a raw file based on provided events in a single pass through the raw data.
+    * The event windows are sorted and overlapping or adjacent windows are merged into chunks of at most
+    * fMaxChunkTime seconds. Each chunk is read (and its raw buffers decoded) once and scattered into all epochs
+    * it contains. The artifact check of the epochs of a chunk runs in parallel while the next chunk is read.
+    * The returned list is in event order and equals the one of readEpochs.
+    *
+    * @param[in] raw            The raw data.
+    * @param[in] events         The events provided in samples and event kind.
+    * @param[in] tmin           The start time relative to the event in samples.
+    * @param[in] tmax           The end time relative to the event in samples.
+    * @param[in] event          The event kind.
+    * @param[in] dEOGThreshold  The threshold value to use to reject epochs based on the EOG channel.
+    *                           No filtering is performed on the EOG channel. Default is set to no rejection.
+    *                           The mean is subtracted from the EOG channel data before checking the threshold.
+    * @param[in] sChType        The channel data type to scan for. EEG, MEG or EOG (default is EOG).
+    * @param[in] picks          Which channels to pick.
+    * @param[in] fMaxChunkTime  The maximum length of a merged chunk in seconds (default is 10 seconds).
+    */
+    static MNEEpochDataList readEpochsBatched(const FIFFLIB::FiffRawData& raw,
+                                              const Eigen::MatrixXi& events,
+                                              float tmin,
+                                              float tmax,
+                                              qint32 event,
+                                              double dEOGThreshold = 0.0,
+                                              const QString& sChType = QString("eog"),
+                                              const Eigen::RowVectorXi& picks = Eigen::RowVectorXi(),
+                                              float fMaxChunkTime = 10.0f);
+
     //=========================================================================================================
     /**
     * Averages epoch list.
@@ -171,6 +201,34 @@ public:
 
     static void checkChVariance(ArtifactRejectionData& inputData);
     static void checkChThreshold(ArtifactRejectionData& inputData);
+
+private:
+    //=========================================================================================================
+    /**
+    * Selects the events of the given kind and computes their sample windows, as used by readEpochs and
+    * readEpochsBatched.
+    *
+    * @param[in] raw            The raw data.
+    * @param[in] events         The events provided in samples and event kind.
+    * @param[in] tmin           The start time relative to the event in samples.
+    * @param[in] tmax           The end time relative to the event in samples.
+    * @param[in] event          The event kind.
+    * @param[in] picks          Which channels to pick, empty for all.
+    * @param[out] vecFrom       The first sample of each selected epoch, in event order.
+    * @param[out] vecTo         The last sample of each selected epoch, in event order.
+    * @param[out] picksNew      The channels to read.
+    *
+    * @return   The number of selected events.
+    */
+    static qint32 selectEpochWindows(const FIFFLIB::FiffRawData& raw,
+                                     const Eigen::MatrixXi& events,
+                                     float tmin,
+                                     float tmax,
+                                     qint32 event,
+                                     const Eigen::RowVectorXi& picks,
+                                     Eigen::VectorXi& vecFrom,
+                                     Eigen::VectorXi& vecTo,
+                                     Eigen::RowVectorXi& picksNew);
 };
 
 } // NAMESPACE
@@ -56,6 +56,7 @@
 //=============================================================================================================
 
 #include <QFuture>
+#include <QHash>
 #include <QtConcurrent>
 
 
@@ -185,30 +186,32 @@ bool MNEInverseOperator::assemble_kernel(const Label &label, QString method, boo
 
     if(!label.isEmpty())
     {
-        qDebug() << "ToDo: Label selection needs to be debugged - not done jet!";
         VectorXi src_sel;
         vertno = this->src.label_src_vertno_sel(label, src_sel);
 
         if(method.compare("MNE") != 0)
         {
+            //Map the source indices to the rows of the selection
+            QHash<qint32, qint32> hashSrcSel;
+            hashSrcSel.reserve(src_sel.size());
+            for(qint32 i = 0; i < src_sel.size(); ++i)
+                hashSrcSel.insert(src_sel[i], i);
+
             tripletList.clear();
-            tripletList.reserve(noise_norm.nonZeros());
+            tripletList.reserve(src_sel.size());
 
             for (qint32 k = 0; k < noise_norm.outerSize(); ++k)
             {
                 for (SparseMatrix<double>::InnerIterator it(noise_norm,k); it; ++it)
                 {
-                    //ToDo bad search - increase speed by using stl search
-                    qint32 row = -1;
-                    for(qint32 i = 0; i < src_sel.size(); ++i)
-                        if(src_sel[i] == it.row())
-                            row = i;
-                    if(row != -1)
-                        tripletList.push_back(T(it.row(), it.col(), it.value()));
+                    //The noise normalization is diagonal, keep the selected sources on the diagonal
+                    QHash<qint32, qint32>::const_iterator itSel = hashSrcSel.constFind(it.row());
+                    if(it.row() == it.col() && itSel != hashSrcSel.constEnd())
+                        tripletList.push_back(T(itSel.value(), itSel.value(), it.value()));
                 }
             }
 
-            noise_norm = SparseMatrix<double>(src_sel.size(),noise_norm.cols());
+            noise_norm = SparseMatrix<double>(src_sel.size(),src_sel.size());
             noise_norm.setFromTriplets(tripletList.begin(), tripletList.end());
         }
 
@@ -229,7 +232,7 @@ bool MNEInverseOperator::assemble_kernel(const Label &label, QString method, boo
         for(qint32 i = 0; i < src_sel.size(); ++i)
         {
             t_eigen_leads.row(i) = t_eigen_leads.row(src_sel[i]);
-            t_source_cov = t_source_cov.row(src_sel[i]);
+            t_source_cov.row(i) = t_source_cov.row(src_sel[i]);
         }
         t_eigen_leads.conservativeResize(src_sel.size(), t_eigen_leads.cols());
         t_source_cov.conservativeResize(src_sel.size(), t_source_cov.cols());
@@ -699,27 +702,18 @@ MatrixXd MNEInverseOperator::cluster_kernel(const AnnotationSet &p_AnnotationSet
 
 //*************************************************************************************************************
 
-MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &info,
-                                                             MNEForwardSolution forward,
-                                                             const FiffCov &p_noise_cov,
-                                                             float loose,
-                                                             float depth,
-                                                             bool fixed,
-                                                             bool limit_depth_chs)
+bool MNEInverseOperator::check_inverse_parameters(const MNEForwardSolution &forward,
+                                                  float &loose,
+                                                  float &depth,
+                                                  bool &fixed)
 {
-    bool is_fixed_ori = forward.isFixedOrient();
-    MNEInverseOperator p_MNEInverseOperator;
-
-    std::cout << "ToDo MNEInverseOperator::make_inverse_operator: do surf_ori check" << std::endl;
-
-    //Check parameters
     if(fixed && loose > 0)
     {
         qWarning("Warning: When invoking make_inverse_operator with fixed = true, the loose parameter is ignored.\n");
         loose = 0.0f;
     }
 
-    if(is_fixed_ori && !fixed)
+    if(forward.isFixedOrient() && !fixed)
     {
         qWarning("Warning: Setting fixed parameter = true. Because the given forward operator has fixed orientation and can only be used to make a fixed-orientation inverse operator.\n");
         fixed = true;
@@ -728,7 +722,7 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     if(forward.source_ori == -1 && loose > 0)
     {
         qCritical("Error: Forward solution is not oriented in surface coordinates. loose parameter should be 0 not %f.\n", loose);
-        return p_MNEInverseOperator;
+        return false;
     }
 
     if(loose < 0 || loose > 1)
@@ -745,6 +739,29 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
         printf("Setting depth to %f.\n", depth);
     }
 
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &info,
+                                                             MNEForwardSolution forward,
+                                                             const FiffCov &p_noise_cov,
+                                                             float loose,
+                                                             float depth,
+                                                             bool fixed,
+                                                             bool limit_depth_chs)
+{
+    bool is_fixed_ori = forward.isFixedOrient();
+    MNEInverseOperator p_MNEInverseOperator;
+
+    std::cout << "ToDo MNEInverseOperator::make_inverse_operator: do surf_ori check" << std::endl;
+
+    //Check parameters
+    if(!check_inverse_parameters(forward, loose, depth, fixed))
+        return p_MNEInverseOperator;
+
     //
     // 1. Read the bad channels
     // 2. Read the necessary data from the forward solution matrix file
@@ -821,12 +838,46 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
 
     // 7. Apply fMRI weighting (not done)
 
+    p_MNEInverseOperator = assemble_inverse_operator(info,
+                                                     forward,
+                                                     gain_info,
+                                                     gain,
+                                                     p_outNoiseCov,
+                                                     whitener,
+                                                     n_nzero,
+                                                     p_depth_prior,
+                                                     p_orient_prior,
+                                                     p_source_cov);
+
+    // We set this for consistency with mne C code written inverses
+    if(depth == 0)
+        p_MNEInverseOperator.depth_prior = FiffCov::SDPtr();
+
+    return p_MNEInverseOperator;
+}
+
+
+//*************************************************************************************************************
+
+MNEInverseOperator MNEInverseOperator::assemble_inverse_operator(const FiffInfo &info,
+                                                                 const MNEForwardSolution &forward,
+                                                                 const FiffInfo &gain_info,
+                                                                 const MatrixXd &p_gain,
+                                                                 const FiffCov &noise_cov,
+                                                                 const MatrixXd &whitener,
+                                                                 qint32 n_nzero,
+                                                                 const FiffCov::SDPtr &depth_prior,
+                                                                 const FiffCov::SDPtr &orient_prior,
+                                                                 const FiffCov::SDPtr &source_cov)
+{
+    MNEInverseOperator p_MNEInverseOperator;
+
     //
     // 8. Apply the linear projection to the forward solution
     // 9. Apply whitening to the forward computation matrix
     //
     printf("\tWhitening the forward solution.\n");
-    gain = whitener*gain;
+    MatrixXd gain = whitener*p_gain;
 
     // 10. Exclude the source space points within the labels (not done)
 
@@ -837,6 +888,7 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     // Adjusting Source Covariance matrix to make trace of G*R*G' equal
     // to number of sensors.
     printf("\tAdjusting source covariance matrix.\n");
+    FiffCov::SDPtr p_source_cov = source_cov;
     RowVectorXd source_std = p_source_cov->data.array().sqrt().transpose();
 
     for(qint32 i = 0; i < gain.rows(); ++i)
@@ -914,18 +966,14 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     else
         p_iMethods = FIFFV_MNE_EEG;
 
-    // We set this for consistency with mne C code written inverses
-    if(depth == 0)
-        p_depth_prior = FiffCov::SDPtr();
-
     p_MNEInverseOperator.eigen_fields = p_eigen_fields;
     p_MNEInverseOperator.eigen_leads = p_eigen_leads;
     p_MNEInverseOperator.sing = p_sing;
     p_MNEInverseOperator.nave = p_nave;
-    p_MNEInverseOperator.depth_prior = p_depth_prior;
+    p_MNEInverseOperator.depth_prior = depth_prior;
     p_MNEInverseOperator.source_cov = p_source_cov;
-    p_MNEInverseOperator.noise_cov = FiffCov::SDPtr(new FiffCov(p_outNoiseCov));
-    p_MNEInverseOperator.orient_prior = p_orient_prior;
+    p_MNEInverseOperator.noise_cov = FiffCov::SDPtr(new FiffCov(noise_cov));
+    p_MNEInverseOperator.orient_prior = orient_prior;
     p_MNEInverseOperator.projs = info.projs;
     p_MNEInverseOperator.eigen_leads_weighted = false;
     p_MNEInverseOperator.source_ori = forward.source_ori;
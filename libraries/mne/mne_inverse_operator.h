@@ -283,6 +283,20 @@ public:
     */
     inline bool isFixedOrient() const;
 
+    //=========================================================================================================
+    /**
+    * Checks the parameters of make_inverse_operator against the given forward solution and corrects them where
+    * possible, e.g. fixed is set for a fixed orientation forward solution and loose and depth are clamped to [0, 1].
+    *
+    * @param[in] forward        Forward operator.
+    * @param[in, out] loose     float in [0, 1]. Value that weights the source variances of the dipole components defining the tangent space of the cortical surfaces.
+    * @param[in, out] depth     float in [0, 1]. Depth weighting coefficients.
+    * @param[in, out] fixed     Use fixed source orientations normal to the cortical mantle.
+    *
+    * @return false if the forward solution is not oriented in surface coordinates but loose is greater than 0, true otherwise
+    */
+    static bool check_inverse_parameters(const MNEForwardSolution &forward, float &loose, float &depth, bool &fixed);
+
     //=========================================================================================================
     /**
     * Assembles the inverse operator.
@@ -299,6 +313,36 @@ public:
     */
     static MNEInverseOperator make_inverse_operator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov& p_noise_cov, float loose = 0.2f, float depth = 0.8f, bool fixed = false, bool limit_depth_chs = true);
 
+    //=========================================================================================================
+    /**
+    * Assembles the inverse operator from a prepared forward solution and precomputed source priors. This is the
+    * part of make_inverse_operator which depends on the noise covariance: whitening, source covariance scaling and
+    * SVD. Callers which receive a sequence of noise covariances can keep the priors of the same channel set.
+    *
+    * @param[in] info           The measurement info.
+    * @param[in] forward        Forward operator.
+    * @param[in] gain_info      The info of the gain channels, see MNEForwardSolution::prepare_forward.
+    * @param[in] p_gain         The gain matrix, see MNEForwardSolution::prepare_forward.
+    * @param[in] noise_cov      The prepared noise covariance, see MNEForwardSolution::prepare_forward.
+    * @param[in] whitener       The whitener, see MNEForwardSolution::prepare_forward.
+    * @param[in] n_nzero        Number of non zero noise covariance eigenvalues, see MNEForwardSolution::prepare_forward.
+    * @param[in] depth_prior    The depth prior, see MNEForwardSolution::compute_depth_prior.
+    * @param[in] orient_prior   The orientation prior, empty for fixed orientation, see MNEForwardSolution::compute_orient_prior.
+    * @param[in] source_cov     The source covariance, i.e. the depth prior weighted with the orientation prior.
+    *
+    * @return the assembled inverse operator
+    */
+    static MNEInverseOperator assemble_inverse_operator(const FiffInfo &info,
+                                                        const MNEForwardSolution &forward,
+                                                        const FiffInfo &gain_info,
+                                                        const MatrixXd &p_gain,
+                                                        const FiffCov &noise_cov,
+                                                        const MatrixXd &whitener,
+                                                        qint32 n_nzero,
+                                                        const FiffCov::SDPtr &depth_prior,
+                                                        const FiffCov::SDPtr &orient_prior,
+                                                        const FiffCov::SDPtr &source_cov);
+
     //=========================================================================================================
     /**
     * mne_prepare_inverse_operator
@@ -50,6 +50,7 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <vector>
 
 
 //*************************************************************************************************************
@@ -58,6 +59,7 @@
 //=============================================================================================================
 
 #include <QFile>
+#include <QHash>
 
 
 //*************************************************************************************************************
@@ -135,7 +137,7 @@ QList<VectorXi> MNESourceSpace::label_src_vertno_sel(const Label &p_label, Vecto
     else if (p_label.hemi == 1) //rh
     {
         VectorXi vertno_sel = MNEMath::intersect(vertno[1], p_label.vertices, src_sel);
-        src_sel.array() += p_label.vertices.size();
+        src_sel.array() += vertno[0].size();
         vertno[0] = VectorXi();
         vertno[1] = vertno_sel;
     }
@@ -175,6 +177,82 @@ QList<VectorXi> MNESourceSpace::label_src_vertno_sel(const Label &p_label, Vecto
 }
 
 
+//*************************************************************************************************************
+
+VectorXi MNESourceSpace::label_src_sel(const QList<Label> &p_qListLabels) const
+{
+    if(m_qListHemispheres.size() < 2)
+    {
+        qWarning("MNESourceSpace::label_src_sel - Labels are only supported with surface source spaces of both hemispheres.\n");
+        return VectorXi();
+    }
+
+    qint32 iOffset[2] = {0, (qint32)m_qListHemispheres[0].vertno.size()};
+    std::vector<bool> vecSelected(m_qListHemispheres[0].vertno.size() + m_qListHemispheres[1].vertno.size(), false);
+    qint32 iNumSelected = 0;
+
+    for(qint32 h = 0; h < 2; ++h)
+    {
+        //Build the hash table lazily, only for hemispheres which are covered by a label
+        QHash<qint32, qint32> hashVertno;
+
+        for(qint32 i = 0; i < p_qListLabels.size(); ++i)
+        {
+            if(p_qListLabels[i].hemi != h)
+                continue;
+
+            if(hashVertno.isEmpty())
+            {
+                const VectorXi& vertno = m_qListHemispheres[h].vertno;
+                hashVertno.reserve(vertno.size());
+                for(qint32 k = 0; k < vertno.size(); ++k)
+                    hashVertno.insert(vertno[k], k);
+            }
+
+            const VectorXi& vertices = p_qListLabels[i].vertices;
+            for(qint32 k = 0; k < vertices.size(); ++k)
+            {
+                QHash<qint32, qint32>::const_iterator it = hashVertno.constFind(vertices[k]);
+                if(it != hashVertno.constEnd() && !vecSelected[iOffset[h] + it.value()])
+                {
+                    vecSelected[iOffset[h] + it.value()] = true;
+                    ++iNumSelected;
+                }
+            }
+        }
+    }
+
+    VectorXi src_sel(iNumSelected);
+    qint32 count = 0;
+    for(qint32 i = 0; i < (qint32)vecSelected.size(); ++i)
+        if(vecSelected[i])
+            src_sel[count++] = i;
+
+    return src_sel;
+}
+
+
+//*************************************************************************************************************
+
+VectorXi MNESourceSpace::vertno_src_sel(const VectorXi &p_vecVertices, qint32 p_iHemi) const
+{
+    if(p_iHemi < 0 || p_iHemi > 1)
+    {
+        qWarning("MNESourceSpace::vertno_src_sel - Unknown hemisphere type\n");
+        return VectorXi();
+    }
+
+    Label t_label;
+    t_label.vertices = p_vecVertices;
+    t_label.hemi = p_iHemi;
+
+    QList<Label> t_qListLabels;
+    t_qListLabels << t_label;
+
+    return label_src_sel(t_qListLabels);
+}
+
+
 //*************************************************************************************************************
 
 MNESourceSpace MNESourceSpace::pick_regions(const QList<Label> &p_qListLabels) const
@@ -183,6 +183,30 @@ public:
     */
     QList<VectorXi> label_src_vertno_sel(const Label &p_label, VectorXi &src_sel) const;
 
+    //=========================================================================================================
+    /**
+    * Find the indices of the source points which are covered by the labels. The indices refer to the source
+    * points of both hemispheres in the order of get_vertno, i.e. the rows of a (orientation pooled) source
+    * estimate. The vertex numbers are looked up in a hash table.
+    *
+    * @param[in] p_qListLabels  ROIs, labels of both hemispheres can be mixed
+    *
+    * @return the ascending, unique source point indices
+    */
+    VectorXi label_src_sel(const QList<Label> &p_qListLabels) const;
+
+    //=========================================================================================================
+    /**
+    * Find the indices of the source points which correspond to the given vertex numbers of one hemisphere.
+    * Vertex numbers which are not in use by the source space are skipped.
+    *
+    * @param[in] p_vecVertices  Vertex numbers (0 based)
+    * @param[in] p_iHemi        Hemisphere (lh = 0; rh = 1)
+    *
+    * @return the ascending, unique source point indices, see label_src_sel
+    */
+    VectorXi vertno_src_sel(const VectorXi &p_vecVertices, qint32 p_iHemi) const;
+
     //=========================================================================================================
     /**
     * ### MNE toolbox root function ###: Definition of the mne_patch_info function
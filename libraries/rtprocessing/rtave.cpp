@@ -559,19 +559,59 @@ void RtAve::mergeData(double dTriggerType)
     }
 
     if(bArtifactedDetected == false) {
-        //Add cut data to average buffer
-        m_mapStimAve[dTriggerType].append(mergedData);
+        //Add cut data to the ring of epochs and update the running sum, so that adding and evicting an epoch
+        //costs one pass over the epoch instead of re-summing the whole buffer
+        QVector<MatrixXd>& ringEpochs = m_mapStimAve[dTriggerType];
+        MatrixXd& matSum = m_mapStimAveSum[dTriggerType];
+        qint32& iFirst = m_mapStimAveFirst[dTriggerType];
+        qint32& iCount = m_mapStimAveCount[dTriggerType];
+
+        //Zero number of averages keeps only the most recent epoch
+        int iCapacity = m_iNumAverages >= 1 ? m_iNumAverages : 1;
+
+        if(matSum.rows() != mergedData.rows() || matSum.cols() != mergedData.cols()) {
+            ringEpochs.clear();
+            iFirst = 0;
+            iCount = 0;
+            matSum = MatrixXd::Zero(mergedData.rows(), mergedData.cols());
+        }
+
+        //The number of averages changed - evict the oldest epochs and keep the newest ones in order
+        if(ringEpochs.size() != iCapacity) {
+            int iKeep = qMin(iCount, iCapacity);
+            QVector<MatrixXd> newRing(iCapacity);
+
+            for(int i = 0; i < iCount - iKeep; ++i) {
+                matSum -= ringEpochs.at((iFirst + i) % ringEpochs.size());
+            }
 
-        //Pop data from buffer
-        if(m_mapStimAve[dTriggerType].size() > m_iNumAverages && m_iNumAverages >= 1) {
-            for(int i = 0; i < m_mapStimAve[dTriggerType].size()-m_iNumAverages; ++i) {
-                m_mapStimAve[dTriggerType].pop_front();
+            for(int i = 0; i < iKeep; ++i) {
+                newRing[i] = ringEpochs.at((iFirst + iCount - iKeep + i) % ringEpochs.size());
             }
+
+            ringEpochs = newRing;
+            iFirst = 0;
+            iCount = iKeep;
         }
 
-        //Proceed a bit different if we use zero number of averages
-        if(m_mapStimAve[dTriggerType].size() > 1 && m_iNumAverages == 0) {
-            m_mapStimAve[dTriggerType].pop_front();
+        if(iCount < iCapacity) {
+            ringEpochs[(iFirst + iCount) % iCapacity] = mergedData;
+            iCount++;
+            matSum += mergedData;
+        } else {
+            //Replace the oldest epoch
+            matSum -= ringEpochs.at(iFirst);
+            matSum += mergedData;
+            ringEpochs[iFirst] = mergedData;
+            iFirst = (iFirst + 1) % iCapacity;
+
+            //Re-sum once per turn of the ring to bound the rounding drift of the running sum
+            if(iFirst == 0) {
+                matSum = ringEpochs.at(0);
+                for(int i = 1; i < iCount; ++i) {
+                    matSum += ringEpochs.at(i);
+                }
+            }
         }
     }
 }
@@ -583,20 +623,17 @@ void RtAve::generateEvoked(double dTriggerType)
 {
     QMutexLocker locker(&m_qMutex);
 
-    if(m_mapStimAve[dTriggerType].isEmpty()) {
+    int iCount = m_mapStimAveCount.value(dTriggerType, 0);
+
+    if(iCount == 0) {
         return;
     }
 
-
-    //Init evoked
-    m_pStimEvokedSet->info = *m_pFiffInfo.data();
-    FiffEvoked evoked;
-    evoked.setInfo(*m_pFiffInfo.data());
+    //Look up the evoked. The evoked is updated in place, the measurement info is only set once when it is created.
     int iEvokedIdx = -1;
 
     for(int i = 0; i < m_pStimEvokedSet->evoked.size(); ++i) {
         if(m_pStimEvokedSet->evoked.at(i).comment == QString::number(dTriggerType)) {
-            evoked = m_pStimEvokedSet->evoked.at(i);
             iEvokedIdx = i;
             break;
         }
@@ -604,65 +641,71 @@ void RtAve::generateEvoked(double dTriggerType)
 
     //If the evoked is not yet present add it here
     if(iEvokedIdx == -1) {
+        FiffEvoked newEvoked;
+        newEvoked.setInfo(m_pStimEvokedSet->info);
+
         float T = 1.0/m_pFiffInfo->sfreq;
 
-        evoked.baseline = m_pairBaselineSec;
-        evoked.times.resize(m_iPreStimSamples + m_iPostStimSamples);
-        evoked.times[0] = -T*m_iPreStimSamples;
-        for(int i = 1; i < evoked.times.size(); ++i) {
-            evoked.times[i] = evoked.times[i-1] + T;
+        newEvoked.baseline = m_pairBaselineSec;
+        newEvoked.times.resize(m_iPreStimSamples + m_iPostStimSamples);
+        newEvoked.times[0] = -T*m_iPreStimSamples;
+        for(int i = 1; i < newEvoked.times.size(); ++i) {
+            newEvoked.times[i] = newEvoked.times[i-1] + T;
         }
-        evoked.times[m_iPreStimSamples] = 0.0f;
-        evoked.first = 0;
-        evoked.last = m_iPreStimSamples + m_iPostStimSamples;
-        evoked.comment = QString::number(dTriggerType);
+        newEvoked.times[m_iPreStimSamples] = 0.0f;
+        newEvoked.first = 0;
+        newEvoked.last = m_iPreStimSamples + m_iPostStimSamples;
+        newEvoked.comment = QString::number(dTriggerType);
+
+        m_pStimEvokedSet->evoked.append(newEvoked);
+        iEvokedIdx = m_pStimEvokedSet->evoked.size() - 1;
     }
 
-    // Generate final evoked
-    MatrixXd finalAverage = MatrixXd::Zero(m_mapStimAve[dTriggerType].first().rows(), m_iPreStimSamples+m_iPostStimSamples);
+    FiffEvoked& evoked = m_pStimEvokedSet->evoked[iEvokedIdx];
 
+    // Generate final evoked
     if(m_iAverageMode == 0) {
-        for(int i = 0; i < m_mapStimAve[dTriggerType].size(); ++i) {
-            finalAverage += m_mapStimAve[dTriggerType].at(i);
-        }
-
-        if(m_mapStimAve[dTriggerType].isEmpty()) {
-            finalAverage = finalAverage/1;
-        } else {
-            finalAverage = finalAverage/m_mapStimAve[dTriggerType].size();
-        }
+        evoked.data = m_mapStimAveSum[dTriggerType] / iCount;
 
+        //The baseline is linear, so correcting the average equals averaging the corrected epochs
         if(m_bDoBaselineCorrection) {
-            finalAverage = MNEMath::rescale(finalAverage, evoked.times, m_pairBaselineSec, QString("mean"));
+            baselineCorrect(evoked.data, evoked.times);
         }
 
-        evoked.data = finalAverage;
-
         if(m_mapNumberCalcAverages[dTriggerType] < m_iNumAverages) {
             m_mapNumberCalcAverages[dTriggerType]++;
         }
 
         evoked.nave = m_mapNumberCalcAverages[dTriggerType];
     } else if(m_iAverageMode == 1) {
-        MatrixXd tempMatrix = m_mapStimAve[dTriggerType].last();
+        const QVector<MatrixXd>& ringEpochs = m_mapStimAve[dTriggerType];
+        MatrixXd tempMatrix = ringEpochs.at((m_mapStimAveFirst[dTriggerType] + iCount - 1) % ringEpochs.size());
 
         if(m_bDoBaselineCorrection) {
-            tempMatrix = MNEMath::rescale(tempMatrix, evoked.times, m_pairBaselineSec, QString("mean"));
+            baselineCorrect(tempMatrix, evoked.times);
         }
 
         evoked += tempMatrix;
 
         m_mapNumberCalcAverages[dTriggerType]++;
     }
+}
 
-    //Add new data to evoked data set
-    if(iEvokedIdx != -1) {
-        //Evoked data is already present
-        m_pStimEvokedSet->evoked[iEvokedIdx] = evoked;
-    } else {
-        //Evoked data is not present yet
-        m_pStimEvokedSet->evoked.append(evoked);
+
+//*************************************************************************************************************
+
+void RtAve::baselineCorrect(MatrixXd& matData, const RowVectorXf& times) const
+{
+    //Same baseline area as MNEMath::rescale
+    qint32 iMin, iMax;
+    MNEMath::getBaselineRange(times, m_pairBaselineSec, iMin, iMax);
+
+    if(iMin >= iMax || iMax > matData.cols()) {
+        return;
     }
+
+    VectorXd vecMean = matData.middleCols(iMin, iMax - iMin).rowwise().mean();
+    matData.colwise() -= vecMean;
 }
 
 
@@ -695,8 +738,14 @@ void RtAve::reset()
 //    m_mapStimAve.clear();
 //    m_mapNumberCalcAverages.clear();
 
+    //Pick up changes of the measurement info, e.g. bad channels, once per reset instead of with every evoked update
+    m_pStimEvokedSet->info = *m_pFiffInfo.data();
+
     m_qMapDetectedTrigger.clear();
     m_mapStimAve.clear();
+    m_mapStimAveFirst.clear();
+    m_mapStimAveCount.clear();
+    m_mapStimAveSum.clear();
     m_mapDataPre.clear();
     m_mapDataPost.clear();
     m_mapMatDataPostIdx.clear();
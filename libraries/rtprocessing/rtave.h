@@ -57,6 +57,7 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QVector>
 #include <QSharedPointer>
 
 
@@ -281,10 +282,19 @@ private:
 
     //=========================================================================================================
     /**
-    * Generates the final evoke variable.
+    * Generates the final evoke variable from the running sum of the stored epochs.
     */
     void generateEvoked(double dTriggerType);
 
+    //=========================================================================================================
+    /**
+    * Subtracts the mean over the baseline area from each row, see MNEMath::rescale with mode "mean".
+    *
+    * @param[in, out] matData   The data to correct
+    * @param[in] times          The time of each column in seconds
+    */
+    void baselineCorrect(Eigen::MatrixXd& matData, const Eigen::RowVectorXf& times) const;
+
     //=========================================================================================================
     /**
     * Check if data buffer has been initialized
@@ -328,7 +338,10 @@ private:
     FIFFLIB::FiffEvokedSet::SPtr                    m_pStimEvokedSet;           /**< Holds the evoked information. */
 
     QMap<int,QList<int> >                           m_qMapDetectedTrigger;      /**< Detected trigger for each trigger channel. */
-    QMap<double,QList<Eigen::MatrixXd> >            m_mapStimAve;               /**< the current stimulus average buffer. Holds m_iNumAverages vectors */
+    QMap<double,QVector<Eigen::MatrixXd> >          m_mapStimAve;               /**< The epochs of each trigger type in a ring with capacity m_iNumAverages (at least one). */
+    QMap<double,qint32>                             m_mapStimAveFirst;          /**< Ring index of the oldest epoch of each trigger type. */
+    QMap<double,qint32>                             m_mapStimAveCount;          /**< Number of epochs in the ring of each trigger type. */
+    QMap<double,Eigen::MatrixXd>                    m_mapStimAveSum;            /**< Running sum of the epochs in the ring of each trigger type. */
     QMap<double,Eigen::MatrixXd>                    m_mapDataPre;               /**< The matrix holding the pre stim data. */
     QMap<double,Eigen::MatrixXd>                    m_mapDataPost;              /**< The matrix holding the post stim data. */
     QMap<double,qint32>                             m_mapMatDataPostIdx;        /**< Current index inside of the matrix m_matDataPost */
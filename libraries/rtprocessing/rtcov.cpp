@@ -45,6 +45,7 @@
 #include <fiff/fiff_cov.h>
 
 #include <iostream>
+#include <cmath>
 
 
 //*************************************************************************************************************
@@ -63,6 +64,7 @@
 
 using namespace RTPROCESSINGLIB;
 using namespace FIFFLIB;
+using namespace Eigen;
 
 
 //*************************************************************************************************************
@@ -76,13 +78,21 @@ void RtCovWorker::doWork(const RtCovInput &inputData)
         return;
     }
 
-    QFuture<RtCovComputeResult> result = QtConcurrent::mappedReduced(inputData.lData,
-                                                                     compute,
-                                                                     reduce);
+    RtCovComputeResult finalResult;
 
-    result.waitForFinished();
+    if(inputData.lData.isEmpty()) {
+        //The online estimation already accumulated the sums, only the lower triangle is set
+        finalResult.mu = inputData.accumulated.mu;
+        finalResult.matData = inputData.accumulated.matData.selfadjointView<Lower>();
+    } else {
+        QFuture<RtCovComputeResult> result = QtConcurrent::mappedReduced(inputData.lData,
+                                                                         compute,
+                                                                         reduce);
+
+        result.waitForFinished();
 
-    RtCovComputeResult finalResult = result.result();
+        finalResult = result.result();
+    }
 
     //Final computation
     FiffCov computedCov;
@@ -98,9 +108,10 @@ void RtCovWorker::doWork(const RtCovInput &inputData)
     bool doProj = true;
 
     if(inputData.iSamples > 0) {
-        finalResult.mu /= (float)inputData.iSamples;
-        computedCov.data.array() -= inputData.iSamples * (finalResult.mu * finalResult.mu.transpose()).array();
-        computedCov.data.array() /= (inputData.iSamples - 1);
+        finalResult.mu /= inputData.dWeight;
+        computedCov.data.array() -= inputData.dWeight * (finalResult.mu * finalResult.mu.transpose()).array();
+        //Unbiased for weighted samples, with the effective sample size W^2/sum(w^2) this is W - 1 for unit weights
+        computedCov.data.array() /= (inputData.dWeight - inputData.dWeightSq / inputData.dWeight);
 
         computedCov.kind = FIFFV_MNE_NOISE_COV;
         computedCov.diag = false;
@@ -170,6 +181,10 @@ RtCov::RtCov(qint32 iMaxSamples,
 , m_iMaxSamples(iMaxSamples)
 , m_pFiffInfo(pFiffInfo)
 , m_iSamples(0)
+, m_bOnline(false)
+, m_dForgettingFactor(1.0)
+, m_dAccuWeight(0.0)
+, m_dAccuWeightSq(0.0)
 {
     RtCovWorker *worker = new RtCovWorker;
     worker->moveToThread(&m_workerThread);
@@ -205,10 +220,68 @@ void RtCov::setSamples(qint32 samples)
 }
 
 
+//*************************************************************************************************************
+
+void RtCov::setOnlineEstimation(bool bOnline)
+{
+    m_bOnline = bOnline;
+
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::setForgettingFactor(double dForgettingFactor)
+{
+    if(dForgettingFactor <= 0.0 || dForgettingFactor > 1.0) {
+        qDebug() << "RtCov::setForgettingFactor - Forgetting factor" << dForgettingFactor << "is not in (0,1]. Keeping" << m_dForgettingFactor;
+        return;
+    }
+
+    m_dForgettingFactor = dForgettingFactor;
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::reset()
+{
+    m_lData.clear();
+    m_iSamples = 0;
+
+    m_matAccuSum.resize(0,0);
+    m_vecAccuMu.resize(0);
+    m_dAccuWeight = 0.0;
+    m_dAccuWeightSq = 0.0;
+}
+
+
 //*************************************************************************************************************
 
 void RtCov::append(const MatrixXd &matDataSegment)
 {
+    if(m_bOnline) {
+        accumulate(matDataSegment);
+        m_iSamples += matDataSegment.cols();
+
+        if(m_iSamples >= m_iMaxSamples) {
+            RtCovInput inputData;
+            inputData.accumulated.matData = m_matAccuSum;
+            inputData.accumulated.mu = m_vecAccuMu;
+            inputData.fiffInfo = FiffInfo(*m_pFiffInfo);
+            inputData.iSamples = qRound(m_dAccuWeight * m_dAccuWeight / m_dAccuWeightSq);
+            inputData.dWeight = m_dAccuWeight;
+            inputData.dWeightSq = m_dAccuWeightSq;
+
+            emit operate(inputData);
+
+            m_iSamples = 0;
+        }
+
+        return;
+    }
+
     m_lData.append(matDataSegment);
     m_iSamples += matDataSegment.cols();
 
@@ -217,6 +290,8 @@ void RtCov::append(const MatrixXd &matDataSegment)
         inputData.lData = m_lData;
         inputData.fiffInfo = FiffInfo(*m_pFiffInfo);
         inputData.iSamples = m_iSamples;
+        inputData.dWeight = m_iSamples;
+        inputData.dWeightSq = m_iSamples;
 
         emit operate(inputData);
 
@@ -226,6 +301,50 @@ void RtCov::append(const MatrixXd &matDataSegment)
 }
 
 
+//*************************************************************************************************************
+
+void RtCov::accumulate(const MatrixXd &matDataSegment)
+{
+    int iRows = matDataSegment.rows();
+    int iCols = matDataSegment.cols();
+
+    if(m_matAccuSum.rows() != iRows) {
+        m_matAccuSum = MatrixXd::Zero(iRows, iRows);
+        m_vecAccuMu = VectorXd::Zero(iRows);
+        m_dAccuWeight = 0.0;
+        m_dAccuWeightSq = 0.0;
+    }
+
+    if(m_dForgettingFactor >= 1.0) {
+        m_matAccuSum.selfadjointView<Lower>().rankUpdate(matDataSegment);
+        m_vecAccuMu += matDataSegment.rowwise().sum();
+        m_dAccuWeight += iCols;
+        m_dAccuWeightSq += iCols;
+        return;
+    }
+
+    //Sample j of the block is weighted with factor^(iCols-1-j), the previous sums decay by factor^iCols
+    double dDecay = std::pow(m_dForgettingFactor, iCols);
+    m_matAccuSum.triangularView<Lower>() *= dDecay;
+    m_vecAccuMu *= dDecay;
+    m_dAccuWeight *= dDecay;
+    m_dAccuWeightSq *= dDecay * dDecay;
+
+    m_matWeighted.resize(iRows, iCols);
+    double dWeight = 1.0;
+
+    for(int j = iCols - 1; j >= 0; --j) {
+        m_matWeighted.col(j) = std::sqrt(dWeight) * matDataSegment.col(j);
+        m_vecAccuMu += dWeight * matDataSegment.col(j);
+        m_dAccuWeight += dWeight;
+        m_dAccuWeightSq += dWeight * dWeight;
+        dWeight *= m_dForgettingFactor;
+    }
+
+    m_matAccuSum.selfadjointView<Lower>().rankUpdate(m_matWeighted);
+}
+
+
 //*************************************************************************************************************
 
 void RtCov::handleResults(const FIFFLIB::FiffCov& computedCov)
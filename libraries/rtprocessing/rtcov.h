@@ -94,8 +94,11 @@ struct RtCovComputeResult {
 
 struct RtCovInput {
     QList<Eigen::MatrixXd>      lData;
+    RtCovComputeResult          accumulated;        /**< Precomputed sums (lower triangle of matData), used if lData is empty. */
     FIFFLIB::FiffInfo           fiffInfo;
     int                         iSamples;
+    double                      dWeight;            /**< The summed sample weights, i.e. the number of samples if all weights are one. */
+    double                      dWeightSq;          /**< The summed squared sample weights, used for the unbiased normalization. */
 };
 
 
@@ -197,6 +200,32 @@ public:
     */
     void setSamples(qint32 samples);
 
+    //=========================================================================================================
+    /**
+    * Switches between the block-wise estimation, which stores the data until the number of estimation samples is
+    * reached, and the online estimation. The online estimation accumulates the sums with a symmetric rank update per
+    * block without storing raw data and emits a new covariance each time the number of estimation samples was
+    * received. Switching resets the stored data and the accumulated sums.
+    *
+    * @param[in] bOnline    Whether to use the online estimation
+    */
+    void setOnlineEstimation(bool bOnline);
+
+    //=========================================================================================================
+    /**
+    * Sets the exponential forgetting factor per sample of the online estimation. 1.0 weights all samples since
+    * the last reset equally, smaller values give an effective window of about 1/(1-factor) samples.
+    *
+    * @param[in] dForgettingFactor  The forgetting factor in (0,1]
+    */
+    void setForgettingFactor(double dForgettingFactor);
+
+    //=========================================================================================================
+    /**
+    * Drops the stored data and the accumulated sums of the online estimation.
+    */
+    void reset();
+
     //=========================================================================================================
     /**
     * Restarts the thread by interrupting its computation queue, quitting, waiting and then starting it again.
@@ -216,6 +245,14 @@ protected:
     */
     void handleResults(const FIFFLIB::FiffCov& computedCov);
 
+    //=========================================================================================================
+    /**
+    * Adds a data block to the accumulated sums of the online estimation.
+    *
+    * @param[in] matDataSegment  The data block
+    */
+    void accumulate(const Eigen::MatrixXd &matDataSegment);
+
     QThread                 m_workerThread;             /**< The worker thread. */
 
     qint32                  m_iMaxSamples;              /**< Maximal amount of samples received, before covariance is estimated.*/
@@ -224,6 +261,14 @@ protected:
 
     QList<Eigen::MatrixXd>  m_lData;                    /**< The stored data blocks. */
 
+    bool                    m_bOnline;                  /**< Whether the online estimation is used. */
+    double                  m_dForgettingFactor;        /**< The forgetting factor per sample of the online estimation. */
+    double                  m_dAccuWeight;              /**< The summed sample weights of the online estimation. */
+    double                  m_dAccuWeightSq;            /**< The summed squared sample weights of the online estimation. */
+    Eigen::MatrixXd         m_matAccuSum;               /**< The weighted sum of the outer products, only the lower triangle is used. */
+    Eigen::VectorXd         m_vecAccuMu;                /**< The weighted sum of the samples. */
+    Eigen::MatrixXd         m_matWeighted;              /**< Work buffer holding a block scaled by the square root of the sample weights. */
+
     QSharedPointer<FIFFLIB::FiffInfo>  m_pFiffInfo;     /**< Holds the fiff measurement information. */
 
 signals:
@@ -43,6 +43,7 @@
 #include "rtprocessing_global.h"
 
 #include <utils/filterTools/filterdata.h>
+#include <utils/filterTools/filteroverlapadd.h>
 #include <fiff/fiff_info.h>
 
 
@@ -107,20 +108,35 @@ public:
 
     //=========================================================================================================
     /**
-    * Calculates the filtered version of the raw input data
+    * Calculates the filtered version of the raw input data. Channels which are not filtered are delayed by the
+    * group delay of the filter chain.
     *
-    * @param [in] matDataIn     data which is to be filtered
-    * @param [out] matDataOut    data which is to be filtered
-    * @param [in] iDataIndex    current position in the global data matrix
+    * @param [in] matDataIn             data which is to be filtered
+    * @param [in] lFilterChannelList    the indices of the channels which are filtered
+    * @param [in] lFilterData           the filters which are applied one after another
+    *
+    * @return the filtered data
     */
     Eigen::MatrixXd filterChannelsConcurrently(const Eigen::MatrixXd& matDataIn,
-                                               int iMaxFilterLength,
                                                const QVector<int>& lFilterChannelList,
                                                const QList<UTILSLIB::FilterData> &lFilterData);
 
+    //=========================================================================================================
+    /**
+    * Filters the data in place. Channels which are not filtered are delayed by the group delay of the filter chain.
+    *
+    * @param [in, out] matData          data which is to be filtered
+    * @param [in] lFilterChannelList    the indices of the channels which are filtered
+    * @param [in] lFilterData           the filters which are applied one after another
+    *
+    * @return true if the data could be filtered, false if it was left untouched
+    */
+    bool filterChannelsConcurrently(Eigen::MatrixXd& matData,
+                                    const QVector<int>& lFilterChannelList,
+                                    const QList<UTILSLIB::FilterData> &lFilterData);
+
 protected:
-    Eigen::MatrixXd                 m_matOverlap;                   /**< Last overlap block */
-    Eigen::MatrixXd                 m_matDelay;                     /**< Last delay block */
+    UTILSLIB::FilterOverlapAdd      m_filterOverlapAdd;             /**< The overlap-add filter engine, keeps the overlap and delay state between blocks. */
 
 private:
 
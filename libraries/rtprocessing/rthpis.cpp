@@ -82,7 +82,8 @@ using namespace INVERSELIB;
 void RtHPISWorker::doWork(const Eigen::MatrixXd& matData,
             const Eigen::MatrixXd& m_matProjectors,
             const QVector<int>& vFreqs,
-            QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo)
+            QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo,
+            int iDemodWindow)
 {
     if(this->thread()->isInterruptionRequested()) {
         return;
@@ -93,13 +94,19 @@ void RtHPISWorker::doWork(const Eigen::MatrixXd& matData,
     fitResult.devHeadTrans.from = 1;
     fitResult.devHeadTrans.to = 4;
 
-    HPIFit::fitHPI(matData,
-                    m_matProjectors,
-                    fitResult.devHeadTrans,
-                    vFreqs,
-                    fitResult.errorDistances,
-                    fitResult.fittedCoils,
-                    pFiffInfo);
+    if(!m_pHPIFit) {
+        m_pHPIFit = HPIFit::SPtr(new HPIFit());
+    }
+
+    m_pHPIFit->setDemodulationWindow(iDemodWindow);
+
+    m_pHPIFit->fit(matData,
+                   m_matProjectors,
+                   fitResult.devHeadTrans,
+                   vFreqs,
+                   fitResult.errorDistances,
+                   fitResult.fittedCoils,
+                   pFiffInfo);
 
     emit resultReady(fitResult);
 }
@@ -113,6 +120,7 @@ void RtHPISWorker::doWork(const Eigen::MatrixXd& matData,
 RtHPIS::RtHPIS(FiffInfo::SPtr p_pFiffInfo, QObject *parent)
 : QObject(parent)
 , m_pFiffInfo(p_pFiffInfo)
+, m_iDemodWindow(1)
 {
     qRegisterMetaType<RTPROCESSINGLIB::FittingResult>("RTPROCESSINGLIB::FittingResult");
     qRegisterMetaType<QVector<int> >("QVector<int>");
@@ -149,7 +157,8 @@ void RtHPIS::append(const MatrixXd &data)
     emit operate(data,
                  m_matProjectors,
                  m_vCoilFreqs,
-                 m_pFiffInfo);
+                 m_pFiffInfo,
+                 m_iDemodWindow);
 }
 
 
@@ -169,6 +178,14 @@ void RtHPIS::setProjectionMatrix(const Eigen::MatrixXd& matProjectors)
 }
 
 
+//*************************************************************************************************************
+
+void RtHPIS::setDemodulationWindow(int iNumBlocks)
+{
+    m_iDemodWindow = iNumBlocks;
+}
+
+
 //*************************************************************************************************************
 
 void RtHPIS::handleResults(const RTPROCESSINGLIB::FittingResult& fitResult)
@@ -80,6 +80,10 @@ namespace FIFFLIB{
     class FiffInfo;
 }
 
+namespace INVERSELIB{
+    class HPIFit;
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -116,17 +120,23 @@ class RtHPISWorker : public QObject
 public:
     //=========================================================================================================
     /**
-    * Perform one single HPI fit.
+    * Perform one single HPI fit. The fitting object is kept across calls, so that its setup is reused and each fit
+    * starts from the previous coil positions.
     *
     * @param[in] t_mat           Data to estimate the HPI positions from
     * @param[in] t_matProjectors The projectors to apply. Bad channels are still included.
     * @param[in] vFreqs          The frequencies for each coil.
-    * @param[in] p_pFiffInfo     Associated Fiff Information.
+    * @param[in] pFiffInfo       Associated Fiff Information.
+    * @param[in] iDemodWindow    The number of blocks the coil amplitudes are demodulated over.
     */
     void doWork(const Eigen::MatrixXd& matData,
                 const Eigen::MatrixXd& m_matProjectors,
                 const QVector<int>& vFreqs,
-                QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo);
+                QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo,
+                int iDemodWindow);
+
+private:
+    QSharedPointer<INVERSELIB::HPIFit>  m_pHPIFit;      /**< The continuous HPI fitting object. */
 
 signals:
     void resultReady(const RTPROCESSINGLIB::FittingResult &fitResult);
@@ -185,6 +195,15 @@ public:
     */
     void setProjectionMatrix(const Eigen::MatrixXd& matProjectors);
 
+    //=========================================================================================================
+    /**
+    * Set the number of blocks the coil amplitudes are demodulated over. A longer window lowers the noise of the
+    * coil amplitudes at the cost of a slower response to head movements.
+    *
+    * @param[in] iNumBlocks  The number of blocks.
+    */
+    void setDemodulationWindow(int iNumBlocks);
+
     //=========================================================================================================
     /**
     * Restarts the thread by interrupting its computation queue, quitting, waiting and then starting it again.
@@ -209,13 +228,15 @@ protected:
     QThread             m_workerThread;         /**< The worker thread. */
     QVector<int>        m_vCoilFreqs;           /**< Vector contains the HPI coil frequencies. */
     Eigen::MatrixXd     m_matProjectors;        /**< Holds the matrix with the SSP and compensator projectors.*/
+    int                 m_iDemodWindow;         /**< The number of blocks the coil amplitudes are demodulated over. */
 
 signals:
     void newFittingResultAvailable(const RTPROCESSINGLIB::FittingResult &fitResult);
     void operate(const Eigen::MatrixXd& matData,
                  const Eigen::MatrixXd& matProjectors,
                  const QVector<int>& vFreqs,
-                 QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo);
+                 QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo,
+                 int iDemodWindow);
 };
 
 //*************************************************************************************************************
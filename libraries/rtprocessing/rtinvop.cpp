@@ -71,6 +71,7 @@
 using namespace RTPROCESSINGLIB;
 using namespace Eigen;
 using namespace MNELIB;
+using namespace FIFFLIB;
 
 
 //*************************************************************************************************************
@@ -80,19 +81,78 @@ using namespace MNELIB;
 
 void RtInvOpWorker::doWork(const RtInvOpInput &inputData)
 {
-    // Restrict forward solution as necessary for MEG
-    MNEForwardSolution forwardMeg = inputData.pFwd->pick_types(true, false);
+    // Skip covariances which were superseded while waiting in the queue
+    if(inputData.pLatestCovIdx && inputData.iCovIdx != inputData.pLatestCovIdx->loadAcquire()) {
+        return;
+    }
+
+    // Restrict forward solution as necessary for MEG. The picked forward solution is kept across updates.
+    if(!m_pFwdMeg || m_pFwd != inputData.pFwd) {
+        m_pFwd = inputData.pFwd;
+        m_pFwdMeg = MNEForwardSolution::SPtr(new MNEForwardSolution(inputData.pFwd->pick_types(true, false)));
+        m_lPriorChNames.clear();
+
+        // Run the same parameter checks as make_inverse_operator, the cached assembly relies on them
+        m_fLoose = 0.2f;
+        m_fDepth = 0.8f;
+        bool bFixed = false;
+        m_bParametersValid = MNEInverseOperator::check_inverse_parameters(*m_pFwdMeg, m_fLoose, m_fDepth, bFixed);
+    }
+
+    if(!m_bParametersValid) {
+        return;
+    }
 
-    MNEInverseOperator invOpMeg(*inputData.pFiffInfo.data(),
-                                forwardMeg,
-                                inputData.noiseCov,
-                                0.2f,
-                                0.8f);
+    // Whiten with the new noise covariance
+    FiffInfo gain_info;
+    MatrixXd gain;
+    MatrixXd whitener;
+    qint32 n_nzero;
+    FiffCov noiseCov;
+    m_pFwdMeg->prepare_forward(*inputData.pFiffInfo.data(), inputData.noiseCov, false, gain_info, gain, noiseCov, whitener, n_nzero);
+
+    // The priors only need to be recomputed if the channel selection changed, e.g. due to new bad channels
+    if(gain_info.ch_names != m_lPriorChNames) {
+        updatePriors(gain_info, gain);
+    }
+
+    MNEInverseOperator invOpMeg = MNEInverseOperator::assemble_inverse_operator(*inputData.pFiffInfo.data(),
+                                                                                *m_pFwdMeg,
+                                                                                gain_info,
+                                                                                gain,
+                                                                                noiseCov,
+                                                                                whitener,
+                                                                                n_nzero,
+                                                                                m_pDepthPrior,
+                                                                                m_pOrientPrior,
+                                                                                m_pSourceCov);
 
     emit resultReady(invOpMeg);
 }
 
 
+//*************************************************************************************************************
+
+void RtInvOpWorker::updatePriors(const FiffInfo &gain_info,
+                                 const MatrixXd &gain)
+{
+    // Same settings as make_inverse_operator with the parameters checked in doWork
+    bool bIsFixedOri = m_pFwdMeg->isFixedOrient();
+
+    m_pDepthPrior = FiffCov::SDPtr(new FiffCov(MNEForwardSolution::compute_depth_prior(gain, gain_info, bIsFixedOri, m_fDepth, 10.0, defaultConstMatrixXd, true)));
+    m_pSourceCov = m_pDepthPrior;
+
+    if(bIsFixedOri) {
+        m_pOrientPrior = FiffCov::SDPtr();
+    } else {
+        m_pOrientPrior = FiffCov::SDPtr(new FiffCov(m_pFwdMeg->compute_orient_prior(m_fLoose)));
+        m_pSourceCov->data.array() *= m_pOrientPrior->data.array();
+    }
+
+    m_lPriorChNames = gain_info.ch_names;
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS RtInvOp
@@ -104,6 +164,7 @@ RtInvOp::RtInvOp(FiffInfo::SPtr &p_pFiffInfo,
 : QObject(parent)
 , m_pFiffInfo(p_pFiffInfo)
 , m_pFwd(p_pFwd)
+, m_pLatestCovIdx(new QAtomicInt(0))
 {
     if(this->thread()->isInterruptionRequested()) {
         return;
@@ -143,6 +204,8 @@ void RtInvOp::append(const FIFFLIB::FiffCov &noiseCov)
     inputData.noiseCov = noiseCov;
     inputData.pFiffInfo = m_pFiffInfo;
     inputData.pFwd = m_pFwd;
+    inputData.iCovIdx = m_pLatestCovIdx->fetchAndAddOrdered(1) + 1;
+    inputData.pLatestCovIdx = m_pLatestCovIdx;
 
     emit operate(inputData);
 }
@@ -53,6 +53,8 @@
 
 #include <QThread>
 #include <QSharedPointer>
+#include <QAtomicInt>
+#include <QStringList>
 
 
 //*************************************************************************************************************
@@ -88,6 +90,8 @@ struct RtInvOpInput {
     QSharedPointer<FIFFLIB::FiffInfo>           pFiffInfo;
     QSharedPointer<MNELIB::MNEForwardSolution>  pFwd;
     FIFFLIB::FiffCov                            noiseCov;
+    int                                         iCovIdx;            /**< Running number of the noise covariance. */
+    QSharedPointer<QAtomicInt>                  pLatestCovIdx;      /**< Running number of the latest received noise covariance. Older ones are skipped. */
 };
 
 
@@ -110,6 +114,28 @@ public:
     */
     void doWork(const RtInvOpInput &inputData);
 
+private:
+    //=========================================================================================================
+    /**
+    * Computes the priors for the channels of the prepared gain matrix. The priors only depend on the forward
+    * solution and the channel selection, not on the noise covariance.
+    *
+    * @param[in] gain_info  The info of the gain channels
+    * @param[in] gain       The gain matrix
+    */
+    void updatePriors(const FIFFLIB::FiffInfo &gain_info,
+                      const Eigen::MatrixXd &gain);
+
+    QSharedPointer<MNELIB::MNEForwardSolution>  m_pFwd;             /**< The forward solution the cached MEG forward solution was picked from. */
+    QSharedPointer<MNELIB::MNEForwardSolution>  m_pFwdMeg;          /**< The cached MEG forward solution. */
+    QStringList                                 m_lPriorChNames;    /**< The gain channels the cached priors were computed for. */
+    bool                                        m_bParametersValid; /**< Whether the inverse parameters are valid for the cached MEG forward solution. */
+    float                                       m_fLoose;           /**< The checked loose parameter for the cached MEG forward solution. */
+    float                                       m_fDepth;           /**< The checked depth parameter for the cached MEG forward solution. */
+    FIFFLIB::FiffCov::SDPtr                     m_pDepthPrior;      /**< The cached depth prior. */
+    FIFFLIB::FiffCov::SDPtr                     m_pOrientPrior;     /**< The cached orientation prior. */
+    FIFFLIB::FiffCov::SDPtr                     m_pSourceCov;       /**< The cached source covariance before scaling. */
+
 signals:
     //=========================================================================================================
     /**
@@ -180,6 +206,7 @@ protected:
 
     QSharedPointer<FIFFLIB::FiffInfo>           m_pFiffInfo;        /**< The fiff measurement information. */
     QSharedPointer<MNELIB::MNEForwardSolution>  m_pFwd;             /**< The forward solution. */
+    QSharedPointer<QAtomicInt>                  m_pLatestCovIdx;    /**< Running number of the latest received noise covariance. */
 
     QThread                                     m_workerThread;     /**< The worker thread. */
 
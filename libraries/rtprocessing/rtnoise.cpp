@@ -44,6 +44,7 @@
 #include "rtnoise.h"
 
 #include <iostream>
+#include <algorithm>
 #include <fiff/fiff_cov.h>
 
 
@@ -78,20 +79,32 @@ RtNoise::RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_data
 , m_iNumOfBlocks(0)
 , m_iBlockSize(0)
 , m_iSensors(0)
-, m_iBlockIndex(0)
+, m_iHistoryPos(0)
+, m_iHistoryFill(0)
+, m_iHop(1)
+, m_iNewSamples(0)
+, m_iSpecFirst(0)
+, m_iSpecCount(0)
+, m_dForgettingFactor(0.0)
+, m_bExponential(false)
 {
     qRegisterMetaType<Eigen::MatrixXd>("Eigen::MatrixXd");
     //qRegisterMetaType<QVector<double> >("QVector<double>");
 
     m_Fs = m_pFiffInfo->sfreq;
 
-    m_bSendDataToBuffer = true;
-
     m_fWin.clear();
 
     //create a hanning window
     m_fWin = hanning(m_iFFTlength,0);
 
+    m_vecWindow.resize(m_iFFTlength);
+    for(qint32 i = 0; i < m_iFFTlength; ++i) {
+        m_vecWindow[i] = m_fWin[i];
+    }
+
+    m_fft.SetFlag(m_fft.HalfSpectrum);
+
     qDebug()<<"Hanning window is created.";
 
 }
@@ -159,8 +172,7 @@ void RtNoise::append(const MatrixXd &p_DataSegment)
     if(!m_pRawMatrixBuffer)
         m_pRawMatrixBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, p_DataSegment.rows(), p_DataSegment.cols()));
 
-    if (m_bSendDataToBuffer)
-        m_pRawMatrixBuffer->push(&p_DataSegment);
+    m_pRawMatrixBuffer->push(&p_DataSegment);
 }
 
 
@@ -195,6 +207,150 @@ bool RtNoise::stop()
 }
 
 
+//*************************************************************************************************************
+
+void RtNoise::setForgettingFactor(double dForgettingFactor)
+{
+    QMutexLocker locker(&mutex);
+
+    if(dForgettingFactor < 0.0 || dForgettingFactor >= 1.0) {
+        qDebug() << "RtNoise::setForgettingFactor - Forgetting factor" << dForgettingFactor << "is not in [0,1). Keeping" << m_dForgettingFactor;
+        return;
+    }
+
+    m_dForgettingFactor = dForgettingFactor;
+}
+
+
+//*************************************************************************************************************
+
+void RtNoise::initSpectrum(double dForgettingFactor)
+{
+    m_matHistory = MatrixXd::Zero(m_iSensors, m_iFFTlength);
+    m_iHistoryPos = 0;
+    m_iHistoryFill = 0;
+    m_iHop = m_iFFTlength/2 > 0 ? m_iFFTlength/2 : 1;
+    m_iNewSamples = 0;
+
+    m_vecFFTIn.resize(m_iFFTlength);
+    m_vecFFTOut.resize(m_iFFTlength/2+1);
+    m_matSegmentSpec.resize(m_iSensors, m_iFFTlength/2+1);
+
+    //Average over the overlapping segments which fit into the data length
+    int iDataSamples = m_iNumOfBlocks*m_iBlockSize;
+    int iNumSegments = iDataSamples > m_iFFTlength ? (iDataSamples - m_iFFTlength)/m_iHop + 1 : 1;
+
+    m_vecSegmentSpec.clear();
+    m_vecSegmentSpec.resize(iNumSegments);
+    m_iSpecFirst = 0;
+    m_iSpecCount = 0;
+    m_matSpecSum = MatrixXd::Zero(m_iSensors, m_iFFTlength/2+1);
+    m_bExponential = dForgettingFactor > 0.0;
+}
+
+
+//*************************************************************************************************************
+
+bool RtNoise::updateSpectrum(const MatrixXd &block, double dForgettingFactor)
+{
+    bool bUpdated = false;
+    int iCol = 0;
+
+    while(iCol < block.cols()) {
+        //Copy up to the end of the history, the end of the block or the next segment
+        int iChunk = std::min(m_iFFTlength - m_iHistoryPos, (int)block.cols() - iCol);
+        iChunk = std::min(iChunk, m_iHop - m_iNewSamples);
+
+        m_matHistory.middleCols(m_iHistoryPos, iChunk) = block.middleCols(iCol, iChunk);
+
+        iCol += iChunk;
+        m_iHistoryPos = (m_iHistoryPos + iChunk) % m_iFFTlength;
+        m_iHistoryFill = std::min(m_iHistoryFill + iChunk, (int)m_iFFTlength);
+        m_iNewSamples += iChunk;
+
+        if(m_iNewSamples < m_iHop) {
+            continue;
+        }
+
+        m_iNewSamples = 0;
+
+        if(m_iHistoryFill < m_iFFTlength) {
+            continue;
+        }
+
+        computeSegmentSpectrum();
+
+        //Restart the average if the averaging mode changed
+        if(m_bExponential != (dForgettingFactor > 0.0)) {
+            m_bExponential = dForgettingFactor > 0.0;
+            m_iSpecFirst = 0;
+            m_iSpecCount = 0;
+            m_matSpecSum.setZero();
+        }
+
+        if(m_bExponential) {
+            //Exponential average
+            if(m_iSpecCount == 0) {
+                m_matSpecSum = m_matSegmentSpec;
+                m_iSpecCount = 1;
+            } else {
+                m_matSpecSum = dForgettingFactor * m_matSpecSum + (1.0 - dForgettingFactor) * m_matSegmentSpec;
+            }
+        } else {
+            //Sliding average
+            int iNumSegments = m_vecSegmentSpec.size();
+
+            if(m_iSpecCount < iNumSegments) {
+                m_vecSegmentSpec[(m_iSpecFirst + m_iSpecCount) % iNumSegments] = m_matSegmentSpec;
+                m_iSpecCount++;
+                m_matSpecSum += m_matSegmentSpec;
+            } else {
+                m_matSpecSum -= m_vecSegmentSpec.at(m_iSpecFirst);
+                m_matSpecSum += m_matSegmentSpec;
+                m_vecSegmentSpec[m_iSpecFirst] = m_matSegmentSpec;
+                m_iSpecFirst = (m_iSpecFirst + 1) % iNumSegments;
+
+                //Re-sum once per turn of the ring to bound the rounding drift of the running sum
+                if(m_iSpecFirst == 0) {
+                    m_matSpecSum = m_vecSegmentSpec.at(0);
+                    for(int i = 1; i < m_iSpecCount; ++i) {
+                        m_matSpecSum += m_vecSegmentSpec.at(i);
+                    }
+                }
+            }
+        }
+
+        bUpdated = true;
+    }
+
+    return bUpdated;
+}
+
+
+//*************************************************************************************************************
+
+void RtNoise::computeSegmentSpectrum()
+{
+    //The oldest sample is at the write position
+    int iTail = m_iFFTlength - m_iHistoryPos;
+    double dScale = 1.0/(m_Fs*m_iFFTlength);
+
+    for(qint32 i = 0; i < m_iSensors; i++) {
+        m_vecFFTIn.head(iTail) = m_matHistory.row(i).segment(m_iHistoryPos, iTail);
+        m_vecFFTIn.tail(m_iHistoryPos) = m_matHistory.row(i).head(m_iHistoryPos);
+        m_vecFFTIn.array() *= m_vecWindow.array();
+
+        m_fft.fwd(m_vecFFTOut, m_vecFFTIn);
+
+        // calculate spectrum from FFT
+        m_matSegmentSpec.row(i) = dScale * m_vecFFTOut.cwiseAbs();
+        if(m_iFFTlength/2 > 1) {
+            m_matSegmentSpec.row(i).segment(1, m_iFFTlength/2-1) *= 2.0;
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 void RtNoise::run()
@@ -211,106 +367,30 @@ void RtNoise::run()
         {
             MatrixXd block = m_pRawMatrixBuffer->pop();
 
-            if(FirstStart){
-                //init the circ buffer and parameters
+            //The forgetting factor may be changed from another thread, use one value per block
+            mutex.lock();
+            double dForgettingFactor = m_dForgettingFactor;
+            mutex.unlock();
+
+            if(FirstStart || block.rows() != m_iSensors){
+                //init the segment history and parameters
                 if(m_dataLength < 0) m_dataLength = 10;
                 m_iNumOfBlocks = m_dataLength;//60;
                 m_iBlockSize =  block.cols();
                 m_iSensors =  block.rows();
 
-                m_matCircBuf.resize(m_iSensors,m_iNumOfBlocks*m_iBlockSize);
+                initSpectrum(dForgettingFactor);
 
-                m_iBlockIndex = 0;
                 FirstStart = false;
             }
-            //concate blocks
-            for (int i=0; i< m_iSensors; i++)
-                for (int j=0; j< m_iBlockSize; j++)
-                    m_matCircBuf(i,j+m_iBlockIndex*m_iBlockSize) = block(i,j);
-
-
-            m_iBlockIndex ++;
-            if (m_iBlockIndex >= m_iNumOfBlocks){
-
-                //m_pRawMatrixBuffer.clear(); //empty the buffer
-
-                m_bSendDataToBuffer = false;
-                //stop collect block and start to calculate the spectrum
-                m_iBlockIndex = 0;
-
-                MatrixXd sum_psdx = MatrixXd::Zero(m_iSensors,m_iFFTlength/2+1);
-
-                int nb = floor(m_iNumOfBlocks*m_iBlockSize/m_iFFTlength)+1;
-                qDebug()<<"nb"<<nb<<"NumOfBlocks"<<m_iNumOfBlocks<<"BlockSize"<<m_iBlockSize;
-                MatrixXd t_mat(m_iSensors,m_iFFTlength);
-                MatrixXd t_psdx(m_iSensors,m_iFFTlength/2+1);
-                for (int n = 0; n<nb; n++){
-                    //collect a data block with data length of m_iFFTlength;
-                    if(n==nb-1)
-                    {
-                        for(qint32 ii=0; ii<m_iSensors; ii++)
-                        for(qint32 jj=0; jj<m_iFFTlength; jj++)
-                            if(jj+n*m_iFFTlength<m_iNumOfBlocks*m_iBlockSize)
-                                t_mat(ii,jj) = m_matCircBuf(ii,jj+n*m_iFFTlength);
-                            else
-                                t_mat(ii,jj) = 0.0;
-
-                    }
-                    else
-                    {
-                        for(qint32 ii=0; ii<m_iSensors; ii++)
-                        for(qint32 jj=0; jj<m_iFFTlength; jj++)
-                            t_mat(ii,jj) = m_matCircBuf(ii,jj+n*m_iFFTlength);
-                    }
-
-                    //FFT calculation by row
-                    for(qint32 i = 0; i < t_mat.rows(); i++){
-                        RowVectorXd data;
-
-                        data = t_mat.row(i);
-
-                        //zero-pad data to m_iFFTlength
-                        RowVectorXd t_dataZeroPad = RowVectorXd::Zero(m_iFFTlength);
-                        t_dataZeroPad.head(data.cols()) = data;
-
-                        for (qint32 lk = 0; lk<m_iFFTlength; lk++)
-                            t_dataZeroPad[lk] = t_dataZeroPad[lk]*m_fWin[lk];
-
-                        //generate fft object
-                        Eigen::FFT<double> fft;
-                        fft.SetFlag(fft.HalfSpectrum);
-
-                        //fft-transform data sequence
-                        RowVectorXcd t_freqData(m_iFFTlength/2+1);
-                        fft.fwd(t_freqData,t_dataZeroPad);
-
-                        // calculate spectrum from FFT
-                        for(qint32 j=0; j<m_iFFTlength/2+1;j++)
-                        {
-                            double mag_abs = sqrt(t_freqData(j).real()* t_freqData(j).real() +  t_freqData(j).imag()*t_freqData(j).imag());
-                            double spower = (1.0/(m_Fs*m_iFFTlength))* mag_abs;
-                            if (j>0&&j<m_iFFTlength/2) spower = 2.0*spower;
-                            sum_psdx(i,j) = sum_psdx(i,j) + spower;
-                        }
-                     }//row computing is done
-                }//nb
 
+            //Each completed segment updates the averaged spectrum, so the cost per block is constant
+            if(updateSpectrum(block, dForgettingFactor) && m_iSpecCount > 0) {
                 //DB-calculation
-                for(qint32 ii=0; ii<m_iSensors; ii++)
-                    for(qint32 jj=0; jj<m_iFFTlength/2+1; jj++)
-                        t_psdx(ii,jj) = 10.0*log10(sum_psdx(ii,jj)/nb);
+                MatrixXd t_psdx = (10.0 * (m_matSpecSum / (m_bExponential ? 1.0 : m_iSpecCount)).array().log10()).matrix();
 
-                qDebug()<<"Send spectrum to Noise Estimator";
                 emit SpecCalculated(t_psdx); //send back the spectrum result
-                if(m_pRawMatrixBuffer->size()>0)
-                    m_pRawMatrixBuffer->clear();
-
-                m_bSendDataToBuffer = true;
             }
-
         }
-
     }
-
 }
-
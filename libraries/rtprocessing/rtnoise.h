@@ -162,6 +162,16 @@ public:
     */
     virtual bool stop();
 
+    //=========================================================================================================
+    /**
+    * Sets how the spectra of the overlapping segments are averaged. A forgetting factor of 0 averages the segments
+    * within the data length (sliding average), a factor in (0,1) weights the previous average with the factor
+    * and the newest segment with 1-factor (exponential average).
+    *
+    * @param[in] dForgettingFactor  The forgetting factor in [0,1)
+    */
+    void setForgettingFactor(double dForgettingFactor);
+
 signals:
     //=========================================================================================================
     /**
@@ -182,6 +192,32 @@ protected:
 
     QVector <float> hanning(int N, short itype);
 
+    //=========================================================================================================
+    /**
+    * Allocates the segment history, the FFT buffers and the averaging ring for the current block and sensor count.
+    *
+    * @param[in] dForgettingFactor  The forgetting factor in use, 0 for the sliding average
+    */
+    void initSpectrum(double dForgettingFactor);
+
+    //=========================================================================================================
+    /**
+    * Appends a data block to the segment history and updates the averaged spectrum with each completed segment.
+    * Segments overlap by half of the FFT length.
+    *
+    * @param[in] block              The data block
+    * @param[in] dForgettingFactor  The forgetting factor in use, 0 for the sliding average
+    *
+    * @return true if the averaged spectrum was updated, false otherwise
+    */
+    bool updateSpectrum(const MatrixXd &block, double dForgettingFactor);
+
+    //=========================================================================================================
+    /**
+    * Computes the spectrum of the segment which ends at the current history position.
+    */
+    void computeSegmentSpectrum();
+
 private:
     QMutex      mutex;                  /**< Provides access serialization between threads*/
 
@@ -192,6 +228,10 @@ private:
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;   /**< The Circular Raw Matrix Buffer. */
 
     QVector <float> m_fWin;
+    RowVectorXd m_vecWindow;                /**< The cached window. */
+    Eigen::FFT<double> m_fft;               /**< The cached FFT plan. */
+    RowVectorXd m_vecFFTIn;                 /**< FFT input buffer. */
+    RowVectorXcd m_vecFFTOut;               /**< FFT output buffer (half spectrum). */
 
     double m_Fs;
 
@@ -202,16 +242,25 @@ protected:
     int m_iNumOfBlocks;
     int m_iBlockSize;
     int m_iSensors;
-    int m_iBlockIndex;
 
-    MatrixXd m_matCircBuf;
+    MatrixXd m_matHistory;                  /**< The last m_iFFTlength samples of each sensor, circular. */
+    int m_iHistoryPos;                      /**< Write position in m_matHistory, which is also the oldest sample. */
+    int m_iHistoryFill;                     /**< Number of valid samples in m_matHistory. */
+    int m_iHop;                             /**< Number of samples between the starts of two segments. */
+    int m_iNewSamples;                      /**< Number of samples received since the last segment. */
+
+    MatrixXd m_matSegmentSpec;              /**< The spectrum of the latest segment. */
+    QVector<MatrixXd> m_vecSegmentSpec;     /**< Ring of the spectra of the segments within the data length. */
+    int m_iSpecFirst;                       /**< Ring index of the oldest segment spectrum. */
+    int m_iSpecCount;                       /**< Number of segment spectra in the ring. */
+    MatrixXd m_matSpecSum;                  /**< Sum of the segment spectra in the ring, or the exponential average. */
+    double m_dForgettingFactor;             /**< 0 for the sliding average, otherwise the exponential forgetting factor. Guarded by mutex. */
+    bool m_bExponential;                    /**< Whether m_matSpecSum currently holds an exponential average. */
 
 public:
     MatrixXd m_matSpecData;
     QMutex ReadMutex;
 
-    bool m_bSendDataToBuffer;
-
 };
 
 //*************************************************************************************************************
@@ -84,7 +84,8 @@ SOURCES += \
     rtnoise.cpp \
     rthpis.cpp \
     rtfilter.cpp \
-    rtconnectivity.cpp
+    rtconnectivity.cpp \
+    rtresample.cpp
 
 HEADERS +=  \
     rtprocessing_global.h \
@@ -94,7 +95,8 @@ HEADERS +=  \
     rtnoise.h \
     rthpis.h \
     rtfilter.h \
-    rtconnectivity.h
+    rtconnectivity.h \
+    rtresample.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
@@ -0,0 +1,222 @@
+//=============================================================================================================
+/**
+* @file     rtresample.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RtResample class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtresample.h"
+
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+/**
+* Zeroth order modified Bessel function of the first kind, used by the Kaiser window.
+*/
+static double rtResampleBesselI0(double x)
+{
+    double dSum = 1.0;
+    double dTerm = 1.0;
+
+    for(int k = 1; k < 50; ++k) {
+        dTerm *= (x / (2.0*k)) * (x / (2.0*k));
+        dSum += dTerm;
+
+        if(dTerm < 1e-16 * dSum) {
+            break;
+        }
+    }
+
+    return dSum;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtResample::RtResample(int iUp, int iDown, int iZeroCrossings)
+: m_iUp(1)
+, m_iDown(1)
+, m_iTaps(1)
+, m_iFilterLength(1)
+, m_iPosition(0)
+{
+    setRatio(iUp, iDown, iZeroCrossings);
+}
+
+
+//*************************************************************************************************************
+
+bool RtResample::setRatio(int iUp, int iDown, int iZeroCrossings)
+{
+    if(iUp < 1 || iDown < 1 || iZeroCrossings < 1) {
+        qDebug()<<"Error in RtResample: The resampling factors and the number of zero crossings need to be positive!";
+        return false;
+    }
+
+    //Reduce the factor, e.g. 4/2 -> 2/1
+    int a = iUp, b = iDown;
+    while(b != 0) {
+        int r = a % b;
+        a = b;
+        b = r;
+    }
+
+    m_iUp = iUp / a;
+    m_iDown = iDown / a;
+
+    if(m_iUp == 1 && m_iDown == 1) {
+        m_iTaps = 1;
+        m_iFilterLength = 1;
+        m_matPhases = MatrixXd::Ones(1, 1);
+        reset();
+        return true;
+    }
+
+    //Kaiser windowed sinc with its cutoff at the lower of both Nyquist frequencies, on the upsampled grid
+    int iMaxFactor = qMax(m_iUp, m_iDown);
+    m_iFilterLength = 2 * iZeroCrossings * iMaxFactor + 1;
+    m_iTaps = (m_iFilterLength + m_iUp - 1) / m_iUp;
+
+    const double dBeta = 5.0;
+    const double dCenter = (m_iFilterLength - 1) / 2.0;
+    const double dI0Beta = rtResampleBesselI0(dBeta);
+
+    VectorXd vecPrototype = VectorXd::Zero(m_iTaps * m_iUp);
+
+    for(int k = 0; k < m_iFilterLength; ++k) {
+        double t = (k - dCenter) / iMaxFactor;
+        double dSinc = t == 0.0 ? 1.0 : std::sin(M_PI*t) / (M_PI*t);
+        double r = (k - dCenter) / dCenter;
+        double dWindow = rtResampleBesselI0(dBeta * std::sqrt(qMax(0.0, 1.0 - r*r))) / dI0Beta;
+
+        vecPrototype(k) = dSinc * dWindow;
+    }
+
+    //Unit gain at DC after upsampling, i.e. each phase sums to one on average
+    vecPrototype *= double(m_iUp) / vecPrototype.sum();
+
+    //Phase p holds the taps p, p+up, p+2*up, ... in reversed order, so that it multiplies the input in time order
+    m_matPhases.resize(m_iTaps, m_iUp);
+
+    for(int p = 0; p < m_iUp; ++p) {
+        for(int j = 0; j < m_iTaps; ++j) {
+            m_matPhases(m_iTaps-1-j, p) = vecPrototype(p + j*m_iUp);
+        }
+    }
+
+    reset();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtResample::reset()
+{
+    m_iPosition = 0;
+    m_matHistory.resize(0, 0);
+}
+
+
+//*************************************************************************************************************
+
+void RtResample::resample(const MatrixXd& matDataIn, MatrixXd& matDataOut)
+{
+    int iNumChannels = matDataIn.rows();
+    int iNumSamples = matDataIn.cols();
+    int iHistory = m_iTaps - 1;
+
+    if(m_iUp == 1 && m_iDown == 1) {
+        matDataOut = matDataIn;
+        return;
+    }
+
+    //Append the block to the history of the last taps-1 samples, before matDataOut is touched it may alias matDataIn
+    if(m_matHistory.rows() != iNumChannels || m_matHistory.cols() != iHistory) {
+        m_matHistory.setZero(iNumChannels, iHistory);
+    }
+
+    m_matBuffer.resize(iNumChannels, iHistory + iNumSamples);
+    m_matBuffer.leftCols(iHistory) = m_matHistory;
+    m_matBuffer.rightCols(iNumSamples) = matDataIn;
+
+    //The output samples lie at m_iPosition + m*down on the upsampled grid of this block
+    qint64 iGridLength = qint64(iNumSamples) * m_iUp;
+    int iNumOutput = m_iPosition < iGridLength ? int((iGridLength - m_iPosition + m_iDown - 1) / m_iDown) : 0;
+
+    matDataOut.resize(iNumChannels, iNumOutput);
+
+    qint64 iPosition = m_iPosition;
+    for(int m = 0; m < iNumOutput; ++m, iPosition += m_iDown) {
+        int n = int(iPosition / m_iUp);
+        int p = int(iPosition % m_iUp);
+
+        //The taps-1 preceding samples and sample n, one matrix-vector product over all channels
+        matDataOut.col(m).noalias() = m_matBuffer.middleCols(n, m_iTaps) * m_matPhases.col(p);
+    }
+
+    m_iPosition = int(iPosition - iGridLength);
+
+    //Keep the last taps-1 samples for the next block
+    m_matHistory = m_matBuffer.rightCols(iHistory);
+}
@@ -0,0 +1,189 @@
+//=============================================================================================================
+/**
+* @file     rtresample.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RtResample class declaration.
+*
+*/
+
+#ifndef RTRESAMPLE_H
+#define RTRESAMPLE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtprocessing_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+
+//=============================================================================================================
+/**
+* Resamples consecutive data blocks by the rational factor up/down with a polyphase FIR filter. The Kaiser windowed
+* anti-aliasing lowpass is split into up phases, so each output sample is computed from taps/up input samples
+* only, without stuffing zeros or computing samples which are dropped. The input history and the phase are kept
+* between blocks, hence the number of output samples per block may vary by one. Decimation is the case up = 1.
+*
+* @brief Real-time polyphase resampler
+*/
+class RTPROCESINGSHARED_EXPORT RtResample
+{
+
+public:
+    typedef QSharedPointer<RtResample> SPtr;             /**< Shared pointer type for RtResample. */
+    typedef QSharedPointer<const RtResample> ConstSPtr;  /**< Const shared pointer type for RtResample. */
+
+    //=========================================================================================================
+    /**
+    * Creates the real-time resampler.
+    *
+    * @param [in] iUp               the upsampling factor
+    * @param [in] iDown             the downsampling factor
+    * @param [in] iZeroCrossings    number of zero crossings of the windowed sinc on each side, the filter has 2*iZeroCrossings*max(iUp,iDown)+1 taps
+    */
+    explicit RtResample(int iUp = 1, int iDown = 1, int iZeroCrossings = 10);
+
+    //=========================================================================================================
+    /**
+    * Sets the resampling factor up/down, designs the anti-aliasing filter and resets the state.
+    *
+    * @param [in] iUp               the upsampling factor
+    * @param [in] iDown             the downsampling factor
+    * @param [in] iZeroCrossings    number of zero crossings of the windowed sinc on each side
+    *
+    * @return true if the factor could be set, false if a parameter is not positive
+    */
+    bool setRatio(int iUp, int iDown, int iZeroCrossings = 10);
+
+    //=========================================================================================================
+    /**
+    * Clears the input history and the phase, e.g. after a gap in the data.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Resamples the next data block. matDataOut may be the same object as matDataIn.
+    *
+    * @param [in] matDataIn     the data block (channels x samples) at the input sampling rate
+    * @param [out] matDataOut   the resampled block (channels x samples) at the output sampling rate, may have no columns
+    */
+    void resample(const Eigen::MatrixXd& matDataIn, Eigen::MatrixXd& matDataOut);
+
+    //=========================================================================================================
+    /**
+    * Returns the upsampling factor.
+    *
+    * @return the upsampling factor
+    */
+    inline int getUp() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the downsampling factor.
+    *
+    * @return the downsampling factor
+    */
+    inline int getDown() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the group delay of the anti-aliasing filter in output samples.
+    *
+    * @return the delay
+    */
+    inline double getDelay() const;
+
+private:
+    int                 m_iUp;          /**< The upsampling factor. */
+    int                 m_iDown;        /**< The downsampling factor. */
+    int                 m_iTaps;        /**< Number of taps of each phase. */
+    int                 m_iFilterLength;/**< Number of taps of the prototype filter. */
+    int                 m_iPosition;    /**< Position of the next output sample on the upsampled grid, relative to the first sample of the next block. */
+
+    Eigen::MatrixXd     m_matPhases;    /**< The phases of the prototype filter (taps x up), reversed to be applied to the input in time order. */
+    Eigen::MatrixXd     m_matHistory;   /**< The last taps-1 input samples (channels x (taps-1)). */
+    Eigen::MatrixXd     m_matBuffer;    /**< The history followed by the current block (channels x (taps-1+samples)). */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int RtResample::getUp() const
+{
+    return m_iUp;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtResample::getDown() const
+{
+    return m_iDown;
+}
+
+
+//*************************************************************************************************************
+
+inline double RtResample::getDelay() const
+{
+    return (m_iFilterLength-1) / (2.0*m_iDown);
+}
+
+} // NAMESPACE
+
+#endif // RTRESAMPLE_H
@@ -46,6 +46,7 @@
 
 #include "parksmcclellan.h"
 #include "cosinefilter.h"
+#include "iirfilter.h"
 
 
 //*************************************************************************************************************
@@ -54,6 +55,8 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <cmath>
+#include <limits>
 
 
 //*************************************************************************************************************
@@ -62,6 +65,8 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QHash>
+#include <QThreadStorage>
 
 
 //*************************************************************************************************************
@@ -84,6 +89,46 @@
 using namespace UTILSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+/**
+* Work buffers of applyFFTFilter for one FFT length.
+*/
+struct FilterFFTBuffers
+{
+    RowVectorXd     dataZeroPad;    /**< The zero-padded or mirrored input. */
+    RowVectorXcd    freqData;       /**< The half spectrum of the input. */
+    RowVectorXd     filteredTime;   /**< The filtered time series. */
+};
+
+/**
+* FFT engine of one thread. The Eigen FFT object keeps its plans (twiddles and work buffers) per FFT length, so
+* reusing it avoids the plan setup and all temporaries on each call.
+*/
+struct FilterFFTWorkspace
+{
+    FilterFFTWorkspace()
+    {
+        fft.SetFlag(fft.HalfSpectrum);
+    }
+
+    Eigen::FFT<double>          fft;        /**< The FFT engine. */
+    QHash<int, FilterFFTBuffers> buffers;   /**< Work buffers per FFT length. */
+};
+
+static QThreadStorage<FilterFFTWorkspace*> s_filterFFTWorkspace;
+
+static FilterFFTWorkspace& filterFFTWorkspace()
+{
+    if(!s_filterFFTWorkspace.hasLocalData())
+        s_filterFFTWorkspace.setLocalData(new FilterFFTWorkspace);
+    return *s_filterFFTWorkspace.localData();
+}
+
+
 //*************************************************************************************************************
 
 FilterData::FilterData()
@@ -92,6 +137,8 @@ FilterData::FilterData()
 , m_iFFTlength(512)
 , m_sName("Unknown")
 , m_dParksWidth(0.1)
+, m_dPassbandRipple(1.0)
+, m_bMinimumPhase(false)
 , m_designMethod(External)
 , m_dCenterFreq(0.5)
 , m_dBandwidth(0.1)
@@ -105,12 +152,14 @@ FilterData::FilterData()
 
 //*************************************************************************************************************
 
-FilterData::FilterData(QString unique_name, FilterType type, int order, double centerfreq, double bandwidth, double parkswidth, double sFreq, qint32 fftlength, DesignMethod designMethod)
+FilterData::FilterData(QString unique_name, FilterType type, int order, double centerfreq, double bandwidth, double parkswidth, double sFreq, qint32 fftlength, DesignMethod designMethod, bool minimumPhase)
 : m_Type(type)
 , m_iFilterOrder(order)
 , m_iFFTlength(fftlength)
 , m_sName(unique_name)
 , m_dParksWidth(parkswidth)
+, m_dPassbandRipple(1.0)
+, m_bMinimumPhase(minimumPhase)
 , m_designMethod(designMethod)
 , m_dCenterFreq(centerfreq)
 , m_dBandwidth(bandwidth)
@@ -124,6 +173,8 @@ FilterData::FilterData(QString unique_name, FilterType type, int order, double c
 
 void FilterData::designFilter()
 {
+    m_matSOS.resize(0, 6);
+
     switch(m_designMethod) {
         case Tschebyscheff: {
             ParksMcClellan filter(m_iFilterOrder, m_dCenterFreq, m_dBandwidth, m_dParksWidth, (ParksMcClellan::TPassType)m_Type);
@@ -183,6 +234,57 @@ void FilterData::designFilter()
 
             break;
         }
+
+        case Butterworth:
+        case Chebyshev: {
+            double dLowFreq = 0;
+            double dHighFreq = 0;
+
+            switch(m_Type) {
+                case LPF:
+                    dHighFreq = m_dCenterFreq*(m_sFreq/2);
+                    break;
+
+                case HPF:
+                    dLowFreq = m_dCenterFreq*(m_sFreq/2);
+                    break;
+
+                default:
+                    dLowFreq = (m_dCenterFreq - m_dBandwidth/2)*(m_sFreq/2);
+                    dHighFreq = (m_dCenterFreq + m_dBandwidth/2)*(m_sFreq/2);
+                    break;
+            }
+
+            IIRFilter filteriir(m_designMethod == Butterworth ? IIRFilter::Butterworth : IIRFilter::Chebyshev,
+                                m_iFilterOrder,
+                                dLowFreq,
+                                dHighFreq,
+                                m_dPassbandRipple,
+                                m_sFreq,
+                                (IIRFilter::TPassType)m_Type);
+
+            m_matSOS = filteriir.m_matSOS;
+
+            //The frequency-domain code paths and the filter plots use the impulse response, shortened where it has decayed
+            RowVectorXd vecResponse = IIRFilter::impulseResponse(m_matSOS, qMax(2, m_iFFTlength/4));
+
+            int iLength = vecResponse.cols();
+            double dThreshold = 1e-4 * vecResponse.cwiseAbs().maxCoeff();
+            while(iLength > 2 && std::fabs(vecResponse(iLength-1)) <= dThreshold) {
+                --iLength;
+            }
+            iLength += iLength%2;
+
+            m_dCoeffA = vecResponse.head(qMin(iLength, int(vecResponse.cols())));
+
+            fftTransformCoeffs();
+
+            break;
+        }
+    }
+
+    if(m_bMinimumPhase && !isIIR()) {
+        convertToMinimumPhase();
     }
 
     switch(m_Type) {
@@ -227,6 +329,53 @@ void FilterData::fftTransformCoeffs()
 }
 
 
+//*************************************************************************************************************
+
+void FilterData::convertToMinimumPhase()
+{
+    int iTaps = m_dCoeffA.cols();
+
+    if(iTaps == 0 || isIIR()) {
+        return;
+    }
+
+    //The real cepstrum is aliased by the FFT, hence use at least eight times the number of taps
+    int iFFTLength = qMax(m_iFFTlength, 2);
+    while(iFFTLength < 8*iTaps) {
+        iFFTLength *= 2;
+    }
+
+    FilterFFTWorkspace& workspace = filterFFTWorkspace();
+
+    RowVectorXd vecTime = RowVectorXd::Zero(iFFTLength);
+    vecTime.head(iTaps) = m_dCoeffA;
+
+    RowVectorXcd vecFreq;
+    workspace.fft.fwd(vecFreq, vecTime);
+
+    //Real cepstrum of the log magnitude, floored to stay finite at the zeros of the stop band
+    RowVectorXd vecMagnitude = vecFreq.cwiseAbs();
+    double dFloor = qMax(vecMagnitude.maxCoeff() * 1e-10, std::numeric_limits<double>::min());
+
+    vecFreq = vecMagnitude.cwiseMax(dFloor).array().log().cast<std::complex<double> >();
+    workspace.fft.inv(vecTime, vecFreq, iFFTLength);
+
+    //Fold the anti-causal part of the cepstrum onto the causal part
+    vecTime.segment(1, iFFTLength/2-1) *= 2.0;
+    vecTime.tail(iFFTLength/2-1).setZero();
+
+    //The exponential of its spectrum is the minimum-phase spectrum with the same magnitude
+    workspace.fft.fwd(vecFreq, vecTime);
+    vecFreq = vecFreq.array().exp();
+    workspace.fft.inv(vecTime, vecFreq, iFFTLength);
+
+    m_dCoeffA = vecTime.head(iTaps);
+    m_bMinimumPhase = true;
+
+    fftTransformCoeffs();
+}
+
+
 //*************************************************************************************************************
 
 RowVectorXd FilterData::applyConvFilter(const RowVectorXd& data, bool keepOverhead, CompensateEdgeEffects compensateEdgeEffects) const
@@ -271,6 +420,18 @@ RowVectorXd FilterData::applyConvFilter(const RowVectorXd& data, bool keepOverhe
 //*************************************************************************************************************
 
 RowVectorXd FilterData::applyFFTFilter(const RowVectorXd& data, bool keepOverhead, CompensateEdgeEffects compensateEdgeEffects) const
+{
+    RowVectorXd filtered;
+    if(!applyFFTFilter(data, filtered, keepOverhead, compensateEdgeEffects))
+        return data;
+
+    return filtered;
+}
+
+
+//*************************************************************************************************************
+
+bool FilterData::applyFFTFilter(const RowVectorXd& data, RowVectorXd& filtered, bool keepOverhead, CompensateEdgeEffects compensateEdgeEffects) const
 {
     #ifdef EIGEN_FFTW_DEFAULT
         fftw_make_planner_thread_safe();
@@ -278,7 +439,7 @@ RowVectorXd FilterData::applyFFTFilter(const RowVectorXd& data, bool keepOverhea
 
     if(data.cols()<m_dCoeffA.cols() && compensateEdgeEffects==MirrorData) {
         qDebug()<<QString("Error in FilterData: Number of filter taps(%1) bigger then data size(%2). Not enough data to perform mirroring!").arg(m_dCoeffA.cols()).arg(data.cols());
-        return data;
+        return false;
     }
 
 //    std::cout<<"m_iFFTlength: "<<m_iFFTlength<<std::endl;
@@ -286,11 +447,16 @@ RowVectorXd FilterData::applyFFTFilter(const RowVectorXd& data, bool keepOverhea
 
     if(2*m_dCoeffA.cols() + data.cols()>m_iFFTlength) {
         qDebug()<<"Error in FilterData: Number of mirroring/zeropadding size plus data size is bigger then fft length!";
-        return data;
+        return false;
     }
 
+    //get the fft object and the work buffers of this thread
+    FilterFFTWorkspace& workspace = filterFFTWorkspace();
+    FilterFFTBuffers& buffers = workspace.buffers[m_iFFTlength];
+
     //Do zero padding or mirroring depending on user input
-    RowVectorXd t_dataZeroPad = RowVectorXd::Zero(m_iFFTlength);
+    RowVectorXd& t_dataZeroPad = buffers.dataZeroPad;
+    t_dataZeroPad.setZero(m_iFFTlength);
 
     switch(compensateEdgeEffects) {
         case MirrorData:
@@ -308,26 +474,27 @@ RowVectorXd FilterData::applyFFTFilter(const RowVectorXd& data, bool keepOverhea
             break;
     }
 
-    //generate fft object
-    Eigen::FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
+    //data is not used anymore, filtered may alias it
+    int iDataLength = data.cols();
 
     //fft-transform data sequence
-    RowVectorXcd t_freqData;
-    fft.fwd(t_freqData,t_dataZeroPad);
+    RowVectorXcd& t_freqData = buffers.freqData;
+    workspace.fft.fwd(t_freqData,t_dataZeroPad);
 
     //perform frequency-domain filtering
-    RowVectorXcd t_filteredFreq = m_dFFTCoeffA.array()*t_freqData.array();
+    t_freqData.array() *= m_dFFTCoeffA.array();
 
     //inverse-FFT
-    RowVectorXd t_filteredTime;
-    fft.inv(t_filteredTime,t_filteredFreq);
+    RowVectorXd& t_filteredTime = buffers.filteredTime;
+    workspace.fft.inv(t_filteredTime,t_freqData);
 
-    //Return filtered data
+    //Return filtered data, behind the mirrored lead-in if there is one
     if(!keepOverhead)
-        return t_filteredTime.segment(m_dCoeffA.cols()/2, data.cols());
+        filtered = t_filteredTime.segment(getDelay() + (compensateEdgeEffects == MirrorData ? m_dCoeffA.cols() : 0), iDataLength);
+    else
+        filtered = t_filteredTime.head(iDataLength+m_dCoeffA.cols());
 
-    return t_filteredTime.head(data.cols()+m_dCoeffA.cols());
+    return true;
 }
 
 
@@ -346,6 +513,12 @@ QString FilterData::getStringForDesignMethod(const FilterData::DesignMethod &des
     if(designMethod == FilterData::Tschebyscheff)
         designMethodString = "Tschebyscheff";
 
+    if(designMethod == FilterData::Butterworth)
+        designMethodString = "Butterworth";
+
+    if(designMethod == FilterData::Chebyshev)
+        designMethodString = "Chebyshev";
+
     return designMethodString;
 }
 
@@ -387,6 +560,12 @@ FilterData::DesignMethod FilterData::getDesignMethodForString(const QString &des
     if(designMethodString == "Cosine")
         designMethod = FilterData::Cosine;
 
+    if(designMethodString == "Butterworth")
+        designMethod = FilterData::Butterworth;
+
+    if(designMethodString == "Chebyshev")
+        designMethod = FilterData::Chebyshev;
+
     return designMethod;
 }
 
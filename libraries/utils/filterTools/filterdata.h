@@ -102,7 +102,9 @@ public:
     enum DesignMethod {
         Tschebyscheff,
         Cosine,
-        External
+        External,
+        Butterworth,
+        Chebyshev
     } m_designMethod;
 
     enum FilterType {
@@ -134,9 +136,10 @@ public:
     * @param [in] parkswidth determines the width of the filter slopes (steepness)
     * @param [in] sFreq sampling frequency
     * @param [in] fftlength length of the fft (multiple integer of 2^x)
-    * @param [in] designMethod specifies the design method to use. Choose between Cosind and Tschebyscheff
+    * @param [in] designMethod specifies the design method to use. Choose between Cosind and Tschebyscheff (FIR) or Butterworth and Chebyshev (IIR). For IIR designs order is the order of the analog prototype.
+    * @param [in] minimumPhase whether FIR designs are converted to minimum phase, which removes their delay of order/2 samples
     */
-    FilterData(QString unique_name, FilterType type, int order, double centerfreq, double bandwidth, double parkswidth, double sFreq, qint32 fftlength=4096, DesignMethod designMethod = Cosine);
+    FilterData(QString unique_name, FilterType type, int order, double centerfreq, double bandwidth, double parkswidth, double sFreq, qint32 fftlength=4096, DesignMethod designMethod = Cosine, bool minimumPhase = false);
 
     /**
      * @brief fftTransformCoeffs transforms the calculated filter coefficients to frequency-domain
@@ -148,6 +151,11 @@ public:
      */
     void designFilter();
 
+    /**
+     * @brief convertToMinimumPhase replaces the FIR coefficients by the minimum-phase filter with the same magnitude response, computed with the cepstral method
+     */
+    void convertToMinimumPhase();
+
     /**
     * Applies the current filter to the input data using convolution in time domain. Pro: Uses only past samples (real-time capable) Con: Might not be as ideal as acausal version (steepness etc.)
     *
@@ -169,6 +177,30 @@ public:
     */
     RowVectorXd applyFFTFilter(const RowVectorXd& data, bool keepOverhead = false, CompensateEdgeEffects compensateEdgeEffects = MirrorData) const;
 
+    /**
+    * Applies the current filter to the input data using multiplication in frequency domain and writes the result to filtered.
+    * The FFT plan and the zero-padded work buffers are kept per thread and per FFT length, so repeated calls do not allocate
+    * as long as filtered already has the size of the result. filtered may be the same object as data.
+    *
+    * @param [in] data holds the data to be filtered
+    * @param [out] filtered the filtered data
+    * @param [in] keepOverhead whether the result should still include the overhead information in front and back of the data
+    * @param [in] compensateEdgeEffects defines how the edge effects should be handlted. Choose between ZeroPad and Mirroring
+    *
+    * @return true if the data could be filtered, false if filtered was left untouched
+    */
+    bool applyFFTFilter(const RowVectorXd& data, RowVectorXd& filtered, bool keepOverhead = false, CompensateEdgeEffects compensateEdgeEffects = MirrorData) const;
+
+    /**
+     * @brief isIIR returns whether the filter is an IIR filter, which is applied causally via its second-order sections m_matSOS
+     */
+    inline bool isIIR() const;
+
+    /**
+     * @brief getDelay returns the delay in samples which is compensated when the filter is applied. Linear-phase FIR filters delay by half their taps, minimum-phase and IIR filters are applied without compensation.
+     */
+    inline int getDelay() const;
+
     /**
      * @brief getStringForDesignMethod returns the current design method as a string
      */
@@ -195,17 +227,21 @@ public:
     double          m_dCenterFreq;      /**< contains center freq of the filter. */
     double          m_dBandwidth;       /**< contains bandwidth of the filter. */
     double          m_dParksWidth;      /**< contains the parksmcallen width. */
+    double          m_dPassbandRipple;  /**< the pass band ripple in dB of the Chebyshev design. */
+    bool            m_bMinimumPhase;    /**< whether the FIR coefficients were converted to minimum phase. */
 
     double          m_dLowpassFreq;     /**< lowpass freq (higher cut off) of the filter. */
     double          m_dHighpassFreq;        /**< lowpass freq (lower cut off) of the filter. */
 
     QString         m_sName;            /**< contains name of the filter. */
 
-    RowVectorXd     m_dCoeffA;          /**< contains the forward filter coefficient set. */
+    RowVectorXd     m_dCoeffA;          /**< contains the forward filter coefficient set. For IIR filters the impulse response, truncated where it has decayed. */
     RowVectorXd     m_dCoeffB;          /**< contains the backward filter coefficient set (empty if FIR filter). */
 
     RowVectorXcd    m_dFFTCoeffA;       /**< the FFT-transformed forward filter coefficient set, required for frequency-domain filtering, zero-padded to m_iFFTlength. */
     RowVectorXcd    m_dFFTCoeffB;       /**< the FFT-transformed backward filter coefficient set, required for frequency-domain filtering, zero-padded to m_iFFTlength. */
+
+    MatrixXd        m_matSOS;           /**< the second-order sections of IIR filters, one per row (b0 b1 b2 a0 a1 a2), empty for FIR filters. */
 };
 
 //*************************************************************************************************************
@@ -213,6 +249,23 @@ public:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+inline bool FilterData::isIIR() const
+{
+    return m_matSOS.rows() > 0;
+}
+
+
+//*************************************************************************************************************
+
+inline int FilterData::getDelay() const
+{
+    if(isIIR() || m_bMinimumPhase) {
+        return 0;
+    }
+
+    return m_dCoeffA.cols()/2;
+}
+
 } // NAMESPACE UTILSLIB
 
 #ifndef metatype_filtertype
@@ -0,0 +1,352 @@
+//=============================================================================================================
+/**
+* @file     filteroverlapadd.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FilterOverlapAdd class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "filteroverlapadd.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QThread>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FilterOverlapAdd::FilterOverlapAdd()
+: m_iFFTLength(0)
+, m_iFilterLength(0)
+, m_iDelay(0)
+, m_bDelayPassThrough(true)
+{
+}
+
+
+//*************************************************************************************************************
+
+bool FilterOverlapAdd::setFilters(const QList<FilterData>& lFilterData)
+{
+    int iFFTLength = 0;
+    int iFilterLength = 0;
+    int iNumSections = 0;
+
+    for(int i = 0; i < lFilterData.size(); ++i) {
+        if(lFilterData.at(i).isIIR()) {
+            iNumSections += lFilterData.at(i).m_matSOS.rows();
+            continue;
+        }
+
+        if(iFFTLength == 0) {
+            iFFTLength = lFilterData.at(i).m_iFFTlength;
+        } else if(lFilterData.at(i).m_iFFTlength != iFFTLength) {
+            qDebug()<<"Error in FilterOverlapAdd: All FIR filters of the chain need to have the same FFT length!";
+            return false;
+        }
+        iFilterLength += lFilterData.at(i).m_dCoeffA.cols();
+    }
+
+    //The IIR filters are stacked into one cascade of second-order sections, the FIR coefficients are concatenated
+    MatrixXd matSOS(iNumSections, 6);
+    RowVectorXd vecCoeffs(iFilterLength);
+
+    for(int i = 0, iSection = 0, pos = 0; i < lFilterData.size(); ++i) {
+        const FilterData& filter = lFilterData.at(i);
+
+        if(filter.isIIR()) {
+            matSOS.middleRows(iSection, filter.m_matSOS.rows()) = filter.m_matSOS;
+            iSection += filter.m_matSOS.rows();
+        } else {
+            vecCoeffs.segment(pos, filter.m_dCoeffA.cols()) = filter.m_dCoeffA;
+            pos += filter.m_dCoeffA.cols();
+        }
+    }
+
+    if(!m_filterSOS.setSections(matSOS)) {
+        return false;
+    }
+
+    //Nothing to do if the FIR filters did not change
+    if(iFFTLength == m_iFFTLength && vecCoeffs.cols() == m_vecCoeffs.cols() && vecCoeffs == m_vecCoeffs) {
+        return true;
+    }
+
+    //Compose the frequency response and the delay of the chain
+    m_iFFTLength = iFFTLength;
+    m_iFilterLength = iFilterLength;
+    m_vecCoeffs = vecCoeffs;
+    m_iDelay = 0;
+    m_vecFreqResp = VectorXcd::Ones(m_iFFTLength/2+1);
+
+    for(int i = 0; i < lFilterData.size(); ++i) {
+        if(!lFilterData.at(i).isIIR()) {
+            m_vecFreqResp.array() *= lFilterData.at(i).m_dFFTCoeffA.transpose().array();
+            m_iDelay += lFilterData.at(i).getDelay();
+        }
+    }
+
+    m_matOverlap.setZero(m_vecFilterChannels.size(), m_iFilterLength);
+    m_matDelay.resize(0, 0);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FilterOverlapAdd::setFilterChannels(const QVector<int>& vecFilterChannels)
+{
+    if(vecFilterChannels == m_vecFilterChannels) {
+        return;
+    }
+
+    //Keep the overlap and the IIR state of the channels which stay selected
+    MatrixXd matOverlap = MatrixXd::Zero(vecFilterChannels.size(), m_iFilterLength);
+    const MatrixXd& matOldState = m_filterSOS.getState();
+    bool bKeepState = matOldState.size() > 0 && matOldState.rows() == m_vecFilterChannels.size();
+    MatrixXd matState = MatrixXd::Zero(bKeepState ? vecFilterChannels.size() : 0, matOldState.cols());
+    int iMaxChannel = -1;
+
+    for(int s = 0; s < vecFilterChannels.size(); ++s) {
+        int ch = vecFilterChannels.at(s);
+        int iOldSlot = ch < m_vecChannelSlot.size() ? m_vecChannelSlot.at(ch) : -1;
+
+        if(iOldSlot >= 0 && m_matOverlap.cols() == m_iFilterLength) {
+            matOverlap.row(s) = m_matOverlap.row(iOldSlot);
+        }
+
+        if(iOldSlot >= 0 && bKeepState) {
+            matState.row(s) = matOldState.row(iOldSlot);
+        }
+
+        iMaxChannel = qMax(iMaxChannel, ch);
+    }
+
+    m_matOverlap = matOverlap;
+    m_filterSOS.setState(matState);
+    m_vecFilterChannels = vecFilterChannels;
+
+    m_vecChannelSlot.fill(-1, iMaxChannel+1);
+    for(int s = 0; s < m_vecFilterChannels.size(); ++s) {
+        m_vecChannelSlot[m_vecFilterChannels.at(s)] = s;
+    }
+
+    //Split the slots into one chunk per thread, each chunk has its own FFT object
+    int iNumChunks = qMax(1, qMin(QThread::idealThreadCount(), m_vecFilterChannels.size()));
+
+    m_vecChunks.resize(iNumChunks);
+    for(int i = 0; i < iNumChunks; ++i) {
+        m_vecChunks[i] = i;
+    }
+
+    m_vecFFT.resize(iNumChunks);
+    for(int i = 0; i < iNumChunks; ++i) {
+        m_vecFFT[i].SetFlag(Eigen::FFT<double>::HalfSpectrum);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FilterOverlapAdd::setDelayPassThrough(bool bDelayPassThrough)
+{
+    m_bDelayPassThrough = bDelayPassThrough;
+    m_matDelay.resize(0, 0);
+}
+
+
+//*************************************************************************************************************
+
+void FilterOverlapAdd::reset()
+{
+    m_matOverlap.setZero(m_vecFilterChannels.size(), m_iFilterLength);
+    m_matDelay.resize(0, 0);
+    m_filterSOS.reset();
+}
+
+
+//*************************************************************************************************************
+
+bool FilterOverlapAdd::filterData(const MatrixXd& matDataIn, MatrixXd& matDataOut)
+{
+    int iNumChannels = matDataIn.rows();
+    int iNumSamples = matDataIn.cols();
+    int iNumSlots = m_vecFilterChannels.size();
+    bool bFIR = m_iFilterLength > 0;
+    bool bIIR = m_filterSOS.getSections().rows() > 0;
+
+    if(!bFIR && !bIIR) {
+        matDataOut = matDataIn;
+        return true;
+    }
+
+    if(bFIR && iNumSamples + m_iFilterLength > m_iFFTLength) {
+        qDebug()<<"Error in FilterOverlapAdd: Number of filter taps plus data size is bigger then fft length!";
+        return false;
+    }
+
+    //Gather the filtered channels before matDataOut is touched, it may alias matDataIn. The IIR stage runs first.
+    if(bIIR) {
+        m_matSOSWork.resize(iNumSlots, iNumSamples);
+
+        for(int s = 0; s < iNumSlots; ++s) {
+            int ch = m_vecFilterChannels.at(s);
+
+            if(ch < iNumChannels) {
+                m_matSOSWork.row(s) = matDataIn.row(ch);
+            } else {
+                m_matSOSWork.row(s).setZero();
+            }
+        }
+
+        m_filterSOS.filterData(m_matSOSWork);
+    }
+
+    //Transpose the filtered channels into the zero-padded work matrix of the FIR stage
+    if(bFIR) {
+        m_matWork.resize(m_iFFTLength, iNumSlots);
+        m_matWorkFreq.resize(m_iFFTLength/2+1, iNumSlots);
+
+        for(int s = 0; s < iNumSlots; ++s) {
+            int ch = m_vecFilterChannels.at(s);
+
+            if(bIIR) {
+                m_matWork.col(s).head(iNumSamples) = m_matSOSWork.row(s).transpose();
+                m_matWork.col(s).tail(m_iFFTLength-iNumSamples).setZero();
+            } else if(ch < iNumChannels) {
+                m_matWork.col(s).head(iNumSamples) = matDataIn.row(ch).transpose();
+                m_matWork.col(s).tail(m_iFFTLength-iNumSamples).setZero();
+            } else {
+                m_matWork.col(s).setZero();
+            }
+        }
+    }
+
+    matDataOut.resize(iNumChannels, iNumSamples);
+
+    //Delay the channels which are passed through by the group delay of the filter chain
+    if(m_bDelayPassThrough) {
+        if(m_matDelay.rows() != iNumChannels || m_matDelay.cols() != m_iDelay) {
+            m_matDelay.setZero(iNumChannels, m_iDelay);
+        }
+
+        m_vecDelayLine.resize(m_iDelay + iNumSamples);
+
+        for(int ch = 0; ch < iNumChannels; ++ch) {
+            if(isFilterChannel(ch)) {
+                continue;
+            }
+
+            m_vecDelayLine.head(m_iDelay) = m_matDelay.row(ch);
+            m_vecDelayLine.tail(iNumSamples) = matDataIn.row(ch);
+            matDataOut.row(ch) = m_vecDelayLine.head(iNumSamples);
+            m_matDelay.row(ch) = m_vecDelayLine.tail(m_iDelay);
+        }
+    }
+
+    //Without FIR filters the output of the IIR stage is the result
+    if(!bFIR) {
+        for(int s = 0; s < iNumSlots; ++s) {
+            if(m_vecFilterChannels.at(s) < iNumChannels) {
+                matDataOut.row(m_vecFilterChannels.at(s)) = m_matSOSWork.row(s);
+            }
+        }
+
+        return true;
+    }
+
+    //Filter the slots, chunk by chunk on the thread pool
+    if(iNumSlots == 0) {
+        return true;
+    }
+
+    int iNumChunks = m_vecChunks.size();
+    int iChunkSize = (iNumSlots + iNumChunks - 1) / iNumChunks;
+
+    if(iNumChunks == 1) {
+        filterColumns(0, 0, iNumSlots, iNumSamples, matDataOut);
+    } else {
+        QtConcurrent::blockingMap(m_vecChunks, [&](const int& iChunk) {
+            int first = iChunk * iChunkSize;
+            filterColumns(iChunk, first, qMin(iChunkSize, iNumSlots - first), iNumSamples, matDataOut);
+        });
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FilterOverlapAdd::filterColumns(int iChunk, int first, int num, int iNumSamples, MatrixXd& matDataOut)
+{
+    Eigen::FFT<double>& fft = m_vecFFT[iChunk];
+
+    for(int s = first; s < first + num; ++s) {
+        //fft-transform, perform frequency-domain filtering and inverse-FFT
+        fft.fwd(m_matWorkFreq.col(s).data(), m_matWork.col(s).data(), m_iFFTLength);
+        m_matWorkFreq.col(s).array() *= m_vecFreqResp.array();
+        fft.inv(m_matWork.col(s).data(), m_matWorkFreq.col(s).data(), m_iFFTLength);
+
+        //Perform the overlap add and keep the new overlap for the next block
+        int ch = m_vecFilterChannels.at(s);
+        m_matWork.col(s).head(m_iFilterLength) += m_matOverlap.row(s).transpose();
+        m_matOverlap.row(s) = m_matWork.col(s).segment(iNumSamples, m_iFilterLength).transpose();
+
+        if(ch < matDataOut.rows()) {
+            matDataOut.row(ch) = m_matWork.col(s).head(iNumSamples).transpose();
+        }
+    }
+}
@@ -0,0 +1,250 @@
+//=============================================================================================================
+/**
+* @file     filteroverlapadd.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    The FilterOverlapAdd class applies a chain of FIR filters to consecutive multi-channel data blocks
+*           using the overlap-add method [1]. The frequency responses of the chain are multiplied to a single
+*           response once. Each block is transposed into a zero-padded work matrix with one column per filtered
+*           channel, so that the FFTs, the frequency-domain multiplication and the overlap-add run on contiguous
+*           memory. The FFT plans, the work matrices and the overlap state are kept between blocks. IIR filters
+*           of the chain are applied causally before the FIR filters via their second-order sections (FilterSOS).
+*
+*           [1] http://en.wikipedia.org/wiki/Overlap_add
+*/
+
+#ifndef FILTEROVERLAPADD_H
+#define FILTEROVERLAPADD_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+#include "filterdata.h"
+#include "filtersos.h"
+
+#include <vector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QList>
+#include <QVector>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//=============================================================================================================
+/**
+* Filters consecutive multi-channel data blocks with a chain of FIR and IIR filters. The overlap, the IIR state
+* and the delay line of the passed through channels are kept between blocks, so that the blocks of a stream can
+* be filtered one by one.
+*
+* @brief Overlap-add filtering of consecutive data blocks.
+*/
+class UTILSSHARED_EXPORT FilterOverlapAdd
+{
+
+public:
+    typedef QSharedPointer<FilterOverlapAdd> SPtr;            /**< Shared pointer type for FilterOverlapAdd. */
+    typedef QSharedPointer<const FilterOverlapAdd> ConstSPtr; /**< Const shared pointer type for FilterOverlapAdd. */
+
+    /**
+    * Constructs an empty FilterOverlapAdd object, which passes all data through.
+    */
+    FilterOverlapAdd();
+
+    /**
+    * Sets the filter chain. All FIR filters have to share the same FFT length. The overlap and IIR state is reset if
+    * the chain differs from the current one.
+    *
+    * @param [in] lFilterData the filters which are applied one after another
+    *
+    * @return true if the chain could be set up, false if the FFT lengths of the filters differ
+    */
+    bool setFilters(const QList<FilterData>& lFilterData);
+
+    /**
+    * Sets the channels (rows) which are filtered. The overlap and IIR state of channels which stay selected is kept.
+    *
+    * @param [in] vecFilterChannels the indices of the filtered channels
+    */
+    void setFilterChannels(const QVector<int>& vecFilterChannels);
+
+    /**
+    * Sets whether the channels which are passed through are delayed into the output. Callers which only use the
+    * filtered channels can switch this off, the remaining rows of the output are then left untouched. On by default.
+    *
+    * @param [in] bDelayPassThrough whether to delay and write the passed through channels
+    */
+    void setDelayPassThrough(bool bDelayPassThrough);
+
+    /**
+    * Clears the overlap, IIR and delay state, e.g. after a gap in the data.
+    */
+    void reset();
+
+    /**
+    * Filters the next data block. Filtered channels are delayed by the group delay of the FIR filters (getDelay),
+    * the remaining channels are delayed by the same number of samples, so that all channels stay aligned, see
+    * setDelayPassThrough.
+    * matDataOut may be the same object as matDataIn.
+    *
+    * @param [in] matDataIn the data block (channels x samples)
+    * @param [out] matDataOut the filtered data block (channels x samples)
+    *
+    * @return true if the block could be filtered, false if the block does not fit into the FFT length
+    */
+    bool filterData(const Eigen::MatrixXd& matDataIn, Eigen::MatrixXd& matDataOut);
+
+    /**
+    * Returns the number of taps of the composed FIR filters, which is also the length of the overlap.
+    *
+    * @return the number of taps
+    */
+    inline int getFilterLength() const;
+
+    /**
+    * Returns the group delay of the FIR filters in samples. The IIR filters add their (frequency dependent) phase delay.
+    *
+    * @return the delay
+    */
+    inline int getDelay() const;
+
+    /**
+    * Returns the indices of the filtered channels.
+    *
+    * @return the filtered channels
+    */
+    inline const QVector<int>& getFilterChannels() const;
+
+    /**
+    * Returns whether the channel is filtered, in O(1).
+    *
+    * @param [in] iChannel the channel index
+    *
+    * @return true if the channel is filtered, false if it is passed through
+    */
+    inline bool isFilterChannel(int iChannel) const;
+
+private:
+    /**
+    * Transforms, filters and transforms back the work matrix columns first ... first+num-1, adds their overlap and
+    * writes the first iNumSamples samples to the rows of the corresponding channels in matDataOut.
+    *
+    * @param [in] iChunk index of the FFT object to use
+    * @param [in] first first column
+    * @param [in] num number of columns
+    * @param [in] iNumSamples number of samples of the current block
+    * @param [out] matDataOut the filtered data block
+    */
+    void filterColumns(int iChunk, int first, int num, int iNumSamples, Eigen::MatrixXd& matDataOut);
+
+    int                                 m_iFFTLength;       /**< The FFT length of the filter chain. */
+    int                                 m_iFilterLength;    /**< Number of taps of the composed filter chain. */
+    int                                 m_iDelay;           /**< Group delay of the filter chain in samples. */
+    bool                                m_bDelayPassThrough;    /**< Whether the passed through channels are delayed into the output. */
+    Eigen::RowVectorXd                  m_vecCoeffs;        /**< Concatenated coefficients of the chain, used to detect changes. */
+    Eigen::VectorXcd                    m_vecFreqResp;      /**< Half spectrum of the composed filter chain. */
+
+    QVector<int>                        m_vecFilterChannels;    /**< Slot -> channel. */
+    QVector<int>                        m_vecChannelSlot;       /**< Channel -> slot, -1 for channels which are passed through. */
+
+    Eigen::MatrixXd                     m_matOverlap;       /**< Overlap of each slot (slots x filter length). */
+    Eigen::MatrixXd                     m_matDelay;         /**< Delay line of the passed through channels (channels x delay). */
+    Eigen::MatrixXd                     m_matWork;          /**< Zero-padded time series, one column per slot (FFT length x slots). */
+    Eigen::MatrixXcd                    m_matWorkFreq;      /**< Half spectra, one column per slot. */
+    Eigen::MatrixXd                     m_matSOSWork;       /**< The filtered channels of the current block for the IIR stage (slots x samples). */
+    FilterSOS                           m_filterSOS;        /**< The stacked second-order sections of the IIR filters and their state per slot. */
+    Eigen::RowVectorXd                  m_vecDelayLine;     /**< Scratch for delaying a passed through channel in place. */
+    QVector<int>                        m_vecChunks;        /**< Chunk indices handed to the thread pool. */
+    std::vector<Eigen::FFT<double> >    m_vecFFT;           /**< One FFT object per chunk, they keep their plans between blocks. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int FilterOverlapAdd::getFilterLength() const
+{
+    return m_iFilterLength;
+}
+
+
+//*************************************************************************************************************
+
+inline int FilterOverlapAdd::getDelay() const
+{
+    return m_iDelay;
+}
+
+
+//*************************************************************************************************************
+
+inline const QVector<int>& FilterOverlapAdd::getFilterChannels() const
+{
+    return m_vecFilterChannels;
+}
+
+
+//*************************************************************************************************************
+
+inline bool FilterOverlapAdd::isFilterChannel(int iChannel) const
+{
+    return iChannel >= 0 && iChannel < m_vecChannelSlot.size() && m_vecChannelSlot.at(iChannel) >= 0;
+}
+
+} // NAMESPACE UTILSLIB
+
+#endif // FILTEROVERLAPADD_H
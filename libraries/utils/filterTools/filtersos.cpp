@@ -0,0 +1,146 @@
+//=============================================================================================================
+/**
+* @file     filtersos.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+* @brief    Definition of the FilterSOS class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "filtersos.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FilterSOS::FilterSOS()
+{
+}
+
+
+//*************************************************************************************************************
+
+bool FilterSOS::setSections(const MatrixXd& matSOS)
+{
+    if(matSOS.rows() > 0 && matSOS.cols() != 6) {
+        qDebug()<<"Error in FilterSOS: Second-order sections need six coefficients (b0 b1 b2 a0 a1 a2)!";
+        return false;
+    }
+
+    MatrixXd matSOSNorm = matSOS;
+    for(int s = 0; s < matSOSNorm.rows(); ++s) {
+        if(matSOSNorm(s,3) == 0.0) {
+            qDebug()<<"Error in FilterSOS: a0 of a second-order section must not be zero!";
+            return false;
+        }
+        matSOSNorm.row(s) /= matSOSNorm(s,3);
+    }
+
+    //Nothing to do if the sections did not change
+    if(matSOSNorm.rows() == m_matSOS.rows() && matSOSNorm == m_matSOS) {
+        return true;
+    }
+
+    m_matSOS = matSOSNorm;
+    reset();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FilterSOS::reset()
+{
+    m_matState.resize(0, 0);
+}
+
+
+//*************************************************************************************************************
+
+void FilterSOS::filterData(MatrixXd& matData)
+{
+    int iNumChannels = matData.rows();
+    int iNumSections = m_matSOS.rows();
+
+    if(iNumSections == 0 || iNumChannels == 0) {
+        return;
+    }
+
+    if(m_matState.rows() != iNumChannels || m_matState.cols() != 2*iNumSections) {
+        m_matState.setZero(iNumChannels, 2*iNumSections);
+    }
+
+    m_vecX.resize(iNumChannels);
+    m_vecY.resize(iNumChannels);
+
+    //Each sample column holds all channels contiguously, each step below is one vectorized operation over them
+    for(int n = 0; n < matData.cols(); ++n) {
+        m_vecX = matData.col(n);
+
+        for(int s = 0; s < iNumSections; ++s) {
+            const double b0 = m_matSOS(s,0), b1 = m_matSOS(s,1), b2 = m_matSOS(s,2);
+            const double a1 = m_matSOS(s,4), a2 = m_matSOS(s,5);
+
+            Map<ArrayXd> z1(m_matState.col(2*s).data(), iNumChannels);
+            Map<ArrayXd> z2(m_matState.col(2*s+1).data(), iNumChannels);
+
+            m_vecY.array() = b0 * m_vecX.array() + z1;
+            z1 = b1 * m_vecX.array() - a1 * m_vecY.array() + z2;
+            z2 = b2 * m_vecX.array() - a2 * m_vecY.array();
+            m_vecX.swap(m_vecY);
+        }
+
+        matData.col(n) = m_vecX;
+    }
+}
@@ -0,0 +1,168 @@
+//=============================================================================================================
+/**
+* @file     filtersos.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+* @brief    The FilterSOS class applies a cascade of IIR second-order sections (biquads) to consecutive
+*           multi-channel data blocks in direct form II transposed. The two state values of each section and
+*           channel are kept between blocks, so the filter is causal and adds no latency beyond its own phase
+*           response. The recursion runs sample by sample, but each step processes all channels at once on
+*           contiguous memory, so that the compiler can vectorize across channels.
+*/
+
+#ifndef FILTERSOS_H
+#define FILTERSOS_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//*************************************************************************************************************
+
+class UTILSSHARED_EXPORT FilterSOS
+{
+
+public:
+    typedef QSharedPointer<FilterSOS> SPtr;            /**< Shared pointer type for FilterSOS. */
+    typedef QSharedPointer<const FilterSOS> ConstSPtr; /**< Const shared pointer type for FilterSOS. */
+
+    /**
+    * Constructs an empty FilterSOS object, which passes all data through.
+    */
+    FilterSOS();
+
+    /**
+    * Sets the second-order sections. The state is reset if the sections differ from the current ones.
+    *
+    * @param [in] matSOS the second-order sections, one per row (b0 b1 b2 a0 a1 a2)
+    *
+    * @return true if the sections could be set, false if a section has a0 = 0
+    */
+    bool setSections(const Eigen::MatrixXd& matSOS);
+
+    /**
+    * Clears the filter state, e.g. after a gap in the data.
+    */
+    void reset();
+
+    /**
+    * Filters the next data block in place. The state is reset if the number of channels changed.
+    *
+    * @param [in, out] matData the data block (channels x samples)
+    */
+    void filterData(Eigen::MatrixXd& matData);
+
+    /**
+    * Returns the second-order sections, normalized to a0 = 1.
+    *
+    * @return the sections
+    */
+    inline const Eigen::MatrixXd& getSections() const;
+
+    /**
+    * Returns the filter state (channels x 2*sections), the two state values of section s are the columns 2*s
+    * and 2*s+1.
+    *
+    * @return the state
+    */
+    inline const Eigen::MatrixXd& getState() const;
+
+    /**
+    * Sets the filter state, e.g. to keep the state of channels which stay selected.
+    *
+    * @param [in] matState the state (channels x 2*sections)
+    */
+    inline void setState(const Eigen::MatrixXd& matState);
+
+private:
+    Eigen::MatrixXd     m_matSOS;       /**< The second-order sections, normalized to a0 = 1. */
+    Eigen::MatrixXd     m_matState;     /**< The state of each channel and section (channels x 2*sections). */
+    Eigen::VectorXd     m_vecX;         /**< Input of the current section, one value per channel. */
+    Eigen::VectorXd     m_vecY;         /**< Output of the current section, one value per channel. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const Eigen::MatrixXd& FilterSOS::getSections() const
+{
+    return m_matSOS;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::MatrixXd& FilterSOS::getState() const
+{
+    return m_matState;
+}
+
+
+//*************************************************************************************************************
+
+inline void FilterSOS::setState(const Eigen::MatrixXd& matState)
+{
+    m_matState = matState;
+}
+
+} // NAMESPACE UTILSLIB
+
+#endif // FILTERSOS_H
@@ -0,0 +1,377 @@
+//=============================================================================================================
+/**
+* @file     iirfilter.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+* @brief    Definition of the IIRFilter class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "iirfilter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+/**
+* Splits zeros or poles into complex conjugate pairs, represented by the member with positive imaginary part, and
+* real values.
+*/
+static void iirSplitComplexReal(const std::vector<std::complex<double> >& values,
+                                std::vector<std::complex<double> >& complexValues,
+                                std::vector<std::complex<double> >& realValues)
+{
+    for(size_t i = 0; i < values.size(); ++i) {
+        double tol = 1e-10 * qMax(1.0, std::abs(values[i]));
+
+        if(values[i].imag() > tol) {
+            complexValues.push_back(values[i]);
+        } else if(values[i].imag() >= -tol) {
+            realValues.push_back(std::complex<double>(values[i].real(), 0.0));
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Removes and returns the value in values which is nearest to target.
+*/
+static std::complex<double> iirTakeNearest(std::vector<std::complex<double> >& values, const std::complex<double>& target)
+{
+    size_t iNearest = 0;
+    for(size_t i = 1; i < values.size(); ++i) {
+        if(std::abs(values[i] - target) < std::abs(values[iNearest] - target)) {
+            iNearest = i;
+        }
+    }
+
+    std::complex<double> nearest = values[iNearest];
+    values.erase(values.begin() + iNearest);
+
+    return nearest;
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Returns the distance of the value in values which is nearest to target, or infinity if values is empty.
+*/
+static double iirNearestDistance(const std::vector<std::complex<double> >& values, const std::complex<double>& target)
+{
+    double dDist = std::numeric_limits<double>::infinity();
+    for(size_t i = 0; i < values.size(); ++i) {
+        dDist = qMin(dDist, std::abs(values[i] - target));
+    }
+
+    return dDist;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+IIRFilter::IIRFilter()
+{
+}
+
+
+//*************************************************************************************************************
+
+IIRFilter::IIRFilter(TDesignMethod designMethod, int order, double lowFreq, double highFreq, double ripple, double sFreq, TPassType type)
+{
+    if(order < 1 || sFreq <= 0) {
+        qDebug()<<"Error in IIRFilter: The filter order and the sampling frequency need to be positive!";
+        return;
+    }
+
+    bool bUseLow = type != LPF;
+    bool bUseHigh = type != HPF;
+
+    if((bUseLow && (lowFreq <= 0 || lowFreq >= sFreq/2))
+       || (bUseHigh && (highFreq <= 0 || highFreq >= sFreq/2))
+       || (bUseLow && bUseHigh && lowFreq >= highFreq)) {
+        qDebug()<<"Error in IIRFilter: The cutoff frequencies need to lie between 0 and the Nyquist frequency!";
+        return;
+    }
+
+    //Analog prototype with a cutoff frequency of 1 rad/s
+    std::vector<Complex> zeros;
+    std::vector<Complex> poles;
+    double gain = 1.0;
+
+    switch(designMethod) {
+        case Butterworth:
+            for(int m = -order+1; m < order; m += 2) {
+                poles.push_back(-std::exp(Complex(0.0, M_PI*m/(2.0*order))));
+            }
+            break;
+
+        case Chebyshev: {
+            double eps = std::sqrt(std::pow(10.0, ripple/10.0) - 1.0);
+            double mu = std::asinh(1.0/eps)/order;
+
+            Complex prod = 1.0;
+            for(int k = 0; k < order; ++k) {
+                double theta = M_PI*(2*k+1)/(2.0*order);
+                poles.push_back(Complex(-std::sinh(mu)*std::sin(theta), std::cosh(mu)*std::cos(theta)));
+                prod *= -poles.back();
+            }
+
+            gain = prod.real();
+            if(order%2 == 0) {
+                gain /= std::sqrt(1.0 + eps*eps);
+            }
+            break;
+        }
+    }
+
+    //Prewarp the cutoff frequencies and transform the prototype to the requested filter type
+    double fs2 = 2.0*sFreq;
+    double wLow = bUseLow ? fs2*std::tan(M_PI*lowFreq/sFreq) : 0.0;
+    double wHigh = bUseHigh ? fs2*std::tan(M_PI*highFreq/sFreq) : 0.0;
+    int iDegree = int(poles.size() - zeros.size());
+
+    switch(type) {
+        case LPF:
+            for(size_t i = 0; i < poles.size(); ++i) {
+                poles[i] *= wHigh;
+            }
+            gain *= std::pow(wHigh, iDegree);
+            break;
+
+        case HPF: {
+            Complex prod = 1.0;
+            for(size_t i = 0; i < poles.size(); ++i) {
+                prod *= -poles[i];
+                poles[i] = wLow/poles[i];
+            }
+            zeros.assign(iDegree, Complex(0.0, 0.0));
+            gain *= (1.0/prod).real();
+            break;
+        }
+
+        case BPF: {
+            double bw = wHigh - wLow;
+            double wo = std::sqrt(wLow*wHigh);
+            std::vector<Complex> polesBP;
+
+            for(size_t i = 0; i < poles.size(); ++i) {
+                Complex pLP = poles[i]*bw/2.0;
+                Complex root = std::sqrt(pLP*pLP - wo*wo);
+                polesBP.push_back(pLP + root);
+                polesBP.push_back(pLP - root);
+            }
+
+            poles = polesBP;
+            zeros.assign(iDegree, Complex(0.0, 0.0));
+            gain *= std::pow(bw, iDegree);
+            break;
+        }
+
+        case NOTCH: {
+            double bw = wHigh - wLow;
+            double wo = std::sqrt(wLow*wHigh);
+            std::vector<Complex> polesBS;
+
+            Complex prod = 1.0;
+            for(size_t i = 0; i < poles.size(); ++i) {
+                prod *= -poles[i];
+                Complex pHP = (bw/2.0)/poles[i];
+                Complex root = std::sqrt(pHP*pHP - wo*wo);
+                polesBS.push_back(pHP + root);
+                polesBS.push_back(pHP - root);
+            }
+
+            poles = polesBS;
+            for(int i = 0; i < iDegree; ++i) {
+                zeros.push_back(Complex(0.0, wo));
+                zeros.push_back(Complex(0.0, -wo));
+            }
+            gain *= (1.0/prod).real();
+            break;
+        }
+    }
+
+    //Bilinear transform, the zeros at infinity are mapped to z = -1
+    Complex prodZeros = 1.0;
+    Complex prodPoles = 1.0;
+
+    for(size_t i = 0; i < zeros.size(); ++i) {
+        prodZeros *= fs2 - zeros[i];
+        zeros[i] = (fs2 + zeros[i])/(fs2 - zeros[i]);
+    }
+
+    for(size_t i = 0; i < poles.size(); ++i) {
+        prodPoles *= fs2 - poles[i];
+        poles[i] = (fs2 + poles[i])/(fs2 - poles[i]);
+    }
+
+    zeros.resize(poles.size(), Complex(-1.0, 0.0));
+    gain *= (prodZeros/prodPoles).real();
+
+    zpkToSOS(zeros, poles, gain);
+}
+
+
+//*************************************************************************************************************
+
+RowVectorXd IIRFilter::impulseResponse(const MatrixXd& matSOS, int iLength)
+{
+    RowVectorXd vecResponse = RowVectorXd::Zero(iLength);
+    if(iLength > 0) {
+        vecResponse(0) = 1.0;
+    }
+
+    //Direct form II transposed, one section after another
+    for(int s = 0; s < matSOS.rows(); ++s) {
+        double z1 = 0.0;
+        double z2 = 0.0;
+
+        for(int n = 0; n < iLength; ++n) {
+            double x = vecResponse(n);
+            double y = matSOS(s,0)*x + z1;
+            z1 = matSOS(s,1)*x - matSOS(s,4)*y + z2;
+            z2 = matSOS(s,2)*x - matSOS(s,5)*y;
+            vecResponse(n) = y;
+        }
+    }
+
+    return vecResponse;
+}
+
+
+//*************************************************************************************************************
+
+void IIRFilter::zpkToSOS(std::vector<Complex> zeros, std::vector<Complex> poles, double gain)
+{
+    std::vector<Complex> zerosComplex, zerosReal, polesComplex, polesReal;
+    iirSplitComplexReal(zeros, zerosComplex, zerosReal);
+    iirSplitComplexReal(poles, polesComplex, polesReal);
+
+    //Each complex pole pair forms one section, the real poles are paired with each other
+    std::vector<std::vector<Complex> > sectionPoles;
+
+    for(size_t i = 0; i < polesComplex.size(); ++i) {
+        sectionPoles.push_back(std::vector<Complex>(1, polesComplex[i]));
+        sectionPoles.back().push_back(std::conj(polesComplex[i]));
+    }
+
+    std::sort(polesReal.begin(), polesReal.end(), [](const Complex& a, const Complex& b) {
+        return std::abs(a) < std::abs(b);
+    });
+
+    for(size_t i = 0; i < polesReal.size(); i += 2) {
+        sectionPoles.push_back(std::vector<Complex>(1, polesReal[i]));
+        if(i+1 < polesReal.size()) {
+            sectionPoles.back().push_back(polesReal[i+1]);
+        }
+    }
+
+    //Order the sections from the poles furthest from the unit circle to the ones closest to it
+    std::sort(sectionPoles.begin(), sectionPoles.end(), [](const std::vector<Complex>& a, const std::vector<Complex>& b) {
+        return std::abs(a.front()) < std::abs(b.front());
+    });
+
+    //The sections with the poles closest to the unit circle choose their zeros first
+    int iNumSections = int(sectionPoles.size());
+    m_matSOS = MatrixXd::Zero(iNumSections, 6);
+
+    for(int s = iNumSections-1; s >= 0; --s) {
+        const std::vector<Complex>& p = sectionPoles[s];
+        std::vector<Complex> z;
+
+        double dDistComplex = iirNearestDistance(zerosComplex, p.front());
+        double dDistReal = iirNearestDistance(zerosReal, p.front());
+
+        if(p.size() == 2 && !zerosComplex.empty() && (zerosReal.size() < 2 || dDistComplex <= dDistReal)) {
+            z.push_back(iirTakeNearest(zerosComplex, p.front()));
+            z.push_back(std::conj(z.back()));
+        } else {
+            for(size_t i = 0; i < p.size() && !zerosReal.empty(); ++i) {
+                z.push_back(iirTakeNearest(zerosReal, p.front()));
+            }
+        }
+
+        Complex b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+
+        if(z.size() == 1) {
+            b1 = -z[0];
+        } else if(z.size() == 2) {
+            b1 = -(z[0] + z[1]);
+            b2 = z[0]*z[1];
+        }
+
+        if(p.size() == 1) {
+            a1 = -p[0];
+        } else {
+            a1 = -(p[0] + p[1]);
+            a2 = p[0]*p[1];
+        }
+
+        m_matSOS.row(s) << 1.0, b1.real(), b2.real(), 1.0, a1.real(), a2.real();
+    }
+
+    if(iNumSections > 0) {
+        m_matSOS.row(0).head(3) *= gain;
+    }
+}
@@ -0,0 +1,132 @@
+//=============================================================================================================
+/**
+* @file     iirfilter.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+* @brief    The IIRFilter class designs Butterworth and Chebyshev (type I) IIR filters. The analog prototype is
+*           transformed to the requested filter type, mapped to the z-plane with the bilinear transform [1] and
+*           split into cascaded second-order sections (biquads), which are numerically robust also for higher
+*           filter orders.
+*
+*           [1] http://en.wikipedia.org/wiki/Bilinear_transform
+*/
+
+#ifndef IIRFILTER_H
+#define IIRFILTER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+#include <complex>
+#include <vector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//=============================================================================================================
+/**
+* Designs a Butterworth or Chebyshev IIR filter as cascaded second-order sections.
+*
+* @brief Designs IIR filters as second-order sections.
+*/
+class UTILSSHARED_EXPORT IIRFilter
+{
+public:
+    enum TPassType {LPF, HPF, BPF, NOTCH };
+    enum TDesignMethod {Butterworth, Chebyshev };
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty IIRFilter object.
+    */
+    IIRFilter();
+
+    //=========================================================================================================
+    /**
+    * Constructs an IIRFilter object and designs the filter.
+    *
+    * @param designMethod Butterworth or Chebyshev (type I)
+    * @param order order of the analog prototype, band pass and band stop filters have twice this order
+    * @param lowFreq lower cutoff frequency in Hz, used by HPF, BPF and NOTCH
+    * @param highFreq upper cutoff frequency in Hz, used by LPF, BPF and NOTCH
+    * @param ripple pass band ripple in dB, only used by the Chebyshev design
+    * @param sFreq sampling frequency
+    * @param type filter type (lowpass, highpass, etc.)
+    */
+    IIRFilter(TDesignMethod designMethod, int order, double lowFreq, double highFreq, double ripple, double sFreq, TPassType type);
+
+    //=========================================================================================================
+    /**
+    * Computes the impulse response of the second-order sections.
+    *
+    * @param [in] matSOS the second-order sections, one per row (b0 b1 b2 a0 a1 a2)
+    * @param [in] iLength number of samples
+    *
+    * @return the impulse response
+    */
+    static Eigen::RowVectorXd impulseResponse(const Eigen::MatrixXd& matSOS, int iLength);
+
+    Eigen::MatrixXd     m_matSOS;       /**< The second-order sections, one per row (b0 b1 b2 a0 a1 a2) with a0 = 1. */
+
+private:
+    typedef std::complex<double> Complex;
+
+    //=========================================================================================================
+    /**
+    * Groups the zeros and poles to second-order sections, starting with the poles furthest from the unit circle.
+    *
+    * @param [in] zeros the digital zeros
+    * @param [in] poles the digital poles
+    * @param [in] gain the gain, which is applied to the first section
+    */
+    void zpkToSOS(std::vector<Complex> zeros, std::vector<Complex> poles, double gain);
+};
+
+} // NAMESPACE UTILSLIB
+
+#endif // IIRFILTER_H
@@ -47,6 +47,21 @@
 //=============================================================================================================
 
 #include <QDataStream>
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// SIMD INCLUDES
+//=============================================================================================================
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define IOUTILS_SWAP_SSSE3
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IOUTILS_SWAP_SSE2
+#endif
 
 
 //*************************************************************************************************************
@@ -253,6 +268,99 @@ void IOUtils::swap_doublep(double *source)
 }
 
 
+//*************************************************************************************************************
+
+void IOUtils::swap_short_array(qint16 *source, qint64 n)
+{
+    qint64 k = 0;
+
+#if defined(IOUTILS_SWAP_SSSE3)
+    const __m128i mask = _mm_set_epi8(14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1);
+    for(; k + 8 <= n; k += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(source + k));
+        _mm_storeu_si128((__m128i*)(source + k), _mm_shuffle_epi8(v, mask));
+    }
+#elif defined(IOUTILS_SWAP_SSE2)
+    for(; k + 8 <= n; k += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(source + k));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i*)(source + k), v);
+    }
+#endif
+
+    for(; k < n; ++k)
+        source[k] = qbswap(source[k]);
+}
+
+
+//*************************************************************************************************************
+
+void IOUtils::swap_int_array(qint32 *source, qint64 n)
+{
+    qint64 k = 0;
+
+#if defined(IOUTILS_SWAP_SSSE3)
+    const __m128i mask = _mm_set_epi8(12,13,14,15,8,9,10,11,4,5,6,7,0,1,2,3);
+    for(; k + 4 <= n; k += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(source + k));
+        _mm_storeu_si128((__m128i*)(source + k), _mm_shuffle_epi8(v, mask));
+    }
+#elif defined(IOUTILS_SWAP_SSE2)
+    for(; k + 4 <= n; k += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(source + k));
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2,3,0,1)), _MM_SHUFFLE(2,3,0,1));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i*)(source + k), v);
+    }
+#endif
+
+    for(; k < n; ++k)
+        source[k] = qbswap(source[k]);
+}
+
+
+//*************************************************************************************************************
+
+void IOUtils::swap_long_array(qint64 *source, qint64 n)
+{
+    qint64 k = 0;
+
+#if defined(IOUTILS_SWAP_SSSE3)
+    const __m128i mask = _mm_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7);
+    for(; k + 2 <= n; k += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(source + k));
+        _mm_storeu_si128((__m128i*)(source + k), _mm_shuffle_epi8(v, mask));
+    }
+#elif defined(IOUTILS_SWAP_SSE2)
+    for(; k + 2 <= n; k += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(source + k));
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(0,1,2,3)), _MM_SHUFFLE(0,1,2,3));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i*)(source + k), v);
+    }
+#endif
+
+    for(; k < n; ++k)
+        source[k] = qbswap(source[k]);
+}
+
+
+//*************************************************************************************************************
+
+void IOUtils::swap_float_array(float *source, qint64 n)
+{
+    swap_int_array(reinterpret_cast<qint32*>(source), n);
+}
+
+
+//*************************************************************************************************************
+
+void IOUtils::swap_double_array(double *source, qint64 n)
+{
+    swap_long_array(reinterpret_cast<qint64*>(source), n);
+}
+
+
 //*************************************************************************************************************
 
 QStringList IOUtils::get_new_chnames_conventions(const QStringList& chNames)
@@ -202,6 +202,51 @@ public:
     */
     static void swap_doublep(double *source);
 
+    //=========================================================================================================
+    /**
+    * Swaps the byte order of an array of 16 bit values in place. Uses SIMD byte shuffles where available.
+    *
+    * @param[in, out] source    array to swap
+    * @param[in] n              number of elements
+    */
+    static void swap_short_array(qint16 *source, qint64 n);
+
+    //=========================================================================================================
+    /**
+    * Swaps the byte order of an array of 32 bit integers in place. Uses SIMD byte shuffles where available.
+    *
+    * @param[in, out] source    array to swap
+    * @param[in] n              number of elements
+    */
+    static void swap_int_array(qint32 *source, qint64 n);
+
+    //=========================================================================================================
+    /**
+    * Swaps the byte order of an array of 64 bit integers in place. Uses SIMD byte shuffles where available.
+    *
+    * @param[in, out] source    array to swap
+    * @param[in] n              number of elements
+    */
+    static void swap_long_array(qint64 *source, qint64 n);
+
+    //=========================================================================================================
+    /**
+    * Swaps the byte order of an array of floats in place.
+    *
+    * @param[in, out] source    array to swap
+    * @param[in] n              number of elements
+    */
+    static void swap_float_array(float *source, qint64 n);
+
+    //=========================================================================================================
+    /**
+    * Swaps the byte order of an array of doubles in place.
+    *
+    * @param[in, out] source    array to swap
+    * @param[in] n              number of elements
+    */
+    static void swap_double_array(double *source, qint64 n);
+
     //=========================================================================================================
     /**
     * Write Eigen Matrix to file
@@ -355,24 +355,12 @@ qint32 MNEMath::rank(const MatrixXd& A, double tol)
 
 //*************************************************************************************************************
 
-MatrixXd MNEMath::rescale(const MatrixXd &data, const RowVectorXf &times, QPair<QVariant,QVariant> baseline, QString mode)
+void MNEMath::getBaselineRange(const RowVectorXf &times, QPair<QVariant,QVariant> baseline, qint32 &imin, qint32 &imax)
 {
-    MatrixXd data_out = data;
-    QStringList valid_modes;
-    valid_modes << "logratio" << "ratio" << "zscore" << "mean" << "percent";
-    if(!valid_modes.contains(mode))
-    {
-        qWarning() << "\tWarning: mode should be any of : " << valid_modes;
-        return data_out;
-    }
-    printf("\tApplying baseline correction ... (mode: %s)\n", mode.toUtf8().constData());
+    imin = 0;
+    imax = times.size();
 
-    qint32 imin = 0;
-    qint32 imax = times.size();
-
-    if(!baseline.first.isValid())
-        imin = 0;
-    else
+    if(baseline.first.isValid())
     {
         float bmin = baseline.first.toFloat();
         for(qint32 i = 0; i < times.size(); ++i)
@@ -384,9 +372,7 @@ MatrixXd MNEMath::rescale(const MatrixXd &data, const RowVectorXf &times, QPair<
             }
         }
     }
-    if (!baseline.second.isValid())
-        imax = times.size();
-    else
+    if (baseline.second.isValid())
     {
         float bmax = baseline.second.toFloat();
         for(qint32 i = times.size()-1; i >= 0; --i)
@@ -398,6 +384,25 @@ MatrixXd MNEMath::rescale(const MatrixXd &data, const RowVectorXf &times, QPair<
             }
         }
     }
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd MNEMath::rescale(const MatrixXd &data, const RowVectorXf &times, QPair<QVariant,QVariant> baseline, QString mode)
+{
+    MatrixXd data_out = data;
+    QStringList valid_modes;
+    valid_modes << "logratio" << "ratio" << "zscore" << "mean" << "percent";
+    if(!valid_modes.contains(mode))
+    {
+        qWarning() << "\tWarning: mode should be any of : " << valid_modes;
+        return data_out;
+    }
+    printf("\tApplying baseline correction ... (mode: %s)\n", mode.toUtf8().constData());
+
+    qint32 imin, imax;
+    getBaselineRange(times, baseline, imin, imax);
 
     VectorXd mean = data_out.block(0, imin,data_out.rows(),imax-imin).rowwise().mean();
     if(mode.compare("mean") == 0)
@@ -234,6 +234,18 @@ public:
     */
     static qint32 rank(const Eigen::MatrixXd& A, double tol = 1e-8);
 
+    //=========================================================================================================
+    /**
+    * Returns the sample range [imin, imax) of a baseline interval, as used by rescale.
+    *
+    * @param[in] times          Time instants is seconds.
+    * @param[in] baseline       If baseline is (a, b) the interval is between "a (s)" and "b (s)".
+    *                           If a is invalid the beginning of the data is used and if b is invalid then b is set to the end of the interval.
+    * @param[out] imin          First sample of the baseline.
+    * @param[out] imax          One past the last sample of the baseline.
+    */
+    static void getBaselineRange(const Eigen::RowVectorXf &times, QPair<QVariant,QVariant> baseline, qint32 &imin, qint32 &imax);
+
     //=========================================================================================================
     /**
     * ToDo: Maybe new processing class
@@ -73,6 +73,9 @@ SOURCES += \
     filterTools/cosinefilter.cpp \
     filterTools/parksmcclellan.cpp \
     filterTools/filterdata.cpp \
+    filterTools/filteroverlapadd.cpp \
+    filterTools/iirfilter.cpp \
+    filterTools/filtersos.cpp \
     filterTools/filterio.cpp \
     detecttrigger.cpp \
     spectrogram.cpp \
@@ -100,6 +103,9 @@ HEADERS += \
     filterTools/cosinefilter.h \
     filterTools/parksmcclellan.h \
     filterTools/filterdata.h \
+    filterTools/filteroverlapadd.h \
+    filterTools/iirfilter.h \
+    filterTools/filtersos.h \
     filterTools/filterio.h \
     detecttrigger.h \
     spectrogram.h \
@@ -77,6 +77,7 @@ private slots:
     void initTestCase();
     void dipoleFitSimple();
     void dipoleFitAdvanced();
+    void dipoleFitWarmStart();
     void cleanupTestCase();
 
 private:
@@ -273,6 +274,90 @@ void TestDipoleFit::dipoleFitAdvanced()
 }
 
 
+//*************************************************************************************************************
+
+void TestDipoleFit::dipoleFitWarmStart()
+{
+    QFile testFile;
+
+    //*********************************************************************************************************
+    // Dipole Fit Settings
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Dipole Fit Settings >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    //Same as dipoleFitSimple, without writing the result
+    DipoleFitSettings settings;
+    testFile.setFileName(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif"); QVERIFY( testFile.exists() );
+    settings.measname = testFile.fileName();
+    settings.is_raw = false;
+    settings.setno = 1;
+    settings.include_meg = true;
+    settings.include_eeg = true;
+    settings.tmin = 32.0f/1000.0f;
+    settings.tmax = 148.0f/1000.0f;
+    settings.bmin = -100.0f/1000.0f;
+    settings.bmax = 0.0f/1000.0f;
+
+    settings.checkIntegrity();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Dipole Fit Settings Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+
+    //*********************************************************************************************************
+    // Compute Dipole Fits
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compute Dipole Fits >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    settings.warm_start = false;
+    DipoleFit dipFitGuess(&settings);
+    ECDSet setGuess = dipFitGuess.calculateFit();
+
+    settings.warm_start = true;
+    DipoleFit dipFitWarm(&settings);
+    ECDSet setWarm = dipFitWarm.calculateFit();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compute Dipole Fits Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+
+    //*********************************************************************************************************
+    // Compare Fits
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compare Dipole Fits >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    QVERIFY( setGuess.size() > 0 );
+    QVERIFY( setWarm.size() == setGuess.size() );
+
+    //The warm start converges to the same dipoles as the guess grid where the fit is good. Elsewhere it may end in
+    //a different local minimum, which must not explain the data notably worse.
+    for (int i = 0; i < setGuess.size(); ++i)
+    {
+        printf("Compare guess Dipole %d: %7.1f %8.2f %8.2f %8.2f %8.3f %6.1f\n", i,
+                1000*setGuess[i].time,
+                1000*setGuess[i].rd[0],1000*setGuess[i].rd[1],1000*setGuess[i].rd[2],
+                1e9*setGuess[i].Q.norm(),100.0*setGuess[i].good);
+        printf("         warm Dipole %d: %7.1f %8.2f %8.2f %8.2f %8.3f %6.1f\n", i,
+                1000*setWarm[i].time,
+                1000*setWarm[i].rd[0],1000*setWarm[i].rd[1],1000*setWarm[i].rd[2],
+                1e9*setWarm[i].Q.norm(),100.0*setWarm[i].good);
+
+        QVERIFY( setWarm[i].valid == setGuess[i].valid );
+        QVERIFY( std::fabs(setWarm[i].time - setGuess[i].time) < epsilon );
+        QVERIFY( setWarm[i].good > setGuess[i].good - 0.01f );
+
+        if(setGuess[i].good > 0.8f)
+        {
+            QVERIFY( (setWarm[i].rd - setGuess[i].rd).norm() < 0.002f );
+            QVERIFY( (setWarm[i].Q - setGuess[i].Q).norm() < 0.05f * setGuess[i].Q.norm() );
+        }
+    }
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compare Dipole Fits Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
 //*************************************************************************************************************
 
 void TestDipoleFit::compareFit()
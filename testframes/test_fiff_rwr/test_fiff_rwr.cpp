@@ -40,6 +40,7 @@
 //=============================================================================================================
 
 #include <fiff/fiff.h>
+#include <fiff/fiff_split_raw_data.h>
 
 #include <iostream>
 
@@ -78,9 +79,18 @@ private slots:
     void compareData();
     void compareTimes();
     void compareInfo();
+    void compareShortData();
+    void compareClippedData();
+    void compareCompressedData();
+    void compareSplitData();
+    void compareMappedData();
+    void compareDirCache();
+    void compareAddDir();
     void cleanupTestCase();
 
 private:
+    bool writeDirectorylessFile(QFile& file, fiff_int_t nTags);
+
     double epsilon;
 
     FiffRawData first_in_raw;
@@ -319,6 +329,411 @@ void TestFiffRWR::compareInfo()
     }
 }
 
+//*************************************************************************************************************
+
+void TestFiffRWR::compareShortData()
+{
+    QFile t_fileOut("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_rwr_short_out.fif");
+
+    //
+    //   Write the first buffer as 16 bit integers
+    //
+    RowVectorXd cals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(t_fileOut, first_in_raw.info, cals, defaultMatrixXi, false, FIFFT_SHORT);
+    QVERIFY( outfid );
+
+    fiff_int_t first = first_in_raw.first_samp;
+    if (first > 0)
+        outfid->write_int(FIFF_FIRST_SAMPLE,&first);
+    outfid->write_raw_buffer(first_in_data,cals);
+    outfid->finish_writing_raw();
+
+    //
+    //   Read it back, every sample has to be within half a calibration step
+    //
+    FiffRawData short_in_raw(t_fileOut);
+    MatrixXd short_in_data, short_in_times;
+    QVERIFY( short_in_raw.read_raw_segment(short_in_data, short_in_times, first, first + first_in_data.cols() - 1) );
+    QVERIFY( short_in_data.rows() == first_in_data.rows() && short_in_data.cols() == first_in_data.cols() );
+
+    for( qint32 i = 0; i < first_in_data.rows(); ++i )
+    {
+        double maxDiff = (short_in_data.row(i) - first_in_data.row(i)).cwiseAbs().maxCoeff();
+        QVERIFY( maxDiff <= 0.5*cals[i] + epsilon );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareClippedData()
+{
+    QFile t_fileOut("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_rwr_clipped_out.fif");
+
+    //
+    //   Two channels ramp up to +-100 calibration steps per sample and leave the 16 bit range after 328 samples
+    //
+    RowVectorXd cals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(t_fileOut, first_in_raw.info, cals, defaultMatrixXi, false, FIFFT_SHORT);
+    QVERIFY( outfid );
+
+    MatrixXd out_data = first_in_data;
+    qint32 nsamp = out_data.cols();
+    QVERIFY( nsamp > 328 );
+    for( qint32 j = 0; j < nsamp; ++j )
+    {
+        out_data(0, j) = 100.0*j*cals[0];
+        out_data(1, j) = -100.0*j*cals[1];
+    }
+
+    fiff_int_t first = first_in_raw.first_samp;
+    if (first > 0)
+        outfid->write_int(FIFF_FIRST_SAMPLE,&first);
+
+    qint64 numel = (qint64)out_data.rows()*nsamp;
+    QTest::ignoreMessage(QtWarningMsg, QString("FiffStream::write_raw_data - %1 of %2 samples exceed the range of the storage type and were clipped.").arg(2*(nsamp - 328)).arg(numel).toUtf8().constData());
+    QVERIFY( outfid->write_raw_buffer(out_data,cals) );
+    outfid->finish_writing_raw();
+
+    //
+    //   The ramps saturate at the limits of the type, all other samples are within half a calibration step
+    //
+    FiffRawData clipped_in_raw(t_fileOut);
+    MatrixXd clipped_in_data, clipped_in_times;
+    QVERIFY( clipped_in_raw.read_raw_segment(clipped_in_data, clipped_in_times, first, first + nsamp - 1) );
+    QVERIFY( clipped_in_data.rows() == out_data.rows() && clipped_in_data.cols() == nsamp );
+
+    for( qint32 j = 0; j < nsamp; ++j )
+    {
+        QVERIFY( std::fabs(clipped_in_data(0, j) - qMin(100.0*j, 32767.0)*cals[0]) <= 0.5*std::fabs(cals[0]) );
+        QVERIFY( std::fabs(clipped_in_data(1, j) + qMin(100.0*j, 32768.0)*cals[1]) <= 0.5*std::fabs(cals[1]) );
+    }
+
+    for( qint32 i = 2; i < out_data.rows(); ++i )
+    {
+        double maxDiff = (clipped_in_data.row(i) - out_data.row(i)).cwiseAbs().maxCoeff();
+        QVERIFY( maxDiff <= 0.5*cals[i] + epsilon );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareCompressedData()
+{
+    QFile t_filePlain("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_rwr_plain_out.fif");
+    QFile t_fileCompressed("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_rwr_compressed_out.fif");
+
+    //
+    //   Write the first buffer uncompressed and compressed
+    //
+    fiff_int_t first = first_in_raw.first_samp;
+    for(qint32 k = 0; k < 2; ++k)
+    {
+        RowVectorXd cals;
+        FiffStream::SPtr outfid = FiffStream::start_writing_raw(k == 0 ? t_filePlain : t_fileCompressed, first_in_raw.info, cals, defaultMatrixXi, false, FIFFT_FLOAT, k == 1);
+        QVERIFY( outfid );
+
+        if (first > 0)
+            outfid->write_int(FIFF_FIRST_SAMPLE,&first);
+        outfid->write_raw_buffer(first_in_data,cals);
+        outfid->finish_writing_raw();
+    }
+
+    //
+    //   The compression is lossless, both have to read back the same samples
+    //
+    FiffRawData plain_in_raw(t_filePlain);
+    FiffRawData compressed_in_raw(t_fileCompressed);
+    MatrixXd plain_in_data, compressed_in_data, in_times;
+    QVERIFY( plain_in_raw.read_raw_segment(plain_in_data, in_times, first, first + first_in_data.cols() - 1) );
+    QVERIFY( compressed_in_raw.read_raw_segment(compressed_in_data, in_times, first, first + first_in_data.cols() - 1) );
+
+    QVERIFY( compressed_in_data == plain_in_data );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareSplitData()
+{
+    QFile t_fileUnsplit("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_rwr_unsplit_out.fif");
+    QFile t_fileSplit1("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_rwr_split_out.fif");
+    QFile t_fileSplit2("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_rwr_split_out-1.fif");
+
+    //
+    //   Two seconds of data, split after an odd number of samples
+    //
+    fiff_int_t first = first_in_raw.first_samp;
+    fiff_int_t nsamp = 2*ceil(first_in_raw.info.sfreq);
+    fiff_int_t split = nsamp/2 + 37;
+
+    MatrixXd in_data, in_times;
+    QVERIFY( first_in_raw.read_raw_segment(in_data, in_times, first, first + nsamp - 1) );
+
+    RowVectorXd cals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(t_fileUnsplit, first_in_raw.info, cals);
+    QVERIFY( outfid );
+    if (first > 0)
+        outfid->write_int(FIFF_FIRST_SAMPLE,&first);
+    outfid->write_raw_buffer(in_data,cals);
+    outfid->finish_writing_raw();
+
+    //
+    //   The first part refers to the second one by its bare file name, as split files are written
+    //
+    outfid = FiffStream::start_writing_raw(t_fileSplit1, first_in_raw.info, cals);
+    QVERIFY( outfid );
+    if (first > 0)
+        outfid->write_int(FIFF_FIRST_SAMPLE,&first);
+    outfid->write_raw_buffer(in_data.leftCols(split),cals);
+    outfid->end_block(FIFFB_RAW_DATA);
+
+    fiff_int_t role = FIFFV_ROLE_NEXT_FILE;
+    outfid->start_block(FIFFB_REF);
+    outfid->write_int(FIFF_REF_ROLE,&role);
+    outfid->write_string(FIFF_REF_FILE_NAME, QFileInfo(t_fileSplit2).fileName());
+    outfid->end_block(FIFFB_REF);
+
+    outfid->end_block(FIFFB_MEAS);
+    outfid->end_file();
+    outfid->close();
+
+    fiff_int_t second = first + split;
+    outfid = FiffStream::start_writing_raw(t_fileSplit2, first_in_raw.info, cals);
+    QVERIFY( outfid );
+    outfid->write_int(FIFF_FIRST_SAMPLE,&second);
+    outfid->write_raw_buffer(in_data.rightCols(nsamp - split),cals);
+    outfid->finish_writing_raw();
+
+    //
+    //   The parts are chained and presented as one sample range
+    //
+    FiffSplitRawData split_in_raw(t_fileSplit1.fileName());
+    QVERIFY( split_in_raw.parts.size() == 2 );
+    QVERIFY( split_in_raw.first_samp == first );
+    QVERIFY( split_in_raw.last_samp == first + nsamp - 1 );
+    QVERIFY( split_in_raw.find_part(second - 1) == 0 );
+    QVERIFY( split_in_raw.find_part(second) == 1 );
+    QVERIFY( split_in_raw.find_part(first + nsamp) == -1 );
+
+    //
+    //   A segment spanning the boundary reads the same samples as the unsplit file
+    //
+    FiffRawData unsplit_in_raw(t_fileUnsplit);
+    MatrixXd unsplit_data, unsplit_times, split_data, split_times;
+    QVERIFY( unsplit_in_raw.read_raw_segment(unsplit_data, unsplit_times, second - 100, second + 99) );
+    QVERIFY( split_in_raw.read_raw_segment(split_data, split_times, second - 100, second + 99) );
+
+    QVERIFY( split_data.rows() == unsplit_data.rows() && split_data.cols() == 200 );
+    QVERIFY( split_data == unsplit_data );
+    QVERIFY( (split_times - unsplit_times).cwiseAbs().maxCoeff() < epsilon );
+
+    //
+    //   A segment within one part, with a channel selection
+    //
+    RowVectorXi sel(3);
+    sel << 0, 5, 17;
+    QVERIFY( unsplit_in_raw.read_raw_segment(unsplit_data, unsplit_times, second + 10, second + 60, sel) );
+    QVERIFY( split_in_raw.read_raw_segment(split_data, split_times, second + 10, second + 60, sel) );
+    QVERIFY( split_data == unsplit_data );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareMappedData()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    FiffRawData raw(t_fileIn);
+    QVERIFY( !raw.isEmpty() );
+
+    //
+    //   Read the same segments through read_tag and straight from the memory mapped file
+    //
+    fiff_int_t from = raw.first_samp + 100;
+    fiff_int_t to = from + 3*ceil(raw.info.sfreq);
+    RowVectorXi sel(4);
+    sel << 0, 3, 100, raw.info.nchan - 1;
+
+    MatrixXd data, times, sel_data, sel_times;
+    QVERIFY( raw.read_raw_segment(data, times, from, to) );
+    QVERIFY( raw.read_raw_segment(sel_data, sel_times, from, to, sel) );
+
+    QVERIFY( raw.file->map_file() );
+    QVERIFY( raw.file->is_mapped() );
+
+    MatrixXd mapped_data, mapped_times, mapped_sel_data, mapped_sel_times;
+    QVERIFY( raw.read_raw_segment(mapped_data, mapped_times, from, to) );
+    QVERIFY( raw.read_raw_segment(mapped_sel_data, mapped_sel_times, from, to, sel) );
+
+    raw.file->unmap_file();
+
+    QVERIFY( mapped_data.rows() == data.rows() && mapped_data.cols() == data.cols() );
+    QVERIFY( (mapped_data - data).cwiseAbs().maxCoeff() <= epsilon * data.cwiseAbs().maxCoeff() );
+    QVERIFY( (mapped_sel_data - sel_data).cwiseAbs().maxCoeff() <= epsilon * sel_data.cwiseAbs().maxCoeff() );
+    QVERIFY( mapped_times == times );
+
+    //
+    //   A buffer payload which is too short for the requested samples is rejected
+    //
+    QByteArray payload(4 * 10 * 2, 0);
+    MatrixXd dest(4, 10);
+    QVERIFY( FiffRawData::decode_raw_buffer((const uchar*)payload.constData(), payload.size(), FIFFT_SHORT, 4, 0, 10, defaultRowVectorXi, NULL, dest, 0) );
+    QVERIFY( !FiffRawData::decode_raw_buffer((const uchar*)payload.constData(), payload.size() - 1, FIFFT_SHORT, 4, 0, 10, defaultRowVectorXi, NULL, dest, 0) );
+    QVERIFY( !FiffRawData::decode_raw_buffer((const uchar*)payload.constData(), payload.size(), FIFFT_FLOAT, 4, 0, 10, defaultRowVectorXi, NULL, dest, 0) );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareDirCache()
+{
+    QFile t_file("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_rwr_dircache_out.fif");
+    QString t_sCacheName = t_file.fileName() + ".dir";
+    QFile::remove(t_sCacheName);
+    QVERIFY( writeDirectorylessFile(t_file, 5) );
+
+    //
+    //   Scanning the tags writes the sidecar
+    //
+    FiffStream t_streamScan(&t_file);
+    t_streamScan.set_dir_cache_enabled(true);
+    QVERIFY( t_streamScan.open() );
+    QList<FiffDirEntry::SPtr> t_dirScan = t_streamScan.dir();
+    t_streamScan.close();
+    QVERIFY( QFile::exists(t_sCacheName) );
+
+    //
+    //   Tag the size of the FIFF_FREE_LIST entry in the sidecar, so that a directory read from the sidecar can be
+    //   told apart from a scanned one. The entries start after the magic, the version, the file size, the
+    //   modification time and the file id.
+    //
+    const qint64 iEntryOffset = 4 + 4 + 8 + 8 + 5*4 + 4;
+    const fiff_int_t iTaggedSize = 4711;
+    QFile t_cacheFile(t_sCacheName);
+    QVERIFY( t_cacheFile.open(QIODevice::ReadWrite) );
+    QVERIFY( t_cacheFile.seek(iEntryOffset + 2*FiffDirEntry::storageSize() + 8) );
+    QDataStream t_cache(&t_cacheFile);
+    t_cache.setByteOrder(QDataStream::BigEndian);
+    t_cache << iTaggedSize;
+    t_cacheFile.close();
+
+    FiffStream t_streamCached(&t_file);
+    t_streamCached.set_dir_cache_enabled(true);
+    QVERIFY( t_streamCached.open() );
+    QList<FiffDirEntry::SPtr> t_dirCached = t_streamCached.dir();
+    t_streamCached.close();
+
+    QVERIFY( t_dirCached.size() == t_dirScan.size() );
+    QVERIFY( t_dirCached[2]->kind == FIFF_FREE_LIST && t_dirCached[2]->size == iTaggedSize );
+    for(qint32 k = 0; k < t_dirScan.size(); ++k) {
+        QVERIFY( t_dirCached[k]->kind == t_dirScan[k]->kind );
+        QVERIFY( t_dirCached[k]->type == t_dirScan[k]->type );
+        QVERIFY( t_dirCached[k]->pos == t_dirScan[k]->pos );
+        QVERIFY( k == 2 || t_dirCached[k]->size == t_dirScan[k]->size );
+    }
+
+    //
+    //   A rewritten file invalidates the sidecar, the tags are scanned again and the sidecar is replaced
+    //
+    QVERIFY( writeDirectorylessFile(t_file, 8) );
+
+    FiffStream t_streamStale(&t_file);
+    t_streamStale.set_dir_cache_enabled(true);
+    QVERIFY( t_streamStale.open() );
+    QList<FiffDirEntry::SPtr> t_dirStale = t_streamStale.dir();
+    t_streamStale.close();
+
+    FiffStream t_streamNew(&t_file);
+    QVERIFY( t_streamNew.open() );
+    QList<FiffDirEntry::SPtr> t_dirNew = t_streamNew.dir();
+    t_streamNew.close();
+
+    QVERIFY( t_dirStale.size() == t_dirScan.size() + 3 );
+    QVERIFY( t_dirStale.size() == t_dirNew.size() );
+    for(qint32 k = 0; k < t_dirNew.size(); ++k) {
+        QVERIFY( t_dirStale[k]->kind == t_dirNew[k]->kind );
+        QVERIFY( t_dirStale[k]->size == t_dirNew[k]->size );
+        QVERIFY( t_dirStale[k]->pos == t_dirNew[k]->pos );
+    }
+
+    FiffStream t_streamRecached(&t_file);
+    t_streamRecached.set_dir_cache_enabled(true);
+    QVERIFY( t_streamRecached.open() );
+    QVERIFY( t_streamRecached.dir().size() == t_dirNew.size() );
+    QVERIFY( t_streamRecached.dir()[2]->size != iTaggedSize );
+    t_streamRecached.close();
+
+    QFile::remove(t_sCacheName);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareAddDir()
+{
+    QFile t_file("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_rwr_adddir_out.fif");
+    QVERIFY( writeDirectorylessFile(t_file, 5) );
+
+    FiffStream t_streamScan(&t_file);
+    QVERIFY( t_streamScan.open() );
+    QList<FiffDirEntry::SPtr> t_dirScan = t_streamScan.dir();
+    t_streamScan.close();
+    qint64 iFileSize = t_file.size();
+
+    //
+    //   Append a tag whose data was never written, as left behind by an interrupted recording
+    //
+    QVERIFY( t_file.open(QIODevice::Append) );
+    QDataStream t_garbage(&t_file);
+    t_garbage.setByteOrder(QDataStream::BigEndian);
+    t_garbage << (qint32)FIFF_DATA_BUFFER << (qint32)FIFFT_FLOAT << (qint32)400 << (qint32)FIFFV_NEXT_SEQ << (qint32)0;
+    t_file.close();
+
+    //
+    //   This is what mne_add_fiff_dir does
+    //
+    FiffStream t_streamAdd(&t_file);
+    QVERIFY( t_streamAdd.open(QIODevice::ReadWrite) );
+    QVERIFY( t_streamAdd.add_dir() );
+    t_streamAdd.close();
+
+    //
+    //   The incomplete tag is gone and the directory follows the last complete tag
+    //
+    FiffStream t_streamDir(&t_file);
+    QVERIFY( t_streamDir.open() );
+    QList<FiffDirEntry::SPtr> t_dirRead = t_streamDir.dir();
+
+    FiffTag::SPtr t_pTag;
+    QVERIFY( t_streamDir.read_tag(t_pTag, t_dirScan[1]->pos) );
+    QVERIFY( t_pTag->kind == FIFF_DIR_POINTER && *t_pTag->toInt() == iFileSize );
+
+    QVERIFY( t_dirRead.size() == t_dirScan.size() );
+    for(qint32 k = 0; k < t_dirScan.size(); ++k) {
+        QVERIFY( t_dirRead[k]->kind == t_dirScan[k]->kind );
+        QVERIFY( t_dirRead[k]->type == t_dirScan[k]->type );
+        QVERIFY( t_dirRead[k]->size == t_dirScan[k]->size );
+        QVERIFY( t_dirRead[k]->pos == t_dirScan[k]->pos );
+    }
+
+    QVERIFY( t_streamDir.dirtree()->nchild() == 1 );
+    QVERIFY( t_streamDir.dirtree()->children[0]->type == FIFFB_MEAS );
+    t_streamDir.close();
+
+    //
+    //   A file which already has a directory is left untouched
+    //
+    qint64 iDirFileSize = t_file.size();
+    FiffStream t_streamAgain(&t_file);
+    QVERIFY( t_streamAgain.open(QIODevice::ReadWrite) );
+    QVERIFY( t_streamAgain.add_dir() );
+    t_streamAgain.close();
+    QVERIFY( t_file.size() == iDirFileSize );
+}
+
+
 //*************************************************************************************************************
 
 void TestFiffRWR::cleanupTestCase()
@@ -326,6 +741,27 @@ void TestFiffRWR::cleanupTestCase()
 }
 
 
+//*************************************************************************************************************
+
+bool TestFiffRWR::writeDirectorylessFile(QFile& file, fiff_int_t nTags)
+{
+    FiffStream::SPtr t_pStream = FiffStream::start_file(file);
+    if(!t_pStream)
+        return false;
+
+    t_pStream->start_block(FIFFB_MEAS);
+    for(fiff_int_t k = 0; k < nTags; ++k) {
+        fiff_int_t value = k + 1;
+        t_pStream->write_int(FIFF_NCHAN, &value);
+    }
+    t_pStream->end_block(FIFFB_MEAS);
+    t_pStream->end_file();
+    t_pStream->close();
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // MAIN
@@ -0,0 +1,282 @@
+//=============================================================================================================
+/**
+* @file     test_filtering.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Tests for the IIR and FFT filter tools
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/filterTools/iirfilter.h>
+#include <utils/filterTools/filtersos.h>
+#include <utils/filterTools/filterdata.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiltering
+*
+* @brief The TestFiltering class provides tests of the filter design and the block-wise filtering
+*
+*/
+class TestFiltering: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiltering();
+
+private slots:
+    void initTestCase();
+    void compareButterworthSOS();
+    void compareSOSBlocks();
+    void compareSOSImpulseResponse();
+    void compareMinimumPhaseMagnitude();
+    void compareMinimumPhaseFrontLoaded();
+    void compareMinimumPhaseMirrorData();
+    void cleanupTestCase();
+
+private:
+    double epsilon;
+};
+
+
+//*************************************************************************************************************
+
+TestFiltering::TestFiltering()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::compareButterworthSOS()
+{
+    //4th order Butterworth lowpass at 0.2 times the Nyquist frequency, as butter(4, 0.2) in Matlab and SciPy. The
+    //sections multiply to b = [0.0048243 0.0192974 0.0289461 0.0192974 0.0048243] and
+    //a = [1 -2.3695130 2.3139884 -1.0546654 0.1873795].
+    IIRFilter filter(IIRFilter::Butterworth, 4, 0.0, 100.0, 0.0, 1000.0, IIRFilter::LPF);
+
+    MatrixXd matSOSRef(2, 6);
+    matSOSRef << 0.0048243434, 0.0096486867, 0.0048243434, 1.0, -1.0485995764, 0.2961403576,
+                 1.0, 2.0, 1.0, 1.0, -1.3209134308, 0.6327387929;
+
+    QCOMPARE((int)filter.m_matSOS.rows(), 2);
+    QCOMPARE((int)filter.m_matSOS.cols(), 6);
+    QVERIFY((filter.m_matSOS - matSOSRef).cwiseAbs().maxCoeff() < epsilon);
+
+    //Unit gain at DC
+    QVERIFY(std::abs(IIRFilter::impulseResponse(filter.m_matSOS, 2000).sum() - 1.0) < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::compareSOSBlocks()
+{
+    //The state is carried over, so filtering in consecutive blocks equals filtering all data at once
+    IIRFilter filter(IIRFilter::Butterworth, 4, 1.0, 40.0, 0.0, 1000.0, IIRFilter::BPF);
+    MatrixXd matData = MatrixXd::Random(5, 1000);
+
+    FilterSOS filterOne;
+    QVERIFY(filterOne.setSections(filter.m_matSOS));
+    MatrixXd matOne = matData;
+    filterOne.filterData(matOne);
+
+    FilterSOS filterBlocks;
+    QVERIFY(filterBlocks.setSections(filter.m_matSOS));
+    MatrixXd matFirst = matData.leftCols(337);
+    MatrixXd matSecond = matData.rightCols(663);
+    filterBlocks.filterData(matFirst);
+    filterBlocks.filterData(matSecond);
+
+    QVERIFY((matOne.leftCols(337) - matFirst).cwiseAbs().maxCoeff() < epsilon);
+    QVERIFY((matOne.rightCols(663) - matSecond).cwiseAbs().maxCoeff() < epsilon);
+
+    //Setting the same sections again keeps the state, a reset clears it
+    QVERIFY(filterBlocks.setSections(filter.m_matSOS));
+    QVERIFY(filterBlocks.getState().cwiseAbs().maxCoeff() > 0.0);
+    filterBlocks.reset();
+    QCOMPARE((int)filterBlocks.getState().size(), 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::compareSOSImpulseResponse()
+{
+    IIRFilter filter(IIRFilter::Chebyshev, 3, 20.0, 0.0, 0.5, 1000.0, IIRFilter::HPF);
+
+    MatrixXd matImpulse = MatrixXd::Zero(2, 300);
+    matImpulse.col(0).setOnes();
+
+    FilterSOS filterSOS;
+    QVERIFY(filterSOS.setSections(filter.m_matSOS));
+    filterSOS.filterData(matImpulse);
+
+    RowVectorXd vecResponse = IIRFilter::impulseResponse(filter.m_matSOS, 300);
+
+    QVERIFY((matImpulse.row(0) - vecResponse).cwiseAbs().maxCoeff() < epsilon);
+    QVERIFY((matImpulse.row(1) - vecResponse).cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::compareMinimumPhaseMagnitude()
+{
+    FilterData filterLinear("LP", FilterData::LPF, 128, 0.1, 0.0, 0.05, 1000.0, 4096, FilterData::Cosine, false);
+    FilterData filterMinimum("LP", FilterData::LPF, 128, 0.1, 0.0, 0.05, 1000.0, 4096, FilterData::Cosine, true);
+
+    QCOMPARE((int)filterMinimum.m_dCoeffA.cols(), (int)filterLinear.m_dCoeffA.cols());
+    QCOMPARE((int)filterMinimum.m_dFFTCoeffA.cols(), (int)filterLinear.m_dFFTCoeffA.cols());
+
+    //The cepstral conversion keeps the magnitude response and hence the energy of the taps
+    RowVectorXd vecMagLinear = filterLinear.m_dFFTCoeffA.cwiseAbs();
+    RowVectorXd vecMagMinimum = filterMinimum.m_dFFTCoeffA.cwiseAbs();
+
+    QVERIFY((vecMagLinear - vecMagMinimum).cwiseAbs().maxCoeff() < 0.005 * vecMagLinear.maxCoeff());
+    QVERIFY(std::abs(filterMinimum.m_dCoeffA.squaredNorm() - filterLinear.m_dCoeffA.squaredNorm()) < 0.001 * filterLinear.m_dCoeffA.squaredNorm());
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::compareMinimumPhaseFrontLoaded()
+{
+    FilterData filterLinear("LP", FilterData::LPF, 128, 0.1, 0.0, 0.05, 1000.0, 4096, FilterData::Cosine, false);
+    FilterData filterMinimum("LP", FilterData::LPF, 128, 0.1, 0.0, 0.05, 1000.0, 4096, FilterData::Cosine, true);
+
+    QCOMPARE(filterLinear.getDelay(), 64);
+    QCOMPARE(filterMinimum.getDelay(), 0);
+
+    //Of all filters with the same magnitude response the minimum-phase one has the largest partial energy at every tap
+    double dEnergy = filterLinear.m_dCoeffA.squaredNorm();
+    double dPartialLinear = 0.0;
+    double dPartialMinimum = 0.0;
+
+    for(int i = 0; i < filterLinear.m_dCoeffA.cols(); ++i) {
+        dPartialLinear += filterLinear.m_dCoeffA(i) * filterLinear.m_dCoeffA(i);
+        dPartialMinimum += filterMinimum.m_dCoeffA(i) * filterMinimum.m_dCoeffA(i);
+        QVERIFY(dPartialMinimum > dPartialLinear - 0.001 * dEnergy);
+    }
+
+    //The linear-phase response is centered, the minimum-phase response is nearly over after the first half
+    QVERIFY(filterLinear.m_dCoeffA.head(64).squaredNorm() < 0.5 * dEnergy);
+    QVERIFY(filterMinimum.m_dCoeffA.head(64).squaredNorm() > 0.99 * dEnergy);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::compareMinimumPhaseMirrorData()
+{
+    FilterData filterLinear("LP", FilterData::LPF, 128, 0.1, 0.0, 0.05, 1000.0, 4096, FilterData::Cosine, false);
+    FilterData filterMinimum("LP", FilterData::LPF, 128, 0.1, 0.0, 0.05, 1000.0, 4096, FilterData::Cosine, true);
+
+    int iTaps = filterMinimum.m_dCoeffA.cols();
+    RowVectorXd vecData = RowVectorXd::Random(1000);
+
+    //Reference: causal convolution, and the convolution centered on each sample for the linear-phase filter
+    RowVectorXd vecCausal = RowVectorXd::Zero(vecData.cols());
+    RowVectorXd vecCentered = RowVectorXd::Zero(vecData.cols());
+
+    for(int n = 0; n < vecData.cols(); ++n) {
+        for(int j = 0; j < iTaps; ++j) {
+            if(n - j >= 0) {
+                vecCausal(n) += filterMinimum.m_dCoeffA(j) * vecData(n - j);
+            }
+
+            if(n + iTaps/2 - j >= 0 && n + iTaps/2 - j < vecData.cols()) {
+                vecCentered(n) += filterLinear.m_dCoeffA(j) * vecData(n + iTaps/2 - j);
+            }
+        }
+    }
+
+    //With zero delay the output starts with the first data sample, not with the mirrored lead-in
+    RowVectorXd vecMinimum = filterMinimum.applyFFTFilter(vecData, false, FilterData::MirrorData);
+    QCOMPARE((int)vecMinimum.cols(), (int)vecData.cols());
+    QVERIFY((vecMinimum.tail(vecData.cols() - iTaps) - vecCausal.tail(vecData.cols() - iTaps)).cwiseAbs().maxCoeff() < epsilon);
+
+    RowVectorXd vecZeroPad = filterMinimum.applyFFTFilter(vecData, false, FilterData::ZeroPad);
+    QVERIFY((vecZeroPad - vecCausal).cwiseAbs().maxCoeff() < epsilon);
+
+    //The linear-phase filter is aligned with the data as well
+    RowVectorXd vecLinear = filterLinear.applyFFTFilter(vecData, false, FilterData::MirrorData);
+    QCOMPARE((int)vecLinear.cols(), (int)vecData.cols());
+    QVERIFY((vecLinear.segment(iTaps, vecData.cols() - 2*iTaps) - vecCentered.segment(iTaps, vecData.cols() - 2*iTaps)).cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiltering)
+#include "test_filtering.moc"
@@ -0,0 +1,438 @@
+//=============================================================================================================
+/**
+* @file     test_hpifit.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the Levenberg-Marquardt and the simplex HPI coil fit on synthetic data
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <inverse/hpiFit/hpifitdata.h>
+#include <inverse/hpiFit/hpifit.h>
+
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_dig_point_set.h>
+#include <fiff/fiff_coord_trans.h>
+
+#include <cmath>
+#include <cstdlib>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace INVERSELIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS HPIFitTracker
+*
+* @brief The HPIFitTracker class exposes the tracking state of HPIFit to the test
+*
+*/
+class HPIFitTracker : public HPIFit
+{
+public:
+    bool isWarmStart() const
+    {
+        return m_bWarmStart;
+    }
+
+    MatrixXd meanTopography() const
+    {
+        return m_matTopoSum / m_iTopoCount;
+    }
+};
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestHpiFit
+*
+* @brief The TestHpiFit class compares the HPI coil fits on the fields of known magnetic dipoles
+*
+*/
+class TestHpiFit: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestHpiFit();
+
+private slots:
+    void initTestCase();
+    void compareNoiseFree();
+    void compareNoisy();
+    void compareTrackerWarmStart();
+    void compareTrackerDemodulation();
+    void cleanupTestCase();
+
+private:
+    void simulateCoils(double dNoise, QList<HPIFitData>& lCoilData);
+    RowVectorXd coilField(const RowVector3d& vecPos, const RowVector3d& vecMom);
+    MatrixXd simulateBlock(const MatrixXd& matCoilPos, double dScale, int iFirstSample);
+    MatrixXd fitBlock(HPIFitTracker& hpiFit, const MatrixXd& matData);
+
+    double epsilon;
+
+    SensorInfo m_sensors;
+    MatrixXd m_matCoilPos;
+    MatrixXd m_matCoilMom;
+
+    FiffInfo::SPtr m_pFiffInfo;
+    QVector<int> m_vFreqs;
+    int m_iBlockSize;
+};
+
+
+//*************************************************************************************************************
+
+TestHpiFit::TestHpiFit()
+: epsilon(0.000001)
+, m_iBlockSize(200)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestHpiFit::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    //Radial magnetometers on a hemisphere of 12cm radius
+    int iNumRings = 6;
+    int iNumPerRing = 17;
+    int iNumSens = iNumRings * iNumPerRing;
+
+    m_sensors.coilpos.resize(iNumSens, 3);
+    m_sensors.coilori.resize(iNumSens, 3);
+    m_sensors.tra = MatrixXd::Identity(iNumSens, iNumSens);
+
+    for(int r = 0, s = 0; r < iNumRings; ++r) {
+        double dTheta = (r + 0.5) * M_PI / (2.0 * iNumRings);
+
+        for(int p = 0; p < iNumPerRing; ++p, ++s) {
+            double dPhi = 2.0 * M_PI * p / iNumPerRing + 0.3 * r;
+            RowVector3d vecNormal(std::sin(dTheta)*std::cos(dPhi), std::sin(dTheta)*std::sin(dPhi), std::cos(dTheta));
+
+            m_sensors.coilpos.row(s) = 0.12 * vecNormal;
+            m_sensors.coilori.row(s) = vecNormal;
+        }
+    }
+
+    //Four coils on the scalp
+    m_matCoilPos.resize(4, 3);
+    m_matCoilPos << 0.07, 0.02, 0.05,
+                    -0.06, 0.03, 0.06,
+                    0.01, -0.07, 0.05,
+                    0.0, 0.06, 0.07;
+
+    m_matCoilMom.resize(4, 3);
+    m_matCoilMom << 1.0, 0.5, 0.0,
+                    0.0, 1.0, -0.3,
+                    -0.4, 0.2, 1.0,
+                    0.7, -0.7, 0.1;
+    m_matCoilMom *= 1e-8;
+
+    //Measurement info of the sensors above with the coils digitized in device coordinates
+    m_pFiffInfo = FiffInfo::SPtr(new FiffInfo);
+    m_pFiffInfo->sfreq = 1000.0;
+    m_pFiffInfo->nchan = iNumSens;
+
+    for(int s = 0; s < iNumSens; ++s) {
+        FiffChInfo chInfo;
+        chInfo.ch_name = QString("MEG%1").arg(s);
+        chInfo.chpos.coil_type = FIFFV_COIL_BABY_MAG;
+        chInfo.chpos.r0 = m_sensors.coilpos.row(s).transpose().cast<float>();
+        chInfo.chpos.ez = m_sensors.coilori.row(s).transpose().cast<float>();
+
+        m_pFiffInfo->chs.append(chInfo);
+        m_pFiffInfo->ch_names.append(chInfo.ch_name);
+    }
+
+    for(int i = 0; i < m_matCoilPos.rows(); ++i) {
+        FiffDigPoint digPoint;
+        digPoint.kind = FIFFV_POINT_HPI;
+        digPoint.ident = i + 1;
+        digPoint.r[0] = m_matCoilPos(i,0);
+        digPoint.r[1] = m_matCoilPos(i,1);
+        digPoint.r[2] = m_matCoilPos(i,2);
+
+        m_pFiffInfo->dig.append(digPoint);
+    }
+
+    m_vFreqs << 154 << 198 << 237 << 293;
+}
+
+
+//*************************************************************************************************************
+
+void TestHpiFit::compareNoiseFree()
+{
+    QList<HPIFitData> lCoilDataLM, lCoilDataSimplex;
+    simulateCoils(0.0, lCoilDataLM);
+    lCoilDataSimplex = lCoilDataLM;
+
+    HPIFitData::doDipfitLevenbergMarquardt(lCoilDataLM);
+
+    for(int i = 0; i < lCoilDataSimplex.size(); ++i) {
+        lCoilDataSimplex[i].doDipfitConcurrent();
+
+        //Both fits find the true positions
+        QVERIFY((lCoilDataLM.at(i).coilPos - m_matCoilPos.row(i)).norm() < epsilon);
+        QVERIFY((lCoilDataSimplex.at(i).coilPos - m_matCoilPos.row(i)).norm() < epsilon);
+        QVERIFY(lCoilDataLM.at(i).errorInfo.error < epsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestHpiFit::compareNoisy()
+{
+    QList<HPIFitData> lCoilDataLM, lCoilDataSimplex;
+    simulateCoils(0.05, lCoilDataLM);
+    lCoilDataSimplex = lCoilDataLM;
+
+    HPIFitData::doDipfitLevenbergMarquardt(lCoilDataLM);
+
+    for(int i = 0; i < lCoilDataSimplex.size(); ++i) {
+        lCoilDataSimplex[i].doDipfitConcurrent();
+
+        //Both fits minimize the same error, so they agree although the noise shifts the positions
+        QVERIFY((lCoilDataLM.at(i).coilPos - lCoilDataSimplex.at(i).coilPos).norm() < epsilon);
+        QVERIFY((lCoilDataLM.at(i).coilPos - m_matCoilPos.row(i)).norm() < 0.005);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestHpiFit::compareTrackerWarmStart()
+{
+    HPIFitTracker hpiFit;
+
+    //The first fit starts from the amplitude maxima
+    MatrixXd matFitted = fitBlock(hpiFit, simulateBlock(m_matCoilPos, 1.0, 0));
+    QVERIFY(hpiFit.isWarmStart());
+
+    for(int i = 0; i < m_matCoilPos.rows(); ++i) {
+        QVERIFY((matFitted.row(i) - m_matCoilPos.row(i)).norm() < 0.001);
+    }
+
+    //The following fits start from the previous positions and follow a moving head
+    MatrixXd matMoved = m_matCoilPos;
+    for(int k = 1; k <= 3; ++k) {
+        matMoved.rowwise() += RowVector3d(0.002, -0.001, 0.0015);
+
+        matFitted = fitBlock(hpiFit, simulateBlock(matMoved, 1.0, k * m_iBlockSize));
+        QVERIFY(hpiFit.isWarmStart());
+
+        for(int i = 0; i < matMoved.rows(); ++i) {
+            QVERIFY((matFitted.row(i) - matMoved.row(i)).norm() < 0.001);
+        }
+    }
+
+    //A reset falls back to the amplitude maxima
+    hpiFit.reset();
+    QVERIFY(!hpiFit.isWarmStart());
+}
+
+
+//*************************************************************************************************************
+
+void TestHpiFit::compareTrackerDemodulation()
+{
+    HPIFitTracker hpiFit;
+    hpiFit.setDemodulationWindow(3);
+
+    fitBlock(hpiFit, simulateBlock(m_matCoilPos, 1.0, 0));
+    MatrixXd matTopo = hpiFit.meanTopography();
+
+    //The block length is no multiple of the coil periods. Only phase continuous references average the
+    //topographies of consecutive blocks to the one of the first block.
+    MatrixXd matFitted;
+    for(int k = 1; k < 3; ++k) {
+        matFitted = fitBlock(hpiFit, simulateBlock(m_matCoilPos, 1.0, k * m_iBlockSize));
+        QVERIFY((hpiFit.meanTopography() - matTopo).norm() < epsilon * matTopo.norm());
+    }
+
+    for(int i = 0; i < m_matCoilPos.rows(); ++i) {
+        QVERIFY((matFitted.row(i) - m_matCoilPos.row(i)).norm() < 0.001);
+    }
+
+    //Doubled amplitudes replace the oldest blocks one by one
+    fitBlock(hpiFit, simulateBlock(m_matCoilPos, 2.0, 3 * m_iBlockSize));
+    QVERIFY((hpiFit.meanTopography() - 4.0/3.0 * matTopo).norm() < epsilon * matTopo.norm());
+
+    fitBlock(hpiFit, simulateBlock(m_matCoilPos, 2.0, 4 * m_iBlockSize));
+    QVERIFY((hpiFit.meanTopography() - 5.0/3.0 * matTopo).norm() < epsilon * matTopo.norm());
+
+    fitBlock(hpiFit, simulateBlock(m_matCoilPos, 2.0, 5 * m_iBlockSize));
+    QVERIFY((hpiFit.meanTopography() - 2.0 * matTopo).norm() < epsilon * matTopo.norm());
+
+    //Setting the same window keeps the state, a new window starts over
+    hpiFit.setDemodulationWindow(3);
+    QVERIFY(hpiFit.isWarmStart());
+
+    hpiFit.setDemodulationWindow(2);
+    QVERIFY(!hpiFit.isWarmStart());
+}
+
+
+//*************************************************************************************************************
+
+void TestHpiFit::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestHpiFit::simulateCoils(double dNoise, QList<HPIFitData>& lCoilData)
+{
+    int iNumSens = m_sensors.coilpos.rows();
+
+    std::srand(0);
+    lCoilData.clear();
+
+    for(int i = 0; i < m_matCoilPos.rows(); ++i) {
+        RowVectorXd vecData = coilField(m_matCoilPos.row(i), m_matCoilMom.row(i));
+
+        vecData += dNoise * vecData.cwiseAbs().maxCoeff() * RowVectorXd::Random(iNumSens);
+
+        //Start about 1.4cm off the true position
+        HPIFitData coilData;
+        coilData.coilPos = m_matCoilPos.row(i) + RowVector3d(0.01, -0.008, 0.006);
+        coilData.sensorData = vecData;
+        coilData.sensorPos = m_sensors;
+        coilData.matProjector = MatrixXd::Identity(iNumSens, iNumSens);
+
+        lCoilData.append(coilData);
+    }
+}
+
+
+//*************************************************************************************************************
+
+RowVectorXd TestHpiFit::coilField(const RowVector3d& vecPos, const RowVector3d& vecMom)
+{
+    //Same field as HPIFitData::magnetic_dipole
+    const double c = 1e-7 / (4.0 * M_PI);
+    int iNumSens = m_sensors.coilpos.rows();
+    RowVectorXd vecField(iNumSens);
+
+    for(int s = 0; s < iNumSens; ++s) {
+        RowVector3d d = m_sensors.coilpos.row(s) - vecPos;
+        RowVector3d o = m_sensors.coilori.row(s);
+        double r = d.norm();
+
+        vecField(s) = c * (3.0 * vecMom.dot(d) * o.dot(d) - vecMom.dot(o) * r * r) / std::pow(r, 5);
+    }
+
+    return vecField;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestHpiFit::simulateBlock(const MatrixXd& matCoilPos, double dScale, int iFirstSample)
+{
+    MatrixXd matData = MatrixXd::Zero(m_sensors.coilpos.rows(), m_iBlockSize);
+
+    for(int i = 0; i < matCoilPos.rows(); ++i) {
+        VectorXd vecField = dScale * coilField(matCoilPos.row(i), m_matCoilMom.row(i)).transpose();
+
+        //Each coil has its own phase, the samples count from the start of the recording
+        RowVectorXd vecSignal(m_iBlockSize);
+        for(int t = 0; t < m_iBlockSize; ++t) {
+            vecSignal(t) = std::sin(2.0 * M_PI * m_vFreqs.at(i) * (iFirstSample + t) / m_pFiffInfo->sfreq + 0.3 + i);
+        }
+
+        matData += vecField * vecSignal;
+    }
+
+    return matData;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestHpiFit::fitBlock(HPIFitTracker& hpiFit, const MatrixXd& matData)
+{
+    FiffCoordTrans transDevHead;
+    QVector<double> vGof;
+    FiffDigPointSet fittedPointSet;
+
+    hpiFit.fit(matData,
+               MatrixXd::Identity(matData.rows(), matData.rows()),
+               transDevHead,
+               m_vFreqs,
+               vGof,
+               fittedPointSet,
+               m_pFiffInfo);
+
+    MatrixXd matFitted(fittedPointSet.size(), 3);
+    for(int i = 0; i < fittedPointSet.size(); ++i) {
+        matFitted(i,0) = fittedPointSet[i].r[0];
+        matFitted(i,1) = fittedPointSet[i].r[1];
+        matFitted(i,2) = fittedPointSet[i].r[2];
+    }
+
+    return matFitted;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestHpiFit)
+#include "test_hpifit.moc"
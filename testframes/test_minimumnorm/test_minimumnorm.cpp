@@ -0,0 +1,234 @@
+//=============================================================================================================
+/**
+* @file     test_minimumnorm.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the ROI restricted and single precision realtime kernels with the full kernel
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_evoked.h>
+#include <fiff/fiff_cov.h>
+#include <mne/mne_forwardsolution.h>
+#include <mne/mne_inverse_operator.h>
+#include <inverse/minimumNorm/minimumnorm.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace MNELIB;
+using namespace INVERSELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMinimumNorm
+*
+* @brief The TestMinimumNorm class compares the realtime apply path of the minimum norm with the full kernel
+*
+*/
+class TestMinimumNorm: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMinimumNorm();
+
+private slots:
+    void initTestCase();
+    void compareVertnoSrcSel();
+    void compareRoiKernel();
+    void compareSinglePrecision();
+    void cleanupTestCase();
+
+private:
+    double epsilon;
+
+    MNEInverseOperator m_invOp;
+    MatrixXd m_matData;
+    MatrixXd m_matFull;
+    VectorXi m_vecSourceSel;
+};
+
+
+//*************************************************************************************************************
+
+TestMinimumNorm::TestMinimumNorm()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    QFile t_fileEvoked(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif");
+    QFile t_fileFwd(QDir::currentPath()+"/mne-cpp-test-data/Result/sample_audvis-meg-oct-6-fwd.fif");
+    QFile t_fileCov(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-cov.fif");
+
+    QPair<QVariant, QVariant> baseline(QVariant(), 0);
+    FiffEvoked evoked(t_fileEvoked, 0, baseline);
+    QVERIFY(!evoked.isEmpty());
+
+    MNEForwardSolution t_forward(t_fileFwd, false, true);
+    QVERIFY(!t_forward.isEmpty());
+
+    FiffCov noise_cov(t_fileCov);
+    noise_cov = noise_cov.regularize(evoked.info, 0.05, 0.05, 0.1, true);
+
+    //Loose orientation, hence the realtime path pools the three orientations of each source
+    m_invOp = MNEInverseOperator(evoked.info, t_forward, noise_cov, 0.2f, 0.8f);
+
+    MinimumNorm minimumNorm(m_invOp, 1.0f/9.0f, QString("dSPM"));
+    minimumNorm.doInverseSetup(1, false);
+
+    m_matData = MatrixXd::Random(minimumNorm.getKernel().cols(), 50);
+    QVERIFY(minimumNorm.applyInverse(m_matData, m_matFull));
+    QCOMPARE((int)m_matFull.rows(), (int)minimumNorm.getVertices().size());
+
+    //Sources of both hemispheres, not in ascending order
+    qint32 iNumLh = m_invOp.src[0].vertno.size();
+    m_vecSourceSel.resize(6);
+    m_vecSourceSel << iNumLh + 7, 3, iNumLh + 1, 0, 250, iNumLh + 600;
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::compareVertnoSrcSel()
+{
+    qint32 iNumLh = m_invOp.src[0].vertno.size();
+
+    VectorXi vecVertices(4);
+    vecVertices << m_invOp.src[1].vertno[12], m_invOp.src[1].vertno[5], m_invOp.src[1].vertno[12], m_invOp.src[1].vertno.maxCoeff() + 1;
+
+    //Ascending and unique, vertices which are not in use are skipped, right hemisphere indices come after the left ones
+    VectorXi vecSel = m_invOp.src.vertno_src_sel(vecVertices, 1);
+
+    QCOMPARE((int)vecSel.size(), 2);
+    QCOMPARE(vecSel[0], iNumLh + 5);
+    QCOMPARE(vecSel[1], iNumLh + 12);
+
+    QCOMPARE((int)m_invOp.src.vertno_src_sel(vecVertices, 2).size(), 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::compareRoiKernel()
+{
+    MinimumNorm minimumNorm(m_invOp, 1.0f/9.0f, QString("dSPM"));
+
+    //The selection set before and after the setup yields the same rows
+    minimumNorm.setSourceSelection(m_vecSourceSel);
+    minimumNorm.doInverseSetup(1, false);
+
+    MatrixXd matRoi;
+    QVERIFY(minimumNorm.applyInverse(m_matData, matRoi));
+    QCOMPARE((int)matRoi.rows(), (int)m_vecSourceSel.size());
+    QCOMPARE((int)minimumNorm.getSelectedVertices().size(), (int)m_vecSourceSel.size());
+
+    for(qint32 i = 0; i < m_vecSourceSel.size(); ++i) {
+        QCOMPARE(minimumNorm.getSelectedVertices()[i], minimumNorm.getVertices()[m_vecSourceSel[i]]);
+        QVERIFY((matRoi.row(i) - m_matFull.row(m_vecSourceSel[i])).cwiseAbs().maxCoeff() < epsilon * m_matFull.cwiseAbs().maxCoeff());
+    }
+
+    //An empty selection restores all sources
+    minimumNorm.setSourceSelection(VectorXi());
+
+    MatrixXd matAll;
+    QVERIFY(minimumNorm.applyInverse(m_matData, matAll));
+    QCOMPARE((int)matAll.rows(), (int)m_matFull.rows());
+    QVERIFY((matAll - m_matFull).cwiseAbs().maxCoeff() < epsilon * m_matFull.cwiseAbs().maxCoeff());
+    QVERIFY(minimumNorm.getSelectedVertices() == minimumNorm.getVertices());
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::compareSinglePrecision()
+{
+    MinimumNorm minimumNorm(m_invOp, 1.0f/9.0f, QString("dSPM"));
+    minimumNorm.doInverseSetup(1, false);
+    minimumNorm.setSinglePrecision(true);
+
+    //Single precision keeps about seven significant digits
+    MatrixXd matSingle;
+    QVERIFY(minimumNorm.applyInverse(m_matData, matSingle));
+    QCOMPARE((int)matSingle.rows(), (int)m_matFull.rows());
+    QVERIFY((matSingle - m_matFull).cwiseAbs().maxCoeff() < 0.0001 * m_matFull.cwiseAbs().maxCoeff());
+
+    minimumNorm.setSourceSelection(m_vecSourceSel);
+
+    MatrixXd matRoi;
+    QVERIFY(minimumNorm.applyInverse(m_matData, matRoi));
+    QCOMPARE((int)matRoi.rows(), (int)m_vecSourceSel.size());
+
+    for(qint32 i = 0; i < m_vecSourceSel.size(); ++i) {
+        QVERIFY((matRoi.row(i) - m_matFull.row(m_vecSourceSel[i])).cwiseAbs().maxCoeff() < 0.0001 * m_matFull.cwiseAbs().maxCoeff());
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMinimumNorm)
+#include "test_minimumnorm.moc"
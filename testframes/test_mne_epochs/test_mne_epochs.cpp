@@ -0,0 +1,213 @@
+//=============================================================================================================
+/**
+* @file     test_mne_epochs.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the batched epoch reading with the epoch by epoch reading
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_raw_data.h>
+#include <mne/mne_epoch_data_list.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneEpochs
+*
+* @brief The TestMneEpochs class checks that readEpochsBatched returns the same epochs as readEpochs
+*
+*/
+class TestMneEpochs: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneEpochs();
+
+private slots:
+    void initTestCase();
+    void compareBatchedEpochs();
+    void compareBatchedEpochsSmallChunks();
+    void cleanupTestCase();
+
+private:
+    void compareEpochLists(const MNEEpochDataList& epochs, const MNEEpochDataList& epochsBatched);
+
+    QFile m_fileRaw;
+    FiffRawData m_raw;
+    MatrixXi m_matEvents;
+    float m_fTMin;
+    float m_fTMax;
+    double m_dThreshold;
+};
+
+
+//*************************************************************************************************************
+
+TestMneEpochs::TestMneEpochs()
+: m_fTMin(-0.1f)
+, m_fTMax(0.4f)
+, m_dThreshold(100.0*0.0000010)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochs::initTestCase()
+{
+    m_fileRaw.setFileName(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    m_raw = FiffRawData(m_fileRaw);
+    QVERIFY(m_raw.first_samp < m_raw.last_samp);
+
+    // Place events every 0.3 seconds away from the file edges. The pattern 1, 1, 2 makes some of the windows of
+    // event 1 overlap, so that the batched reader has to merge them into one chunk.
+    fiff_int_t iStep = (fiff_int_t)(0.3 * m_raw.info.sfreq);
+    fiff_int_t iFirst = m_raw.first_samp + (fiff_int_t)m_raw.info.sfreq;
+    fiff_int_t iLast = m_raw.last_samp - (fiff_int_t)m_raw.info.sfreq;
+    qint32 iNumEvents = (iLast - iFirst) / iStep;
+    QVERIFY(iNumEvents > 3);
+
+    m_matEvents = MatrixXi::Zero(iNumEvents, 3);
+    for(qint32 i = 0; i < iNumEvents; ++i) {
+        m_matEvents(i,0) = iFirst + i * iStep;
+        m_matEvents(i,2) = (i % 3 == 2) ? 2 : 1;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochs::compareBatchedEpochs()
+{
+    MNEEpochDataList epochs = MNEEpochDataList::readEpochs(m_raw,
+                                                           m_matEvents,
+                                                           m_fTMin,
+                                                           m_fTMax,
+                                                           1,
+                                                           m_dThreshold,
+                                                           "eog");
+
+    MNEEpochDataList epochsBatched = MNEEpochDataList::readEpochsBatched(m_raw,
+                                                                         m_matEvents,
+                                                                         m_fTMin,
+                                                                         m_fTMax,
+                                                                         1,
+                                                                         m_dThreshold,
+                                                                         "eog");
+
+    compareEpochLists(epochs, epochsBatched);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochs::compareBatchedEpochsSmallChunks()
+{
+    // A chunk shorter than one epoch forces every epoch into a chunk of its own
+    MNEEpochDataList epochs = MNEEpochDataList::readEpochs(m_raw,
+                                                           m_matEvents,
+                                                           m_fTMin,
+                                                           m_fTMax,
+                                                           1,
+                                                           m_dThreshold,
+                                                           "eog");
+
+    MNEEpochDataList epochsBatched = MNEEpochDataList::readEpochsBatched(m_raw,
+                                                                         m_matEvents,
+                                                                         m_fTMin,
+                                                                         m_fTMax,
+                                                                         1,
+                                                                         m_dThreshold,
+                                                                         "eog",
+                                                                         RowVectorXi(),
+                                                                         0.1f);
+
+    compareEpochLists(epochs, epochsBatched);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochs::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochs::compareEpochLists(const MNEEpochDataList& epochs, const MNEEpochDataList& epochsBatched)
+{
+    QVERIFY(!epochs.isEmpty());
+    QCOMPARE(epochsBatched.size(), epochs.size());
+
+    for(qint32 i = 0; i < epochs.size(); ++i) {
+        QCOMPARE(epochsBatched[i]->event, epochs[i]->event);
+        QCOMPARE(epochsBatched[i]->tmin, epochs[i]->tmin);
+        QCOMPARE(epochsBatched[i]->tmax, epochs[i]->tmax);
+        QCOMPARE(epochsBatched[i]->bReject, epochs[i]->bReject);
+        QCOMPARE((int)epochsBatched[i]->epoch.rows(), (int)epochs[i]->epoch.rows());
+        QCOMPARE((int)epochsBatched[i]->epoch.cols(), (int)epochs[i]->epoch.cols());
+        QVERIFY(epochsBatched[i]->epoch == epochs[i]->epoch);
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMneEpochs)
+#include "test_mne_epochs.moc"
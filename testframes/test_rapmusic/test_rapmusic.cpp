@@ -0,0 +1,268 @@
+//=============================================================================================================
+/**
+* @file     test_rapmusic.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the Gram based RAP MUSIC pair scan with the direct subspace correlation
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <inverse/rapMusic/rapmusic.h>
+
+#include <cstdlib>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/QR>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace INVERSELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Exposes the protected subspace correlation and pair scan of RapMusic to the test.
+*/
+class RapMusicScan : public RapMusic
+{
+public:
+    using RapMusic::subcorr;
+    using RapMusic::subcorrGram;
+
+    double scan(const MatrixXT& p_matProj_LeadField, const MatrixXT& p_matU_B, int &p_iIdx1, int &p_iIdx2)
+    {
+        m_iNumGridPoints = p_matProj_LeadField.cols() / 3;
+        return scanPairs(p_matProj_LeadField, p_matU_B, p_iIdx1, p_iIdx2);
+    }
+};
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRapMusic
+*
+* @brief The TestRapMusic class compares the RAP MUSIC pair scan with a brute force search
+*
+*/
+class TestRapMusic: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRapMusic();
+
+private slots:
+    void initTestCase();
+    void compareSubcorrGram();
+    void compareScanFullTiles();
+    void compareScanPartialTile();
+    void compareScanPlantedPair();
+    void cleanupTestCase();
+
+private:
+    double bruteForce(const MatrixXd& matLeadField, int &iIdx1, int &iIdx2);
+    void compareScan(int iNumGridPoints);
+
+    double epsilon;
+    int m_iNumChannels;
+    MatrixXd m_matU_B;
+};
+
+
+//*************************************************************************************************************
+
+TestRapMusic::TestRapMusic()
+: epsilon(0.000001)
+, m_iNumChannels(30)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    std::srand(0);
+
+    //Orthonormal basis of a random three dimensional signal subspace
+    HouseholderQR<MatrixXd> qr(MatrixXd::Random(m_iNumChannels, 3));
+    m_matU_B = qr.householderQ() * MatrixXd::Identity(m_iNumChannels, 3);
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::compareSubcorrGram()
+{
+    MatrixXd matLeadField = MatrixXd::Random(m_iNumChannels, 3*20);
+
+    for(int i = 0; i < 20; ++i) {
+        //Includes the rank deficient pairs of a grid point with itself
+        for(int j = i; j < 20; ++j) {
+            RapMusic::MatrixX6T matPair(m_iNumChannels, 6);
+            matPair << matLeadField.middleCols(3*i, 3), matLeadField.middleCols(3*j, 3);
+
+            MatrixXd matCorrPair = m_matU_B.transpose() * matPair;
+            RapMusic::Matrix6T matGram = matPair.transpose() * matPair;
+            RapMusic::Matrix6T matCorr = matCorrPair.transpose() * matCorrPair;
+
+            double dCorGram = RapMusicScan::subcorrGram(matGram, matCorr);
+            double dCor = RapMusicScan::subcorr(matPair, m_matU_B);
+
+            QVERIFY(std::abs(dCorGram - dCor) < epsilon);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::compareScanFullTiles()
+{
+    compareScan(RAPMUSIC_SCAN_TILE_POINTS);
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::compareScanPartialTile()
+{
+    //The last tile holds fewer grid points
+    compareScan(2*RAPMUSIC_SCAN_TILE_POINTS + 22);
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::compareScanPlantedPair()
+{
+    //Both grid points of the best pair lie in the last, partial tile. Only together they span a direction of the
+    //signal subspace, so that no other pair reaches a correlation of one.
+    int iNumGridPoints = 2*RAPMUSIC_SCAN_TILE_POINTS + 22;
+    int iIdx1 = 2*RAPMUSIC_SCAN_TILE_POINTS + 12;
+    int iIdx2 = 2*RAPMUSIC_SCAN_TILE_POINTS + 19;
+
+    MatrixXd matLeadField = MatrixXd::Random(m_iNumChannels, 3*iNumGridPoints);
+    VectorXd vecOffset = VectorXd::Random(m_iNumChannels).normalized();
+    matLeadField.col(3*iIdx1) = m_matU_B.col(0) + vecOffset;
+    matLeadField.col(3*iIdx2) = -vecOffset;
+
+    RapMusicScan rapMusic;
+    int iScanIdx1, iScanIdx2;
+    double dScanCor = rapMusic.scan(matLeadField, m_matU_B, iScanIdx1, iScanIdx2);
+
+    QCOMPARE(iScanIdx1, iIdx1);
+    QCOMPARE(iScanIdx2, iIdx2);
+    QVERIFY(std::abs(dScanCor - 1.0) < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+double TestRapMusic::bruteForce(const MatrixXd& matLeadField, int &iIdx1, int &iIdx2)
+{
+    int iNumGridPoints = matLeadField.cols() / 3;
+    double dMaxCor = -1.0;
+    RapMusic::MatrixX6T matPair(m_iNumChannels, 6);
+
+    for(int i = 0; i < iNumGridPoints; ++i) {
+        for(int j = i; j < iNumGridPoints; ++j) {
+            matPair << matLeadField.middleCols(3*i, 3), matLeadField.middleCols(3*j, 3);
+
+            double dCor = RapMusicScan::subcorr(matPair, m_matU_B);
+
+            if(dCor > dMaxCor) {
+                dMaxCor = dCor;
+                iIdx1 = i;
+                iIdx2 = j;
+            }
+        }
+    }
+
+    return dMaxCor;
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::compareScan(int iNumGridPoints)
+{
+    MatrixXd matLeadField = MatrixXd::Random(m_iNumChannels, 3*iNumGridPoints);
+
+    RapMusicScan rapMusic;
+    int iScanIdx1, iScanIdx2, iBruteIdx1, iBruteIdx2;
+    double dScanCor = rapMusic.scan(matLeadField, m_matU_B, iScanIdx1, iScanIdx2);
+    double dBruteCor = bruteForce(matLeadField, iBruteIdx1, iBruteIdx2);
+
+    QCOMPARE(iScanIdx1, iBruteIdx1);
+    QCOMPARE(iScanIdx2, iBruteIdx2);
+    QVERIFY(std::abs(dScanCor - dBruteCor) < epsilon);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRapMusic)
+#include "test_rapmusic.moc"
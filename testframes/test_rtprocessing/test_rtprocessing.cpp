@@ -0,0 +1,421 @@
+//=============================================================================================================
+/**
+* @file     test_rtprocessing.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Tests for the real-time processing classes
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <rtprocessing/rtresample.h>
+#include <rtprocessing/rtcov.h>
+#include <rtprocessing/rtave.h>
+
+#include <fiff/fiff_cov.h>
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_evoked_set.h>
+#include <fiff/fiff_constants.h>
+
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtProcessing
+*
+* @brief The TestRtProcessing class provides tests of the real-time processing classes against reference results
+*
+*/
+class TestRtProcessing: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtProcessing();
+
+private slots:
+    void initTestCase();
+    void resamplePassband();
+    void resampleStopband();
+    void resampleBlockContinuity();
+    void covOnlineEqualsBatch();
+    void covWeightedUnbiased();
+    void aveRunningEqualsDirect();
+    void cleanupTestCase();
+
+private:
+    MatrixXd sinusoid(double dFreq, int iNumSamples);
+    double resampledAmplitude(double dFreq, int iUp, int iDown);
+    FiffCov estimateCov(const MatrixXd& matData, bool bOnline, double dForgettingFactor);
+    FiffCov referenceCov(const MatrixXd& matData, double dForgettingFactor);
+
+    double epsilon;
+
+    FiffInfo::SPtr m_pFiffInfo;
+};
+
+
+//*************************************************************************************************************
+
+TestRtProcessing::TestRtProcessing()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtProcessing::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    qRegisterMetaType<FIFFLIB::FiffCov>("FIFFLIB::FiffCov");
+
+    //Four EEG channels for the covariance estimation
+    m_pFiffInfo = FiffInfo::SPtr(new FiffInfo);
+    m_pFiffInfo->sfreq = 1000.0f;
+
+    for(int i = 0; i < 4; ++i) {
+        FiffChInfo chInfo;
+        chInfo.kind = FIFFV_EEG_CH;
+        chInfo.ch_name = QString("EEG %1").arg(i+1, 3, 10, QChar('0'));
+
+        m_pFiffInfo->chs.append(chInfo);
+        m_pFiffInfo->ch_names << chInfo.ch_name;
+    }
+
+    m_pFiffInfo->nchan = m_pFiffInfo->chs.size();
+}
+
+
+//*************************************************************************************************************
+
+void TestRtProcessing::resamplePassband()
+{
+    //Below the new Nyquist frequency the amplitude is kept, the frequencies are relative to the input sampling rate
+    QVERIFY(std::abs(resampledAmplitude(0.02, 1, 4) - 1.0) < 0.01);
+    QVERIFY(std::abs(resampledAmplitude(0.05, 1, 4) - 1.0) < 0.01);
+    QVERIFY(std::abs(resampledAmplitude(0.05, 3, 2) - 1.0) < 0.01);
+    QVERIFY(std::abs(resampledAmplitude(0.3, 3, 2) - 1.0) < 0.01);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtProcessing::resampleStopband()
+{
+    //Above the new Nyquist frequency of 0.125 the anti-aliasing filter attenuates by at least 40dB
+    QVERIFY(resampledAmplitude(0.2, 1, 4) < 0.01);
+    QVERIFY(resampledAmplitude(0.3, 1, 4) < 0.01);
+    QVERIFY(resampledAmplitude(0.4, 1, 4) < 0.01);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtProcessing::resampleBlockContinuity()
+{
+    //Resampling in blocks of varying size has to give the same samples as resampling all data at once
+    MatrixXd matData = MatrixXd::Random(3, 2000);
+    QList<int> lBlockSizes;
+    lBlockSizes << 1 << 7 << 100 << 3 << 333 << 64;
+
+    QList<QPair<int,int> > lRatios;
+    lRatios << qMakePair(1, 4) << qMakePair(1, 3) << qMakePair(3, 2) << qMakePair(2, 5);
+
+    for(int r = 0; r < lRatios.size(); ++r) {
+        RtResample rtResampleAll(lRatios.at(r).first, lRatios.at(r).second);
+        RtResample rtResampleBlocks(lRatios.at(r).first, lRatios.at(r).second);
+
+        MatrixXd matAll;
+        rtResampleAll.resample(matData, matAll);
+
+        MatrixXd matBlocks(matData.rows(), matAll.cols());
+        MatrixXd matBlock;
+        int iIn = 0, iOut = 0, b = 0;
+
+        while(iIn < matData.cols()) {
+            int iSize = std::min(lBlockSizes.at(b++ % lBlockSizes.size()), (int)matData.cols() - iIn);
+
+            //Resample in place as the MNE plugin does
+            matBlock = matData.middleCols(iIn, iSize);
+            rtResampleBlocks.resample(matBlock, matBlock);
+
+            QVERIFY(iOut + matBlock.cols() <= matBlocks.cols());
+            matBlocks.middleCols(iOut, matBlock.cols()) = matBlock;
+
+            iIn += iSize;
+            iOut += matBlock.cols();
+        }
+
+        QCOMPARE(iOut, (int)matAll.cols());
+        QVERIFY((matBlocks - matAll).cwiseAbs().maxCoeff() < epsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtProcessing::covOnlineEqualsBatch()
+{
+    //Without forgetting the running sums give the batch estimate, which is the unbiased sample covariance
+    MatrixXd matData = MatrixXd::Random(4, 1000);
+    matData.colwise() += Vector4d(1.0, -2.0, 0.5, 3.0);
+
+    FiffCov covBatch = estimateCov(matData, false, 1.0);
+    FiffCov covOnline = estimateCov(matData, true, 1.0);
+    FiffCov covReference = referenceCov(matData, 1.0);
+
+    QCOMPARE((int)covBatch.data.rows(), 4);
+    QCOMPARE((int)covOnline.data.rows(), 4);
+    QCOMPARE(covOnline.nfree, covBatch.nfree);
+    QVERIFY((covOnline.data - covBatch.data).cwiseAbs().maxCoeff() < epsilon);
+    QVERIFY((covBatch.data - covReference.data).cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtProcessing::covWeightedUnbiased()
+{
+    //With forgetting the estimate is normalized with W - sum(w^2)/W instead of W - 1
+    MatrixXd matData = MatrixXd::Random(4, 1000);
+    matData.colwise() += Vector4d(1.0, -2.0, 0.5, 3.0);
+
+    FiffCov covOnline = estimateCov(matData, true, 0.995);
+    FiffCov covReference = referenceCov(matData, 0.995);
+
+    QCOMPARE((int)covOnline.data.rows(), 4);
+    QVERIFY((covOnline.data - covReference.data).cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtProcessing::aveRunningEqualsDirect()
+{
+    //Four EEG channels and a stimulus channel, one epoch every three blocks:
+    //a quiet block which fills the pre stim buffer, a block with the trigger and a block which completes the epoch
+    int iNumAverages = 4, iNumEpochs = 10;
+    int iBlockSize = 100, iPreStim = 20, iPostStim = 50, iTriggerPos = 10;
+
+    FiffInfo::SPtr pFiffInfo(new FiffInfo(*m_pFiffInfo));
+    FiffChInfo chInfo;
+    chInfo.kind = FIFFV_STIM_CH;
+    chInfo.ch_name = "STI 014";
+    pFiffInfo->chs.append(chInfo);
+    pFiffInfo->ch_names << chInfo.ch_name;
+    pFiffInfo->nchan = pFiffInfo->chs.size();
+
+    int iStimCh = pFiffInfo->nchan - 1;
+
+    MatrixXd matData = MatrixXd::Random(pFiffInfo->nchan, 3 * iNumEpochs * iBlockSize);
+    matData.row(iStimCh).setZero();
+
+    QList<MatrixXd> lEpochs;
+
+    for(int i = 0; i < iNumEpochs; ++i) {
+        int iTrigger = (3 * i + 1) * iBlockSize + iTriggerPos;
+        matData.block(iStimCh, iTrigger, 1, 5).setConstant(1.0);
+        lEpochs.append(matData.middleCols(iTrigger - iPreStim, iPreStim + iPostStim));
+    }
+
+    //The evoked set is updated in place, copy the average when it is emitted
+    QMutex mutex;
+    QSemaphore semaphore;
+    QList<MatrixXd> lAverages;
+    QList<int> lNave;
+
+    RtAve rtAve(iNumAverages, iPreStim, iPostStim, 0, 0, iStimCh, pFiffInfo);
+
+    connect(&rtAve, &RtAve::evokedStim, this,
+            [&](FiffEvokedSet::SPtr pEvokedSet, const QStringList&) {
+                QMutexLocker locker(&mutex);
+                lAverages.append(pEvokedSet->evoked.at(0).data);
+                lNave.append(pEvokedSet->evoked.at(0).nave);
+                semaphore.release();
+            }, Qt::DirectConnection);
+
+    rtAve.start();
+
+    for(int i = 0; i < matData.cols(); i += iBlockSize) {
+        rtAve.append(matData.middleCols(i, iBlockSize));
+    }
+
+    bool bAllEmitted = semaphore.tryAcquire(iNumEpochs, 10000);
+
+    rtAve.stop();
+    rtAve.wait();
+
+    QVERIFY(bAllEmitted);
+
+    //Once the buffer is full every new epoch evicts the oldest one
+    for(int i = 0; i < iNumEpochs; ++i) {
+        int iFirst = std::max(0, i - iNumAverages + 1);
+        MatrixXd matDirect = lEpochs.at(iFirst);
+
+        for(int j = iFirst + 1; j <= i; ++j) {
+            matDirect += lEpochs.at(j);
+        }
+
+        matDirect /= i - iFirst + 1;
+
+        QCOMPARE(lNave.at(i), i - iFirst + 1);
+        QCOMPARE((int)lAverages.at(i).cols(), iPreStim + iPostStim);
+        QVERIFY((lAverages.at(i) - matDirect).cwiseAbs().maxCoeff() < epsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtProcessing::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtProcessing::sinusoid(double dFreq, int iNumSamples)
+{
+    //Sine and cosine, so that the amplitude of each output sample is the norm of its column
+    MatrixXd matData(2, iNumSamples);
+
+    for(int i = 0; i < iNumSamples; ++i) {
+        matData(0,i) = std::sin(2.0*M_PI*dFreq*i);
+        matData(1,i) = std::cos(2.0*M_PI*dFreq*i);
+    }
+
+    return matData;
+}
+
+
+//*************************************************************************************************************
+
+double TestRtProcessing::resampledAmplitude(double dFreq, int iUp, int iDown)
+{
+    RtResample rtResample(iUp, iDown);
+
+    MatrixXd matOut;
+    rtResample.resample(sinusoid(dFreq, 4000), matOut);
+
+    //Skip the transients of the filter at both ends
+    int iSkip = (int)std::ceil(2.0*rtResample.getDelay()) + 10;
+    double dAmplitude = 0.0;
+
+    for(int i = iSkip; i < matOut.cols() - iSkip; ++i) {
+        dAmplitude = std::max(dAmplitude, matOut.col(i).norm());
+    }
+
+    return dAmplitude;
+}
+
+
+//*************************************************************************************************************
+
+FiffCov TestRtProcessing::estimateCov(const MatrixXd& matData, bool bOnline, double dForgettingFactor)
+{
+    RtCov rtCov(matData.cols(), m_pFiffInfo);
+    rtCov.setOnlineEstimation(bOnline);
+    rtCov.setForgettingFactor(dForgettingFactor);
+
+    QSignalSpy spy(&rtCov, &RtCov::covCalculated);
+
+    //Append in blocks, the estimate is emitted once all samples arrived
+    for(int i = 0; i < matData.cols(); i += 100) {
+        rtCov.append(matData.middleCols(i, 100));
+    }
+
+    if(spy.isEmpty() && !spy.wait(10000)) {
+        return FiffCov();
+    }
+
+    return qvariant_cast<FiffCov>(spy.at(0).at(0));
+}
+
+
+//*************************************************************************************************************
+
+FiffCov TestRtProcessing::referenceCov(const MatrixXd& matData, double dForgettingFactor)
+{
+    //The newest sample has weight one
+    int iNumSamples = matData.cols();
+    VectorXd vecWeights(iNumSamples);
+
+    for(int j = 0; j < iNumSamples; ++j) {
+        vecWeights(j) = std::pow(dForgettingFactor, iNumSamples - 1 - j);
+    }
+
+    double dWeight = vecWeights.sum();
+    VectorXd vecMu = matData * vecWeights / dWeight;
+    MatrixXd matCentered = matData.colwise() - vecMu;
+
+    FiffCov cov;
+    cov.data = matCentered * vecWeights.asDiagonal() * matCentered.transpose() / (dWeight - vecWeights.squaredNorm() / dWeight);
+    cov.kind = FIFFV_MNE_NOISE_COV;
+    cov.diag = false;
+    cov.dim = cov.data.rows();
+    cov.names = m_pFiffInfo->ch_names;
+
+    //Same regularization as RtCovWorker
+    return cov.regularize(*m_pFiffInfo, 0.05, 0.05, 0.1, true, QStringList());
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtProcessing)
+#include "test_rtprocessing.moc"
@@ -45,7 +45,13 @@ SUBDIRS += \
     test_forward_solution \
     test_fiff_cov \
     test_fiff_digitizer \
+    test_filtering \
+    test_hpifit \
+    test_minimumnorm \
+    test_mne_epochs \
     test_mne_msh_display_surface_set \
+    test_rapmusic \
+    test_rtprocessing \
 
 !contains(MNECPP_CONFIG, minimalVersion) {
     qtHaveModule(charts) {